@@ -0,0 +1,145 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller deferred binary log
+
+   Records are written by loop() and by interrupt handlers, so a slot is reserved and filled with interrupts masked
+   (a dozen stores); the ring is only read by loop(). When the ring is full new records are dropped and counted.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_INFO
+#define DEBUG_LOG
+
+#include <Arduino.h>
+#include "BinLog.h"
+#include "DebugLib.h"
+
+#ifdef BINLOG
+
+#define BINLOG_FRAME_SIZE		(2 + sizeof(BinLog_Record))
+#define BINLOG_BENCH_CALLS		50
+
+static BinLog_Record			ring[BINLOG_RECORDS];
+static volatile uint16_t	head = 0;							// next record to write (free running)
+static volatile uint16_t	tail = 0;							// next record to drain (free running)
+static volatile uint16_t	sequence = 0;
+static volatile uint32_t	dropped = 0;
+
+#ifdef BINLOG_TEXT
+#define BINLOG_FORMAT(id, format)		static const char format_##id[] PROGMEM = format;
+BINLOG_MESSAGES(BINLOG_FORMAT)
+#undef BINLOG_FORMAT
+
+#define BINLOG_FORMAT_PTR(id, format)	format_##id,
+static PGM_P const formats[BL_COUNT] = { BINLOG_MESSAGES(BINLOG_FORMAT_PTR) };
+#undef BINLOG_FORMAT_PTR
+#endif
+
+/*
+ add a record to the ring - safe to call from an interrupt
+*/
+void ICACHE_RAM_ATTR binlogWrite ( const uint8_t id, const uint32_t a, const uint32_t b, const uint32_t c ) {
+   uint32_t	now = micros();
+   uint32_t	saved = xt_rsil(15);
+
+   if ( (uint16_t)(head - tail) < BINLOG_RECORDS ) {
+      BinLog_Record *r = &ring[head & (BINLOG_RECORDS - 1)];
+
+      r->time = now;
+      r->seq = sequence;
+      r->id = id;
+      r->arg[0] = a;
+      r->arg[1] = b;
+      r->arg[2] = c;
+      ++head;
+   } else {
+      ++dropped;
+   }
+   ++sequence;
+   xt_wsr_ps(saved);
+}
+
+/*
+ drain the ring to the serial port - call from loop() only, while the carriage is not moving
+ records (binary, or text lines with BINLOG_TEXT) are only written when they fit in the UART FIFO, so this never waits
+ on the serial port
+*/
+void binlogFlush ( void ) {
+   while ( tail != head ) {
+      const BinLog_Record *r = &ring[tail & (BINLOG_RECORDS - 1)];
+
+#ifdef BINLOG_TEXT
+      char	line[112];
+      int	length = snprintf_P(line, sizeof(line), PSTR("%u ms> "), (unsigned int)(r->time / 1000));
+
+      if ( r->id < BL_COUNT ) {
+         length += snprintf_P(line + length, sizeof(line) - length, formats[r->id], r->arg[0], r->arg[1], r->arg[2]);
+      } else {
+         length += snprintf_P(line + length, sizeof(line) - length, PSTR("unknown message %u"), (unsigned int)r->id);
+      }
+      length = min(length, (int)sizeof(line) - 1);
+      if ( SerialIO.availableForWrite() < length + 2 ) {			// println() adds CR LF
+         return;
+      }
+      SerialIO.println(line);
+#else
+      static const uint8_t	sync[2] = { BINLOG_SYNC0, BINLOG_SYNC1 };
+
+      if ( SerialIO.availableForWrite() < (int)BINLOG_FRAME_SIZE ) {
+         return;
+      }
+      SerialIO.write(sync, sizeof(sync));
+      SerialIO.write((const uint8_t *)r, sizeof(BinLog_Record));
+#endif
+      ++tail;
+   }
+}
+
+uint32_t binlogDropped ( void ) {
+   return dropped;
+}
+
+/*
+ cost per call of a deferred record compared with the text macros it replaces
+ the text macros wait for the UART once its FIFO is full, which is what they cost in a burst (e.g. an endstop hit
+ followed by the end of a move and the next request)
+*/
+void binlogBenchmark ( void ) {
+   uint32_t	start;
+   uint32_t	binCycles;
+   uint32_t	logCycles;
+   uint32_t	infoCycles;
+
+   SerialIO.flush();
+   start = ESP.getCycleCount();
+   for ( uint8_t i = 0; i < BINLOG_BENCH_CALLS; i++ ) {
+      BLOG(BL_BENCHMARK, i, start, 0);
+   }
+   binCycles = ESP.getCycleCount() - start;
+   tail = head;														// discard the benchmark records
+
+   SerialIO.flush();
+   start = ESP.getCycleCount();
+   for ( uint8_t i = 0; i < BINLOG_BENCH_CALLS; i++ ) {
+      LOG(PSTR("Binlog benchmark %u %u\n"), (unsigned int)i, (unsigned int)start);
+   }
+   logCycles = ESP.getCycleCount() - start;
+
+   SerialIO.flush();
+   start = ESP.getCycleCount();
+   for ( uint8_t i = 0; i < BINLOG_BENCH_CALLS; i++ ) {
+      INFO(F("Binlog benchmark"), i);
+   }
+   infoCycles = ESP.getCycleCount() - start;
+
+   LOG(PSTR("Binlog: %u cycles per record, LOG() %u cycles, INFO() %u cycles (%u calls each)\n"),
+      (unsigned int)(binCycles / BINLOG_BENCH_CALLS), (unsigned int)(logCycles / BINLOG_BENCH_CALLS),
+      (unsigned int)(infoCycles / BINLOG_BENCH_CALLS), (unsigned int)BINLOG_BENCH_CALLS);
+}
+
+#endif
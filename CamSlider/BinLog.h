@@ -0,0 +1,83 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller deferred binary log
+
+   Hot paths (the endstop ISR, the motion FSM, request handling) log a message ID and up to BINLOG_ARGS integer
+   arguments into a fixed ring instead of formatting text and waiting on the UART. loop() drains the ring to the
+   serial port while the step engine is idle: as framed binary records (decode them with tools/binlog_decode.py) or,
+   with BINLOG_TEXT defined in CamSlider.h, formatted on the device at drain time.
+
+   Enable by defining BINLOG in CamSlider.h. When it is not defined, the macros below compile to nothing.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef BINLOG_H
+#define BINLOG_H
+
+#include "CamSlider.h"
+
+#define BINLOG_RECORDS			64							// ring size in records (power of 2)
+#define BINLOG_ARGS				3							// arguments per record
+#define BINLOG_SYNC0				0xA5						// frame header ahead of each binary record
+#define BINLOG_SYNC1				0x5A
+
+/*
+ message table: X(id, format)
+ formats may only use integer conversions (%d %u %x) and at most BINLOG_ARGS arguments
+ the ID is the position in the table and tools/binlog_decode.py reads the formats from this file, so keep one entry
+ per line and add new messages at the end
+*/
+#define BINLOG_MESSAGES(X) \
+   X(BL_ENDSTOP_EDGE,		"Endstop edge at step %u") \
+   X(BL_ENDSTOP_HIT,			"**** ENDSTOP HIT ****") \
+   X(BL_ENDSTOP_TIMING,		"Endstop: halt %u cycles, react %u usec, overtravel %u steps") \
+   X(BL_ENDSTOP_WORST,		"Endstop worst: halt %u cycles, react %u usec, overtravel %u steps") \
+   X(BL_MOVE_START,			">>> Move to %d at speed %u direction %u") \
+   X(BL_MOVE_END,				"**** MOVE END ****") \
+   X(BL_TRAVELED,				"*** Traveled %d steps in %u msec") \
+   X(BL_FRAME_LATE,			"Timelapse frame %u late by %d msec") \
+   X(BL_NEXT_TIMER,			"Next timer call: %d") \
+   X(BL_CLIENT,				"Client connected. Connected flag %u") \
+   X(BL_REQUEST,				"ACTION %u value %d MODE %u") \
+   X(BL_PAGE,					"Sending web page (%d)") \
+   X(BL_SENT,					"Sent %u bytes in %u usec, heap used %d") \
+   X(BL_BENCHMARK,			"Binlog benchmark") \
+   X(BL_BOOT_SETUP,			"Boot: setup() at %u ms") \
+   X(BL_BOOT_WIFI,			"Boot: WiFi up at %u ms (cached access point %u)") \
+   X(BL_BOOT_AP,				"Boot: AP mode at %u ms") \
+   X(BL_BOOT_SERVER,			"Boot: server listening at %u ms")
+
+#define BINLOG_ENUM(id, format)	id,
+typedef enum:uint8_t { BINLOG_MESSAGES(BINLOG_ENUM) BL_COUNT } BinLog_Id;
+#undef BINLOG_ENUM
+
+// one log entry as it sits in the ring and on the wire (little-endian, after the two sync bytes)
+typedef struct {
+   uint32_t	time;												// micros() when logged
+   uint16_t	seq;												// sequence number - gaps show records dropped when the ring was full
+   uint8_t	id;												// BinLog_Id
+   uint8_t	reserved;
+   uint32_t	arg[BINLOG_ARGS];
+} BinLog_Record;
+
+#ifdef BINLOG
+void		binlogWrite(const uint8_t id, const uint32_t a = 0, const uint32_t b = 0, const uint32_t c = 0);
+void		binlogFlush(void);
+uint32_t	binlogDropped(void);
+void		binlogBenchmark(void);
+
+   #define BLOG(id, ...)				binlogWrite((id), ##__VA_ARGS__)
+   #define BLOG_FLUSH()					binlogFlush()
+   #define BINLOG_BENCHMARK()			binlogBenchmark()
+#else
+   #define BLOG(...)
+   #define BLOG_FLUSH()
+   #define BINLOG_BENCHMARK()
+#endif
+
+#endif
@@ -12,31 +12,39 @@
 #ifndef CAMSLIDER_H
 #define CAMSLIDER_H
 
-// OSM 17HS24-0644S stepper motor parameters needed for motion calculations
-#define STEPS_PER_REV		   200
-#define PULLEY_TEETH			   20
-#define BELT_PITCH			   2						// 2 MM
-#define INCHES_PER_MM		   25.4
-#define HS24_MAX_SPEED		   592.0					// in steps/sec set using calculator at http://www.daycounter.com/Calculators/Stepper-Motor-Calculator.phtml
-
-#define MAX_TRAVEL_DISTANCE	110				   // (just a bit longer than the) maximum possible travel distance (inches). assuming 10' pipes
+#include "Shutter.h"
+
+// OSM 17HS24-0644S stepper motor - the drive train (pulley, belt, microstepping) is in the mechanics profile (Mechanics.h)
+#define HS24_MAX_SPEED		   592.0					// in full steps/sec set using calculator at http://www.daycounter.com/Calculators/Stepper-Motor-Calculator.phtml
+
+#define MAX_TRAVEL_DISTANCE	110				   // travel limit of the built-in profiles (inches): just a bit longer than 10' pipes
 #define MAX_TRAVEL_TIME			10800				   // maximum possible travel duration (sec)
 #define MAX_IMAGES				2000				   // maximum number of images (timelapse mode)
 #define CARR_SETTLE_MSEC		2250 				   // delay to stabilize carriage before triggering shutter
 #define CARR_SETTLE_SEC			3					   // above delay in seconds
 
-#define STEPS_PER_MM			   (STEPS_PER_REV / (BELT_PITCH * PULLEY_TEETH))
-#define INCHES_TO_STEPS(I)	   (STEPS_PER_MM * (I) * INCHES_PER_MM)
-#define STEPS_TO_INCHES(S)	   ((S)/(STEPS_PER_MM * INCHES_PER_MM))
+// A4988 step/direction pins - the step engine writes them through StepDriver.h, so they are fixed at compile time
+#define STEP_PIN				D0						// ESP 16
+#define DIR_PIN				D5						// ESP 14; HIGH == FWD
+#define ENABLE_PIN			D6						// ESP 12
 
-#define EEPROMSIZE            128
+#define EEPROMSIZE            128                  // WiFi credentials shadow (the run state journal has its own flash sectors, see Journal.h)
 #define CRED_ADDR             0
 
+//#define LOOP_PROFILE                          // uncomment to print loop() timing and step rate statistics (see Profile.h)
+#define BINLOG                                  // log hot path messages through the deferred binary log (see BinLog.h)
+//#define BINLOG_TEXT                           // uncomment to format the log on the device instead of sending binary records
+#define METRICS                                 // counters and timing histograms served at /metrics (see Metrics.h)
+//#define STEP_TRACE                            // uncomment to capture step timing for a move via /api/trace (see Trace.h)
+#define STEP_GPIO                               // step pulses through the GPIO registers instead of digitalWrite() (see StepDriver.h)
+#define FAST_BOOT                               // connect straight to the last access point before scanning (see setupWiFi())
+//#define FAST_BOOT_STATIC_IP                   // uncomment to also reuse the last DHCP address and skip DHCP
+
 
 typedef enum:uint8_t { STOP_HERE, REVERSE, ONE_CYCLE } EndstopMode;
 typedef enum:uint8_t { CARRIAGE_STOP, CARRIAGE_TRAVEL, CARRIAGE_TRAVEL_REVERSE, CARRIAGE_PARKED } CarriageMode;
 typedef enum:uint8_t { MOVE_NOT_SET, MOVE_DISABLED, MOVE_VIDEO, MOVE_TIMELAPSE } MoveMode;
-typedef enum:uint8_t { S_SHUTTER, S_MOVE, S_DELAY } TL_State;
+typedef enum:uint8_t { S_SHUTTER, S_EXPOSE, S_MOVE, S_DELAY } TL_State;
 
 // state data for carriage homing move
 typedef struct {
@@ -46,17 +54,51 @@ typedef struct {
    float				lastTargetSpeed;		         // saved target speed
 } Home_State;
 
+#define DRIFT_BINS				5						   // shutter drift histogram: <10, <50, <100, <500, >=500 msec
+
+// frame timing statistics for a timelapse sequence
+typedef struct {
+   uint16_t	frames;								      // frames measured
+   uint16_t	late;									      // frames pushed past their deadline by the carriage settle time
+   int32_t	maxDrift;							      // latest shutter relative to its deadline (msec)
+   uint32_t	totalDrift;							      // sum of drift for the mean (msec)
+   uint16_t	histogram[DRIFT_BINS];			      // drift distribution
+} TL_Drift;
+
+/*
+ timelapse frame plan built when a sequence starts
+ the total steps and the total time are divided between the moves with Bresenham error accumulation: each move gets
+ the base amount plus one more whenever the accumulated remainder reaches the number of moves, so the totals are exact
+*/
+typedef struct {
+   uint16_t	moves;								      // moves in the sequence (images - 1)
+   uint32_t	stepBase;							      // steps per move before correction
+   uint16_t	stepRem;								      // steps left over after dividing by moves
+   uint16_t	stepError;							      // step error accumulator
+   uint32_t	timeBase;							      // msec per interval before correction
+   uint16_t	timeRem;								      // msec left over after dividing by moves
+   uint16_t	timeError;							      // time error accumulator
+   uint32_t	moveSteps;							      // steps for the move in the current interval
+   uint32_t	frameTime;							      // current frame time from the start of the sequence (msec)
+   uint32_t	nextFrameTime;						      // next frame time from the start of the sequence (msec)
+   uint32_t	moveMsec;							      // planned time of the longest move
+} TL_Plan;
+
 // timelapse move inputs, parameters, state
 typedef struct {
    bool		enabled;								      // enable timelapse movement
    int		totalDistance;						      // total distance traveled for the timelapse sequence (user input)
    int		totalDuration;						      // total timelapse duration (user input)
    int		totalImages;						      // total number of images to take (user input)
-   int		moveDistance;						      // distance to move in each interval
-   int		moveInterval;						      // delay in sec between moves
+   int		moveDistance;						      // distance to move in each interval (whole inches, for display)
+   int		moveInterval;						      // delay in sec between moves (whole seconds, for display)
    int		imageCount;							      // realtime shutter activation count
-   uint32_t	moveStartTime;						      // when move was initiated
+   uint32_t	moveStartTime;						      // deadline of the current frame (millis)
    TL_State	state;								      // state for FSM
+   Shutter_Sequence	shutter;					      // exposure sequence fired at each position
+   uint32_t	sequenceStart;						      // first frame time: frame k is due at sequenceStart + k * moveInterval
+   TL_Drift	drift;								      // frame timing statistics
+   TL_Plan	plan;									      // per-frame steps and times
 } TL_Data;
 
 #endif
\ No newline at end of file
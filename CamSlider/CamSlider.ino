@@ -7,8 +7,8 @@
    This version supports an A4988 (chopper) controller using a WeMos D1 Mini ESP8266 (ESP-12F) devboard.
    
    
-   Prior to running this sketch, the HTML file must be loaded into the ESP8266 SPIFFS file system.
-   Currently, the instructions for installing and running the uplaod tool can be found here: http://esp8266.github.io/Arduino/versions/2.3.0/doc/filesystem.html
+   The HTML pages are compiled into the sketch (HTMLTemplates.h). After editing any file in the data directory,
+   regenerate that header by running tools/html2progmem.py before building.
 
    Copyright 2016/2017 Rob Redford
    This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
@@ -38,11 +38,20 @@
 #define DEBUG_INFO
 #define DEBUG_LOG
 
-#include <AccelStepper.h>					// http://www.airspayce.com/mikem/arduino/AccelStepper/classAccelStepper.html
 #include <LEDManager.h>					   // https://github.com/Rom3oDelta7/LEDManager
-#include <SimpleTimer.h>					// http://playground.arduino.cc/Code/SimpleTimer
 #include "CamSlider.h"
 #include "DebugLib.h"
+#include "Profile.h"
+#include "StepEngine.h"
+#include "Events.h"
+#include "Motion.h"
+#include "SPSCQueue.h"
+#include "BinLog.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Journal.h"
+#include "Mechanics.h"
+#include "Scheduler.h"
 
 /*================================= stepper motor interface ==============================
 
@@ -58,11 +67,8 @@ Allegro A4988 motor controller
 
 // ================================= stepper ==============================================
 
-#define STEP				D0						                  // ESP 16
-#define DIR					D5						                  // ESP 14; HIGH == FWD
-#define ENABLE				D6						                  // ESP 12
-
-AccelStepper stepper(AccelStepper::DRIVER, STEP, DIR);
+// STEP_PIN, DIR_PIN and ENABLE_PIN are in CamSlider.h
+// step pulses are generated by the timer1 interrupt in StepEngine.cpp; loop() only starts and stops segments
 
 
 // ================================ slider controls =======================================
@@ -72,23 +78,42 @@ AccelStepper stepper(AccelStepper::DRIVER, STEP, DIR);
 
 
 #define BOUNCE_DELAY		300			                        // delay window in msec to ignore pin value fluctuation
+#define BOUNCE_USEC		(BOUNCE_DELAY * 1000UL)
+#define ENDSTOP_TEST_MSEC	3000											// DEBUG >= 4: simulated endstop hit this long into each move
+
+// endstop response measurements
+typedef struct {
+   uint32_t	hits;																// endstop hits acted on
+   uint32_t	edgeMicros;														// micros() at the last switch edge
+   uint32_t	edgeSteps;														// steps taken when the switch closed
+   uint32_t	haltCycles;														// edge ISR entry to step generation stopped (last hit)
+   uint32_t	maxHaltCycles;													// worst case of the above
+   uint32_t	maxReactMicros;												// worst edge to motion FSM reaction time
+   uint32_t	maxOvertravel;													// worst steps issued after the switch closed
+} Endstop_Stats;
 
 volatile	bool				newMove = false;							// true when we need to initiate a new move
 volatile bool				clockwise = true;							// true: away, false: towards motor
 volatile EndstopMode		endstopAction = STOP_HERE;				// action to take when an endstop is hit
 volatile CarriageMode	carriageState = CARRIAGE_PARKED;		// current state of the carriage (for the motion state machine)
 volatile bool				debounce = true;							// ISR debounce control flag (init true to avoid triggering on noise at startup)
-volatile unsigned long 	currentTime = 0;							// set in loop() so we don't have to call it in the ISR
-volatile unsigned long	debounceStart = 0;						// start of debounce window
-volatile bool				plannedMoveEnd = false;					// true if calling endOfTravel for a planned move termination
+volatile uint32_t			debounceStart = 0;						// micros() at the start of the debounce window
+volatile Endstop_Stats	endstopStats;								// written by the endstop ISR, read in loop()
 
-uint32_t                maxDistance = MAX_TRAVEL_DISTANCE;  // maximum slider length
+uint32_t                maxDistance = 0;                    // calibrated slider length (0 == the profile travel limit)
 long							targetPosition = 0;						// inches to travel
 float							targetSpeed = 0.0;						// speed in steps/second
+Motion_Plan					movePlan;									// step schedule for the current move
 unsigned long				travelStart = 0;							// start of curent carriage movement
 unsigned long				lastRunDuration = 0;						// duration of last movement
 int							stepsTaken = 0;							// counts steps actually executed
 bool							running = false;							// true only while the carriage is in motion
+Home_State					homeState = { false, STOP_HERE, 0, 0.0 };	// saved state for homing moves
+bool							calibrating = false;						// true when calibrating slider distance
+
+SPSCQueue<Motion_Command, MOTION_QUEUE_SIZE>	webCommands;		// web front end -> motion FSM
+SPSCQueue<Motion_Command, MOTION_QUEUE_SIZE>	isrCommands;		// endstop interrupt -> motion FSM
+Motion_Status				status;										// published motion state
 
 
 
@@ -103,14 +128,6 @@ Cyan  (flashing)	     Video mode: motors stopped
 Red  (flashing)		  Disabled mode
 Green		              Carriage in motion
 
-Error state colors (rapid flashing):
-------------------------------
-Red		              error opening SPIFFS file system
-Yellow	              error opening Video BODY HTML file
-Purple	              error opening Timelapse BODY file
-Cyan		              error opening Disabled BODY file
-Orange	              error opening CSS HTML file
-
 Setup Colors
 ------------
 Red/Green alternating  WiFi configuration required
@@ -124,19 +141,18 @@ Red/Green alternating  WiFi configuration required
 
 #define CAM_TRIGGER		D8												// ESP 15 (pulldown)
 
-#define CAM_TRIGGER_DURATION	100									// how long to hold the shutter button down in msec										
-
 RGBLED	   led(LED_RED, LED_GREEN, LED_BLUE);
-SimpleTimer timer;														// for timelapse mode
+unsigned long timelapseDue = 0;												// millis() when the pending timelapseMove() timer is due (0 == none)
 
 extern 	MoveMode	sliderMode;											// input enable flag
 extern 	TL_Data 	timelapse;											// data for timelapse moves
-extern	Home_State homeState;										// saved state for homing moves
-extern   bool calibrating;                                  // calibration state flag
 extern   bool userConnected;                                // true when user has connected via a device
 
 extern void setupWiFi(void);
 extern void WiFiService(void);
+extern void timelapsePlan(void);
+extern void timelapseMove(void);
+extern void timelapseResume(void);
 
 
 /*
@@ -153,67 +169,314 @@ void fatalError ( const LEDColor color ) {
 }
 
 /*
- endstop ISR (used for both endstops and end of planned moves (e.g. shorter distances that do not hit the limit switch))
- for planned moves, this fcn is called directly.
- set flags & state to be used in loop()
- we clear the debounce flag after the debounce interval expires in loop() if this is called by an interrupt
+ endstop ISR
+ step generation is stopped right here so the carriage does not keep driving into the switch while loop() is busy
+ serving a request; what happens next (stop, reverse, calibration) is still decided by the motion FSM in motionApply()
+ the debounce window is timed with micros() so it does not depend on loop() running; loop() also closes it so that
+ a micros() wrap cannot hold it open
+*/
+void ICACHE_RAM_ATTR endOfTravel ( void ) {
+   uint32_t	entry = ESP.getCycleCount();
+   uint32_t	now = micros();
+
+   if ( !debounce || ((now - debounceStart) >= BOUNCE_USEC) ) {
+      Motion_Command hit = { CMD_ENDSTOP_HIT };
+
+      TRACE_MARK(TRACE_ENDSTOP, stepEngineSteps());
+      stepEngineStop();
+      endstopStats.haltCycles = ESP.getCycleCount() - entry;
+      endstopStats.edgeMicros = now;
+      endstopStats.edgeSteps = stepEngineSteps();
+
+      hit.position = endstopStats.edgeSteps;				// the calibration distance must not include overtravel
+      isrCommands.push(hit);
+      BLOG(BL_ENDSTOP_EDGE, endstopStats.edgeSteps);
+      METRIC_COUNT(C_ENDSTOP_HITS);
+      eventNotify(EVENT_STATE | EVENT_ENDSTOP);
+
+      debounce = true;
+      debounceStart = now;
+   }
+}
+
+/*
+ record how quickly the last endstop hit was handled
+ halt: switch edge to step generation stopped (in the ISR)
+ react: switch edge to the motion FSM acting on it (what every hit cost before the ISR stopped the engine)
+ overtravel: steps issued after the switch closed
+*/
+static void recordEndstop ( void ) {
+   volatile Endstop_Stats	*e = &endstopStats;
+   uint32_t						react = micros() - e->edgeMicros;
+   uint32_t						overtravel = stepEngineSteps() - e->edgeSteps;
+
+   ++e->hits;
+   if ( e->haltCycles > e->maxHaltCycles ) {
+      e->maxHaltCycles = e->haltCycles;
+   }
+   if ( react > e->maxReactMicros ) {
+      e->maxReactMicros = react;
+   }
+   if ( overtravel > e->maxOvertravel ) {
+      e->maxOvertravel = overtravel;
+   }
+#if DEBUG >= 1
+   BLOG(BL_ENDSTOP_TIMING, e->haltCycles, react, overtravel);
+   BLOG(BL_ENDSTOP_WORST, e->maxHaltCycles, e->maxReactMicros, e->maxOvertravel);
+#endif
+}
+
+#if DEBUG >= 4
+/*
+ simulated endstop: pulls the far endstop pin low while a move is in progress, which raises the same GPIO interrupt
+ as the switch closing
+ run moves from the web UI while loading the server (tools/http_load.py) to get worst-case figures under HTTP load
+ (sim/endstop.cpp checks the same on the host)
+*/
+static void endstopSimulate ( void ) {
+   if ( (carriageState == CARRIAGE_TRAVEL) && !homeState.homing && stepEngineRunning() &&
+      ((millis() - travelStart) >= ENDSTOP_TEST_MSEC) ) {
+      pinMode(LIMIT_END, OUTPUT);
+      digitalWrite(LIMIT_END, LOW);
+      delayMicroseconds(50);
+      pinMode(LIMIT_END, INPUT);
+   }
+}
+#endif
+
+/*
+ act on an endstop hit reported by the ISR - step generation has already been stopped
 */
-void endOfTravel ( void ) {
+void endstopHit ( const long steps ) {
    led.setState(LEDState::OFF);                       // (briefly) turn off move indicator
-   if ( plannedMoveEnd ) {
-      // all planned moves stop the carriage
-      INFO(F("**** MOVE END ****"), "");
+   BLOG(BL_ENDSTOP_HIT);
+   recordEndstop();
+
+   switch ( endstopAction ) {
+   case STOP_HERE:
       carriageState = CARRIAGE_STOP;
-      plannedMoveEnd = false;
-   } else if ( !debounce ) {
-      INFO(F("**** ENDSTOP HIT ****"), "");
+      clockwise = !clockwise;
+      break;
+      
+   case REVERSE:
+      // reverse without stopping
+      // ZZZ - better to continue with the current move rather than initiatiating a new one ??? ZZZ
+      carriageState = CARRIAGE_TRAVEL_REVERSE;
+      clockwise = !clockwise;
+      newMove = true;										// execute the current move parameters in the opposite direction
+      break;
+      
+   case ONE_CYCLE:
+      // return once, no stopping
+      carriageState = CARRIAGE_TRAVEL_REVERSE;
+      endstopAction = STOP_HERE;							// stop next time
+      clockwise = !clockwise;
+      newMove = true;                              // execute the current move parameters in the opposite direction                        
+      if ( calibrating ) {
+         /*
+          we just ran out to the end of the slider after a homing move
+          capture the actual distance moved
+          note that homing flag is still set, so the move initiated above will complete the homing move
+         */
+         maxDistance = mechStepsToInches(steps);
+         journalCalibrated(maxDistance);
+         calibrating = false;
+      }
+      break;
+   
+   default:
+      break;
+   }
+}
 
-      // limit switch triggered
-      switch ( endstopAction ) {
-      case STOP_HERE:
-         carriageState = CARRIAGE_STOP;
-         clockwise = !clockwise;
-         break;
-         
-      case REVERSE:
-         // reverse without stopping
-         // ZZZ - better to continue with the current move rather than initiatiating a new one ??? ZZZ
-         carriageState = CARRIAGE_TRAVEL_REVERSE;
-         clockwise = !clockwise;
-         newMove = true;										// execute the current move parameters in the opposite direction
-         break;
-         
-      case ONE_CYCLE:
-         // return once, no stopping
-         carriageState = CARRIAGE_TRAVEL_REVERSE;
-         endstopAction = STOP_HERE;							// stop next time
-         clockwise = !clockwise;
-         newMove = true;                              // execute the current move parameters in the opposite direction                        
-         if ( calibrating ) {
-            /*
-             we just ran out to the end of the slider after a homing move
-             capture the actual distance moved
-             note that homing flag is still set, so the move initiated above will complete the homing move
-            */
-            maxDistance = STEPS_TO_INCHES(stepper.currentPosition());
-            calibrating = false;
+/*
+ return the carriage to the home position (motor end), then run out to the far end if calibrating
+*/
+void homeCarriage ( const bool calibrate ) {
+   calibrating = calibrate;
+
+   // save current stepper params to restore after move is complete
+   homeState.homing = true;
+   homeState.lastTargetPosition = targetPosition;
+   homeState.lastTargetSpeed = targetSpeed;
+   homeState.lastEndstopState = endstopAction;
+   
+   // return the carriage to the home position
+   targetPosition = mechInchesToSteps(mechMaxTravel());
+   targetSpeed = mechMaxSpeed();
+   endstopAction = STOP_HERE;
+   clockwise = false;							// towards the motor
+   newMove = true;
+}
+
+/*
+ apply one queued command to the motion state
+*/
+void applyCommand ( const Motion_Command &command ) {
+   switch ( command.type ) {
+   case CMD_SET_PARAMS:
+      targetPosition = command.position;
+      targetSpeed = command.speed;
+      break;
+
+   case CMD_SET_DIRECTION:
+      clockwise = command.clockwise;
+      break;
+
+   case CMD_SET_ENDSTOP:
+      endstopAction = command.endstop;
+      break;
+
+   case CMD_START:
+      newMove = true;
+      break;
+
+   case CMD_STOP:
+      // stop stepping before the journal commit: flash writes run with interrupts disabled
+      stepEngineStop();
+      carriageState = CARRIAGE_STOP;								// state machine will clear running flag
+      shutterAbort();
+      if ( timelapse.enabled ) {
+         timelapse.enabled = false;
+         journalSequenceEnd();
+      }
+      break;
+
+   case CMD_HOME:
+   case CMD_CALIBRATE:
+      homeCarriage(command.type == CMD_CALIBRATE);
+      break;
+
+   case CMD_TIMELAPSE:
+      timelapsePlan();
+      timelapse.imageCount = 0;
+      timelapse.state = S_SHUTTER;
+      timelapse.enabled = true;
+      journalSequenceStart(timelapse, clockwise);
+      timelapseMove();
+      break;
+
+   case CMD_RESUME:
+      timelapseResume();
+      break;
+
+   case CMD_ENDSTOP_HIT:
+      endstopHit(command.position);
+      break;
+
+   default:
+      break;
+   }
+}
+
+static void publishStatus ( void ) {
+   status.state = carriageState;
+   status.running = running;
+   status.clockwise = clockwise;
+   status.endstop = endstopAction;
+   status.homing = homeState.homing;
+   status.targetPosition = targetPosition;
+   status.targetSpeed = targetSpeed;
+   status.stepsTaken = stepsTaken;
+   status.travelStart = travelStart;
+   status.lastRunDuration = lastRunDuration;
+   status.maxDistance = maxDistance ? maxDistance : mechMaxTravel();
+}
+
+/*
+ queue a command from the web front end
+ returns false if the queue is full (the motion FSM has not run for MOTION_QUEUE_SIZE - 1 commands)
+*/
+bool motionCommand ( const Motion_Command &command ) {
+   return webCommands.push(command);
+}
+
+/*
+ apply all queued commands and publish the resulting state
+ called at the top of the motion FSM and by the web front end before it reports the state - both are between FSM
+ iterations, so each command is applied as a whole at a segment boundary
+ endstop events go first: they describe something that has already happened to the carriage
+*/
+void motionApply ( void ) {
+   Motion_Command command;
+
+   while ( isrCommands.pop(command) ) {
+      applyCommand(command);
+   }
+   while ( webCommands.pop(command) ) {
+      applyCommand(command);
+   }
+   publishStatus();
+}
+
+const Motion_Status &motionStatus ( void ) {
+   return status;
+}
+
+#if DEBUG >= 4
+/*
+ command queue stress test: a 20 kHz timer1 interrupt pushes a numbered sequence while loop() pops it, so pushes
+ land in the middle of pops and the ring wraps and overflows many times; every number that was accepted must come
+ out exactly once and in order (sim/queue.cpp checks the same on the host)
+ uses timer1, so it must run before the step engine is started
+*/
+static SPSCQueue<uint32_t, MOTION_QUEUE_SIZE>	testQueue;
+static volatile uint32_t								testSent = 0;
+
+static void ICACHE_RAM_ATTR testProducer ( void ) {
+   if ( testQueue.push((uint32_t)testSent) ) {
+      ++testSent;
+   }
+}
+
+void motionQueueTest ( void ) {
+   uint32_t			expected = 0;
+   uint32_t			errors = 0;
+   uint32_t			item;
+   unsigned long	start = millis();
+
+   timer1_isr_init();
+   timer1_attachInterrupt(testProducer);
+   timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+   timer1_write(STEP_TIMER_HZ / 20000);
+   while ( (millis() - start) < 1000 ) {
+      while ( testQueue.pop(item) ) {
+         if ( item != expected ) {
+            ++errors;
          }
-         break;
-      
-      default:
-         break;
+         expected = item + 1;
       }
-      
-      // set up debounce window (see loop())
-      debounce = true;
-      debounceStart = currentTime;			
+      delayMicroseconds(random(0, 500));					// sometimes fast enough to keep up, sometimes not
+      yield();
    }
+   timer1_disable();
+   timer1_detachInterrupt();
+   while ( testQueue.pop(item) ) {
+      if ( item != expected ) {
+         ++errors;
+      }
+      expected = item + 1;
+   }
+   Serial.println(String("Queue test: ") + String(testSent) + String(" sent, ") + String(expected) + String(" received, ") +
+      String(testQueue.lost()) + String(" refused, ") + String(errors) + String(" out of order"));
 }
+#endif
+
+// scheduler tasks, with loop() below
+static void motionService(void);
+static void ledService(void);
+static void webService(void);
+static void logService(void);
+static void otaService(void);
+#if DEBUG >= 3
+static void debugService(void);
+#endif
 
 /*
  SETUP
 */
 void setup ( void ) {
+   BLOG(BL_BOOT_SETUP, millis());
 #if DEBUG > 0
    Serial.begin(115200);
    INFO(F("Initializing ..."), ".");
@@ -223,94 +486,273 @@ void setup ( void ) {
    led.setColor(LEDColor::WHITE);                    // white => initialization
    led.setState(LEDState::ON);
    EEPROM.begin(EEPROMSIZE);                         // for shadow copy of WiFi credentials
+   journalBegin();
+   mechanicsBegin(journalState().mechanics);
+   maxDistance = journalState().maxDistance;
+   if ( journalResumable() ) {
+      // restore the interrupted sequence so the timelapse page shows it with the resume button
+      const Journal_Record &journal = journalState();
+
+      timelapse.totalDistance = journal.totalDistance;
+      timelapse.totalDuration = journal.totalDuration;
+      timelapse.totalImages = journal.totalImages;
+      timelapse.moveDistance = journal.moveDistance;
+      timelapse.moveInterval = journal.moveInterval;
+      timelapse.shutter = journal.shutter;
+      timelapse.imageCount = journal.frames;
+      clockwise = journal.clockwise;
+#if DEBUG >= 1
+      Serial.println(String("Timelapse interrupted at image ") + String(journal.frames) + String(" of ") + String(journal.totalImages));
+#endif
+   }
 
-   pinMode(STEP, OUTPUT);
-   pinMode(DIR, OUTPUT);
-   pinMode(ENABLE, OUTPUT);
    pinMode(LIMIT_MOTOR, INPUT);								// WeMos module pullup resistor on both pins
    pinMode(LIMIT_END, INPUT);
-   pinMode(CAM_TRIGGER, OUTPUT);								// WeMos pulldown on this pin
-   digitalWrite(CAM_TRIGGER, LOW);
+   shutterBegin(CAM_TRIGGER);									// WeMos pulldown on this pin
    
-   stepper.setEnablePin(ENABLE);								// set LOW to standby - internal pulldown in TB6612FNG
-   stepper.setPinsInverted(false, false, true);			// inverted ENABLE pin on Allegro A4988
+#if DEBUG >= 4
+   motionQueueTest();
+#endif
    
-   stepper.setMaxSpeed(HS24_MAX_SPEED);					// max steps/sec 
-   stepper.disableOutputs();									// don't energize the motors or enable controller until user initiates movement
+   stepEngineBegin();											// leaves the controller disabled until user initiates movement
    
    attachInterrupt(digitalPinToInterrupt(LIMIT_MOTOR), endOfTravel, FALLING);
    attachInterrupt(digitalPinToInterrupt(LIMIT_END), endOfTravel, FALLING);
    
    setupWiFi();
+#if DEBUG >= 4
+   plannerBenchmark();
+   stepEngineBenchmark();										// motor is still disabled
+   BINLOG_BENCHMARK();
+#endif
+
+   // motion first: it is run again after every other task; web serving bounds itself; the rest use what time is left
+   schedulerAdd("motion", motionService, TASK_CRITICAL);
+   schedulerAdd("shutter", shutterService, TASK_CRITICAL);
+   schedulerAdd("web", webService, TASK_NORMAL);
+   schedulerAdd("led", ledService, TASK_IDLE, 100);
+   schedulerAdd("log", logService, TASK_IDLE, 1000);
+   schedulerAdd("ota", otaService, TASK_IDLE, 500);
+#if DEBUG >= 3
+   schedulerAdd("debug", debugService, TASK_IDLE);
+#endif
+#if DEBUG >= 4
+   schedulerInterval(100, endstopSimulate);
+#endif
 
    // close the debounce window to stabilize initialization
    debounce = true;
-   debounceStart = millis();
+   debounceStart = micros();
 }
 
 /*
- fire the camera shutter
+ fire the camera shutter sequence - returns immediately, done is called when the last exposure has ended
 */
-void triggerShutter ( void ) {
+void triggerShutter ( const Shutter_Sequence &sequence, const ShutterCallback done ) {
    led.setColor(LEDColor::BLUE);								// color will be reset when move starts
    led.setState(LEDState::ON);
-   digitalWrite(CAM_TRIGGER, HIGH);
-   delay(CAM_TRIGGER_DURATION);						
-   digitalWrite(CAM_TRIGGER, LOW);
+   shutterStart(sequence, done);
+}
+
+/*
+ advance the frame plan to the next interval: set the steps for its move and the time of the frame that ends it
+ integer only - called once per frame
+*/
+static void nextInterval ( TL_Plan *p ) {
+   uint32_t interval = p->timeBase;
+
+   p->moveSteps = p->stepBase;
+   p->stepError += p->stepRem;
+   if ( p->stepError >= p->moves ) {
+      p->stepError -= p->moves;
+      ++p->moveSteps;
+   }
+   p->timeError += p->timeRem;
+   if ( p->timeError >= p->moves ) {
+      p->timeError -= p->moves;
+      ++interval;
+   }
+   p->frameTime = p->nextFrameTime;
+   p->nextFrameTime += interval;
+}
+
+/*
+ build the frame plan for the current timelapse inputs (called when the sequence is started)
+ the parameters have already been validated, so there is at least one move
+*/
+void timelapsePlan ( void ) {
+   TL_Plan	*p = &timelapse.plan;
+   uint32_t	totalSteps = (uint32_t)mechInchesToSteps(timelapse.totalDistance);
+   uint32_t	totalMsec = (uint32_t)timelapse.totalDuration * 1000UL;
+
+   memset(p, 0, sizeof(TL_Plan));
+   p->moves = timelapse.totalImages - 1;
+   p->stepBase = totalSteps / p->moves;
+   p->stepRem = totalSteps % p->moves;
+   p->timeBase = totalMsec / p->moves;
+   p->timeRem = totalMsec % p->moves;
+   p->moveMsec = plannerMoveTime(p->stepBase + (p->stepRem ? 1 : 0), mechMaxSpeed(), mechAccel(), RAMP_SCURVE);
+   nextInterval(p);
+#if DEBUG >= 2
+   Serial.println(String("Frame plan: ") + String(p->moves) + String(" moves of ") + String(p->stepBase) + String(" + ") + String(p->stepRem) +
+      String("/") + String(p->moves) + String(" steps every ") + String(p->timeBase) + String(" + ") + String(p->timeRem) + String("/") +
+      String(p->moves) + String(" msec"));
+#endif
+}
+
+/*
+ record how far after its deadline a frame was taken
+*/
+static void recordDrift ( const int32_t drift ) {
+   static const int32_t	binLimit[DRIFT_BINS - 1] = { 10, 50, 100, 500 };
+   TL_Drift					*d = &timelapse.drift;
+   uint8_t					bin = 0;
+
+   while ( (bin < (DRIFT_BINS - 1)) && (drift >= binLimit[bin]) ) {
+      ++bin;
+   }
+   ++d->histogram[bin];
+   ++d->frames;
+   d->totalDrift += (drift > 0) ? drift : 0;
+   if ( drift > d->maxDrift ) {
+      d->maxDrift = drift;
+   }
+}
+
+static void reportDrift ( void ) {
+#if DEBUG >= 1
+   TL_Drift *d = &timelapse.drift;
+
+   Serial.println(String("Timelapse: ") + String(d->frames) + String(" frames, ") + String(d->late) + String(" late, drift max ") +
+      String(d->maxDrift) + String(" mean ") + String(d->frames ? d->totalDrift / d->frames : 0) + String(" msec"));
+   Serial.println(String("  drift <10: ") + String(d->histogram[0]) + String(" <50: ") + String(d->histogram[1]) + String(" <100: ") +
+      String(d->histogram[2]) + String(" <500: ") + String(d->histogram[3]) + String(" >=500: ") + String(d->histogram[4]));
+#endif
+}
+
+/*
+ continue a sequence interrupted by a reset: rebuild the frame plan, skip the frames already taken and shoot the next
+ one now
+ the journal commits after every move, so the carriage is where the last recorded move left it - unless the power
+ failed during a move, which leaves it up to one move further along
+*/
+void timelapseResume ( void ) {
+   const Journal_Record	&journal = journalState();
+
+   if ( timelapse.enabled || !journalResumable() ) {
+      return;
+   }
+   journalResume();
+   clockwise = journal.clockwise;
+   timelapsePlan();
+   if ( journal.frames ) {
+      // frame k uses the (k + 1)th interval; S_SHUTTER advances to it
+      for ( uint16_t i = 1; i < journal.frames; i++ ) {
+         nextInterval(&timelapse.plan);
+      }
+      timelapse.sequenceStart = millis() - timelapse.plan.nextFrameTime;
+   }
+   timelapse.imageCount = journal.frames;
+   timelapse.state = S_SHUTTER;
+   timelapse.enabled = true;
+#if DEBUG >= 1
+   Serial.println(String("Resuming timelapse at image ") + String(journal.frames) + String(" of ") + String(timelapse.totalImages));
+#endif
+   timelapseMove();
 }
 
 /*
  small FSM for implementing a set of moves for timelapse photography
+ every frame is scheduled against an absolute deadline (sequenceStart + the frame time from the plan) rather than
+ relative to the previous one, so timer polling and shutter latency never accumulate over a sequence
  sequence is:
-    trigger the shutter
+    trigger the shutter sequence
+      shutter scheduler calls this fcn again when the last exposure has ended
     pre-move delay
     initiate move
       CARIAGE_STOP state in loop calls this fcn again at end of move seq
-    set timeout for remaining (post-move) delay (must be > minimum for carriage settling time)
+    set timeout for the next frame deadline (must be > minimum for carriage settling time - if not, the frame is late
+      but only that frame: the ones after it keep their deadlines)
     loop
  
  not a real interrupt, so no need for volatile variables
  move parameters have already been verified
  
 */
+/*
+ schedule the next timelapseMove() call; the due time feeds the timer lateness histogram
+*/
+static void timelapseAfter ( const uint32_t msec ) {
+   timelapseDue = millis() + msec;
+   schedulerTimeout(msec, timelapseMove);
+}
+
 void timelapseMove ( void ) {
+   if ( timelapseDue ) {
+      METRIC_OBSERVE(H_TIMER_LATE, (millis() - timelapseDue) * 1000UL);
+      timelapseDue = 0;
+   }
    
    if ( timelapse.enabled && (timelapse.imageCount < timelapse.totalImages) ) {
       switch ( timelapse.state ) {
       case S_SHUTTER:
-         // fire the shutter then initiate first delay
-         triggerShutter();
+         // fire the shutter; the frame deadline, not the time it actually fired, anchors the rest of the interval
+         if ( timelapse.imageCount == 0 ) {
+            timelapse.sequenceStart = millis();
+            memset(&timelapse.drift, 0, sizeof(timelapse.drift));
+         } else {
+            nextInterval(&timelapse.plan);
+         }
+         timelapse.moveStartTime = timelapse.sequenceStart + timelapse.plan.frameTime;
+         recordDrift((int32_t)(millis() - timelapse.moveStartTime));
+         timelapse.state = S_EXPOSE;
+         triggerShutter(timelapse.shutter, timelapseMove);
+         break;
+
+      case S_EXPOSE:
+         // exposure sequence complete: initiate first delay
+         eventNotify(EVENT_IMAGES);
          
          if ( ++timelapse.imageCount < timelapse.totalImages ) {
-            int moveTime = (int)floor((INCHES_TO_STEPS(timelapse.moveDistance) / HS24_MAX_SPEED) * 1000.0);
-            int timerDelay = ((timelapse.moveInterval * 1000) - moveTime) / 2;
+            // the move goes in the middle of the time left between the end of the exposures and the next frame
+            TL_Plan *p = &timelapse.plan;
+            uint32_t exposure = shutterDuration(timelapse.shutter);
+            int32_t timerDelay = (int32_t)(timelapse.moveStartTime + exposure +
+               ((int32_t)(p->nextFrameTime - p->frameTime - exposure - p->moveMsec) / 2) - millis());
             timelapse.state = S_MOVE;
-            timelapse.moveStartTime = millis();
-            timer.setTimeout(timerDelay < 0 ? 0 : timerDelay, timelapseMove);
+            timelapseAfter(timerDelay < 0 ? 0 : timerDelay);
          } else {
             // final shutter trigger is the end of timelapse sequence
             timelapse.enabled = false;
+            journalSequenceEnd();
+            reportDrift();
          }
          break;
          
       case S_MOVE:
          // move the carriage - motion FSM will return to this fcn
-         targetPosition = (long)INCHES_TO_STEPS(timelapse.moveDistance);
-         targetSpeed = HS24_MAX_SPEED;
+         targetPosition = (long)timelapse.plan.moveSteps;
+         targetSpeed = mechMaxSpeed();
          timelapse.state = S_DELAY;
          newMove = true;
          break;
          
       case S_DELAY:
-         // move complete; calculate & schedule the delay timeout for remainaing time
-         int timerDelay = (timelapse.moveInterval * 1000) - (millis() - timelapse.moveStartTime);
-         if (timerDelay < CARR_SETTLE_MSEC ) {
-            timerDelay = CARR_SETTLE_MSEC;
+         // move complete; schedule the next frame at its deadline, but never before the carriage has settled
+         journalFrame(timelapse.imageCount, clockwise);
+         int32_t timerDelay = (int32_t)(timelapse.sequenceStart + timelapse.plan.nextFrameTime - millis());
+         int32_t settle = (int32_t)plannerSettleTime(movePlan);
+         if (timerDelay < settle ) {
+            ++timelapse.drift.late;
+#if DEBUG >= 1
+            BLOG(BL_FRAME_LATE, timelapse.imageCount, (uint32_t)(settle - timerDelay));
+#endif
+            timerDelay = settle;
          }
 #if DEBUG >= 2
-         Serial.println(String("Next timer call: ") + String(timerDelay));
+         BLOG(BL_NEXT_TIMER, (uint32_t)timerDelay);
 #endif
-         timer.setTimeout(timerDelay, timelapseMove);
+         timelapseAfter(timerDelay);
          timelapse.state = S_SHUTTER;
          break;
          
@@ -325,8 +767,8 @@ void handleHoming (void) {
    // if calibration routine is active, then we just homed the carriage, so the next step is to run out to the end of the slider
    if ( calibrating ) {
       // we clear the calibration flag when we hit the endstop
-      targetPosition = (long)INCHES_TO_STEPS(MAX_TRAVEL_DISTANCE);
-      targetSpeed = HS24_MAX_SPEED;
+      targetPosition = mechInchesToSteps(mechMaxTravel());
+      targetSpeed = mechMaxSpeed();
       endstopAction = ONE_CYCLE;
       clockwise = true;							// away from the motor
       newMove = true;
@@ -341,81 +783,50 @@ void handleHoming (void) {
 }
 
 /*
- LOOP
+ TASKS - run by schedulerRun() (see Scheduler.h)
 */
-void loop ( void ) {
-   static LEDColor lastColor = LEDColor::NONE;
+static LEDColor lastColor = LEDColor::NONE;								// last parked color, so blinking is not restarted on every pass
 
-   yield();
-   WiFiService();
-
-#if DEBUG >= 3
-   // manual inputs for debugging - note that motor speed will be significantly slower if debug statements are being output
-   static bool askForInput = true;
-   
-   if ( askForInput ) {
-      Serial.print("*** INPUT DISTANCE IN INCHES and ELAPSED TIME: ");
-      askForInput = false;
-   }
-   if ( Serial.available() ) {
-      int inches, elapsed;
-      
-      inches = Serial.parseInt();
-      elapsed = Serial.parseInt();
-
-      if ( (inches > 0) && (elapsed > 0) ) {
-         targetPosition = (long)INCHES_TO_STEPS(inches);
-         targetSpeed = (float)(targetPosition / elapsed);							// steps per second
-         newMove = true;
-         askForInput = true;
-         Serial.println(String("Target Position: ") + String(targetPosition) + String(" steps at ") + String(targetSpeed) + String(" steps/sec"));
-      }
-      Serial.flush();
-   }
-#endif
-
-#if DEBUG >= 3
-   static int counter = 0;
-   if ( counter++ > 500 ) {
-      Serial.println(String("Remaining steps: ") + String(stepper.distanceToGo()) + String(" carriage state: ") + String(carriageState));
-      Serial.println(String("\tPOSITIONS: current: ") + String(stepper.currentPosition()) + String(" target: ") + String(stepper.targetPosition()));
-      counter = 0;
-   }
-#endif
-   /*
-     motion state machine - move flag always set OUTSIDE of this FSM
-     NOTE: becuase of the WiFi interface, it is essential to use the non-blocking stepper library calls for movement
-   */
+/*
+ motion state machine - move flag always set OUTSIDE of this FSM
+ NOTE: step pulses come from the timer1 interrupt, so this FSM only starts/stops segments and collects completion events
+ queued commands are applied first so that nothing changes while the FSM is working with the motion state
+ critical task: runs between every other task
+*/
+static void motionService ( void ) {
+   motionApply();
    switch ( carriageState ) {
    case CARRIAGE_TRAVEL:
-      /*
-       when moving CCW, the position will increment negatively from 0 (CW = positive)
-       however, distanceToGo in CCW rotation will start at target and INCREASE (in the negative direction)
-       ==> we need to check the absolute value of position rather than relying on distanceToGo() which
-       always increases regardless of direction (since it is subtracting a negative number in CCW rotation)
-      */
       led.setState(LEDState::ON);            // workaround for LED timing issue where LED may remain off when stae changed from blinking to OFF
-      if ( abs(stepper.currentPosition()) < targetPosition ) {
-         // constant speed - no acceleration
-         if ( stepper.runSpeed() ) {
-            ++stepsTaken;
-         }								
-      } else if ( stepsTaken == targetPosition ) {
-         // target reached without hitting the endstop, so simulate it to initiate next step (if any)
-         plannedMoveEnd = true;					// set when we did NOT hit the limit switch to get here
-         endOfTravel();
+      {
+         int steps = (int)stepEngineSteps();
+
+         PROFILE_STEPS(steps - stepsTaken);
+         if ( steps != stepsTaken ) {
+            stepsTaken = steps;
+            eventNotify(EVENT_STEPS);
+         }
+      }
+      PROFILE_POLL();
+      if ( stepEngineDone() ) {
+         // target reached without hitting the endstop: all planned moves stop the carriage
+         led.setState(LEDState::OFF);                    // (briefly) turn off move indicator
+         BLOG(BL_MOVE_END);
+         carriageState = CARRIAGE_STOP;
+         eventNotify(EVENT_STATE);
       }
       break;
       
    case CARRIAGE_STOP:
 #if DEBUG >= 1
-         Serial.println(String("*** Traveled ") + String(targetPosition) + String(" steps in ") + String((float)((millis() - travelStart)/1000.0)) + String(" sec"));
+         BLOG(BL_TRAVELED, (uint32_t)targetPosition, (uint32_t)(millis() - travelStart));
 #endif
-      stepper.stop();
-      stepper.runSpeedToPosition();				// a necessary part of the stop mechanism
+      stepEngineStop();
+      stepsTaken = (int)stepEngineSteps();
       carriageState = CARRIAGE_PARKED;			// only place this is set other than initial condition
-      stepper.disableOutputs();
+      stepEngineEnable(false);
       running = false;
+      eventNotify(EVENT_STATE | EVENT_STEPS);
       if ( travelStart ) {
          /*
           capture elapsed time
@@ -436,51 +847,17 @@ void loop ( void ) {
       
    case CARRIAGE_TRAVEL_REVERSE:
       // momentarily stop the motion in the current direction - move flag will be set in the ISR so new (opposite) movement will be initiaited below
-      stepper.stop();
-      stepper.runSpeedToPosition();
+      stepEngineStop();
       break;
       
    case CARRIAGE_PARKED:
-      // set LED color to match mode button on user interface
-      switch ( sliderMode ) {
-      case MOVE_NOT_SET:
-            break;
-
-      case MOVE_VIDEO:
-         // only change color on a state change. Otherwise we are constantly resetting the state & preventing blinking
-         if ( (lastColor != LEDColor::CYAN) || (led.getState() == LEDState::OFF) ) {
-            led.setColor(LEDColor::CYAN);
-            led.setState(LEDState::BLINK_ON);
-            lastColor = LEDColor::CYAN;
-         }
-         break;
-         
-      case MOVE_TIMELAPSE:
-         if ( (lastColor != LEDColor::MAGENTA) || (led.getState() == LEDState::OFF) ) {
-            led.setColor(LEDColor::MAGENTA);
-            led.setState(LEDState::BLINK_ON);
-            lastColor = LEDColor::MAGENTA;
-         }
-         break;
-         
-      case MOVE_DISABLED:
-      default:
-         if ( (lastColor != LEDColor::RED) || (led.getState() == LEDState::OFF) ) {
-            led.setColor(LEDColor::RED);
-            led.setState(LEDState::BLINK_ON);
-            lastColor = LEDColor::RED;
-         }
-         break;
-      }
-      // FALLTHRU
+      // LED color is set by ledService()
    default:
          break;
    }
-   //INFO(F("LED state"), led.getState());
    
-   // check if it is time to close the debounce window
-   currentTime = millis();
-   if ( debounce && ((currentTime - debounceStart) > BOUNCE_DELAY) ) {
+   // close an expired debounce window (the ISR checks the time itself, this only guards against micros() wrapping)
+   if ( debounce && ((micros() - debounceStart) >= BOUNCE_USEC) ) {
       debounce = false;
    }
    
@@ -490,19 +867,21 @@ void loop ( void ) {
       if ( !(((digitalRead(LIMIT_MOTOR) == LOW) && !clockwise) || ((digitalRead(LIMIT_END) == LOW) && clockwise)) ) {
          // initiate a new move using current settings
 #if DEBUG >= 1
-         Serial.println(String(">>> Move to ") + String(targetPosition) + String(" at speed ") + String(targetSpeed) + String(" direction ") + String(clockwise));
+         BLOG(BL_MOVE_START, (uint32_t)targetPosition, (uint32_t)targetSpeed, clockwise);
 #endif
-         stepper.setCurrentPosition(0);
-         stepper.moveTo(targetPosition);
-         stepper.setSpeed(clockwise ? targetSpeed : -targetSpeed);
          if ( carriageState == CARRIAGE_PARKED ) {
             // enable the motor & controller only if it had been turned off
-            stepper.enableOutputs();
+            stepEngineEnable(true);
          }
+         // jerk-limited ramps for smooth footage; homing only needs to be quick
+         stepEngineStop();
+         plannerBuild(movePlan, targetPosition, targetSpeed, mechAccel(), homeState.homing ? RAMP_TRAPEZOID : RAMP_SCURVE);
+         stepEngineStart(movePlan, clockwise);
          carriageState = CARRIAGE_TRAVEL;
          travelStart = millis();
          running = true;
          stepsTaken = 0;
+         eventNotify(EVENT_STATE | EVENT_STEPS);
          led.setColor(LEDColor::GREEN);
          led.setState(LEDState::ON);
          lastColor = LEDColor::GREEN;                      // must set to force LED change in CARRIAGE_PARKED state at end of move
@@ -510,7 +889,7 @@ void loop ( void ) {
          if ( (digitalRead(LIMIT_MOTOR) == LOW) || (digitalRead(LIMIT_END) == LOW) ) {
             //ignore spurrious limit switch triggers when moving off the switch by closing the debounce window at start of the move 
             debounce = true;
-            debounceStart = millis();
+            debounceStart = micros();
          }
       } else if ( homeState.homing ) {
          // if we're homing or calibrating while on the endstop, we still need to handle the homing state changes and/or the calibration runout
@@ -520,8 +899,111 @@ void loop ( void ) {
          clockwise = !clockwise;
       }
    }
-   timer.run();
+   publishStatus();
+}
+
+/*
+ set LED color to match mode button on user interface while parked
+*/
+static void ledService ( void ) {
+   if ( carriageState != CARRIAGE_PARKED ) {
+      return;
+   }
+   switch ( sliderMode ) {
+   case MOVE_NOT_SET:
+         break;
+
+   case MOVE_VIDEO:
+      // only change color on a state change. Otherwise we are constantly resetting the state & preventing blinking
+      if ( (lastColor != LEDColor::CYAN) || (led.getState() == LEDState::OFF) ) {
+         led.setColor(LEDColor::CYAN);
+         led.setState(LEDState::BLINK_ON);
+         lastColor = LEDColor::CYAN;
+      }
+      break;
+      
+   case MOVE_TIMELAPSE:
+      if ( (lastColor != LEDColor::MAGENTA) || (led.getState() == LEDState::OFF) ) {
+         led.setColor(LEDColor::MAGENTA);
+         led.setState(LEDState::BLINK_ON);
+         lastColor = LEDColor::MAGENTA;
+      }
+      break;
+      
+   case MOVE_DISABLED:
+   default:
+      if ( (lastColor != LEDColor::RED) || (led.getState() == LEDState::OFF) ) {
+         led.setColor(LEDColor::RED);
+         led.setState(LEDState::BLINK_ON);
+         lastColor = LEDColor::RED;
+      }
+      break;
+   }
+}
+
+static void webService ( void ) {
+   METRIC_TIMER(wifiStart);
+   WiFiService();
+   METRIC_OBSERVE(H_WIFI, micros() - wifiStart);
+}
+
+static void logService ( void ) {
+   if ( !stepEngineRunning() ) {
+      BLOG_FLUSH();											// log output never competes with step generation
+   }
+}
+
+static void otaService ( void ) {
    if ( userConnected ) {
       ArduinoOTA.handle();
    }
+}
+
+#if DEBUG >= 3
+/*
+ manual inputs for debugging - note that motor speed will be significantly slower if debug statements are being output
+*/
+static void debugService ( void ) {
+   static bool askForInput = true;
+   static int counter = 0;
+   
+   if ( askForInput ) {
+      Serial.print("*** INPUT DISTANCE IN INCHES and ELAPSED TIME: ");
+      askForInput = false;
+   }
+   if ( Serial.available() ) {
+      int inches, elapsed;
+      
+      inches = Serial.parseInt();
+      elapsed = Serial.parseInt();
+
+      if ( (inches > 0) && (elapsed > 0) ) {
+         targetPosition = mechInchesToSteps(inches);
+         targetSpeed = (float)(targetPosition / elapsed);							// steps per second
+         newMove = true;
+         askForInput = true;
+         Serial.println(String("Target Position: ") + String(targetPosition) + String(" steps at ") + String(targetSpeed) + String(" steps/sec"));
+      }
+      Serial.flush();
+   }
+
+   if ( counter++ > 500 ) {
+      Serial.println(String("Steps taken: ") + String(stepEngineSteps()) + String(" carriage state: ") + String(carriageState));
+      Serial.println(String("\tPOSITIONS: target: ") + String(targetPosition) + String(" running: ") + String(stepEngineRunning()));
+      counter = 0;
+   }
+}
+#endif
+
+/*
+ LOOP
+*/
+void loop ( void ) {
+   PROFILE_LOOP_START();
+   METRIC_TIMER(loopStart);
+   yield();
+   schedulerRun();
+   PROFILE_LOOP_END(carriageState, targetSpeed);
+   METRIC_COUNT(C_LOOPS);
+   METRIC_OBSERVE(H_LOOP, micros() - loopStart);
  }
@@ -29,10 +29,11 @@
   While there is a Serial.printf available for the ESP8266, it is best to maintain consistency with the use of PSTR()
   
   This function should not be called directly - only through the macro below
+  Declared inline so that more than one source file in the sketch can enable DEBUG_LOG
  */
-void _Log(PGM_P fmt, ...) __attribute__((format(printf, 1, 2)));
+inline void _Log(PGM_P fmt, ...) __attribute__((format(printf, 1, 2)));
 
-void _Log(PGM_P fmt, ...) {
+inline void _Log(PGM_P fmt, ...) {
    const uint8_t maxSize = 128;                        // Max resulting string size
    char          buf[maxSize]; 
    va_list       args;
@@ -0,0 +1,195 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller request dispatcher
+
+   Parameter names are hashed with FNV-1a starting from ACTION_HASH_SEED and reduced modulo ACTION_HASH_SIZE.
+   The seed is chosen so that every known name lands in a different slot, which makes the switch in lookupAction()
+   a perfect hash: one jump and one string compare per parameter. If a new name collides with an existing one the
+   switch has a duplicate case and will not compile - run tools/actionhash.py to find a new seed.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_LOG
+
+#include <limits.h>
+#include "Dispatch.h"
+#include "DebugLib.h"
+
+#define ACTION_HASH_SEED		1UL
+#define ACTION_HASH_SIZE		128
+#define FNV_PRIME					16777619UL
+
+#define FAVICON_PATH				"/favicon.ico"				// always comes after another request, so skip it
+
+constexpr uint32_t actionHash ( const char *name, const uint32_t hash = ACTION_HASH_SEED ) {
+   return *name ? actionHash(name + 1, (uint32_t)((hash ^ (uint8_t)*name) * FNV_PRIME)) : hash;
+}
+
+/*
+ find the action for a parameter name of length characters whose hash was computed while it was scanned
+ returns false if the name is not one of ours
+*/
+static bool lookupAction ( const char *name, const uint8_t length, const uint32_t hash, T_Action &action ) {
+#define ACTION_CASE(str, type)																								\
+   case actionHash(str) % ACTION_HASH_SIZE:																				\
+      action = type;																												\
+      return (length == (sizeof(str) - 1)) && (strncmp(name, str, length) == 0)
+
+   switch ( hash % ACTION_HASH_SIZE ) {
+   ACTION_CASE("MODE_BTN",			SLIDER_STATE);				// mode button
+   ACTION_CASE("ENDSTOP_BTN",		ENDSTOP_STATE);			// endstop state change button
+   ACTION_CASE("DISTANCE",			SET_DISTANCE);				// input distance to travel
+   ACTION_CASE("DURATION",			SET_DURATION);				// input travel duration
+   ACTION_CASE("TL_DIST",			SET_TL_DISTANCE);			// input total timelapse travel distance
+   ACTION_CASE("TL_DURN",			SET_TL_DURATION);			// input total timelapse duration in sec
+   ACTION_CASE("TL_IMAGES",		SET_TL_IMAGES);			// input total number of images to take
+   ACTION_CASE("DIRECTION_BTN",	SET_DIRECTION);			// toggle carriage direction
+   ACTION_CASE("START_BTN",		START_STATE);				// initiate/stop movement
+   ACTION_CASE("REFRESH_BTN",		NULL_ACTION);				// refresh display
+   ACTION_CASE("FORGET_BTN",		FORGET);						// clear saved user credentials
+   ACTION_CASE("HOME_BTN",			HOME_CARRIAGE);			// home the carriage
+   ACTION_CASE("CALI_BTN",			CALIBRATE);					// calibrate slider length
+   ACTION_CASE("RESUME_BTN",		RESUME);						// resume an interrupted timelapse sequence
+   ACTION_CASE("DIR",				DIRECTION);					// set carriage direction: away or towards
+   ACTION_CASE("START",				START_MOVE);				// start a move (does not stop a running one)
+   ACTION_CASE("MECH_BTN",			MECHANICS);					// select the next mechanics profile
+   ACTION_CASE("SHUTTER_BTN",		SHUTTER_STATE);			// select the next shutter mode
+   ACTION_CASE("TL_SHOTS",			SET_TL_SHOTS);				// input exposures per frame (burst & bracket)
+   ACTION_CASE("TL_GAP",			SET_TL_GAP);				// input msec between exposures (burst & bracket)
+   ACTION_CASE("TL_STOPS",			SET_TL_STOPS);				// input bracket spacing in EV stops
+   ACTION_CASE("TL_HOLD",			SET_TL_HOLD);				// input shutter pulse or bulb exposure in msec
+
+   default:
+      return false;
+   }
+#undef ACTION_CASE
+}
+
+/*
+ fill params with the recognized parameters of a request, in the order they were sent; returns how many
+ path and query point into the request line; each ends at a space or NUL (query is NULL if there is none)
+ a request that must not be answered with a page is returned as a single IGNORE action
+*/
+uint8_t dispatchActions ( const char *path, const char *query, Action_Param *params, const uint8_t max ) {
+   const char	*p = query;
+   uint8_t		count = 0;
+
+   if ( (strncmp(path, FAVICON_PATH, sizeof(FAVICON_PATH) - 1) == 0) ) {
+      params[0].action = IGNORE;
+      params[0].numeric = false;
+      params[0].length = 0;
+      params[0].value = 0;
+      params[0].text = path;
+      return 1;
+   }
+   if ( p == NULL ) {
+      return 0;
+   }
+
+   while ( (*p != '\0') && (*p != ' ') && (count < max) ) {
+      const char	*name = p;
+      const char	*text = p;
+      uint32_t		hash = ACTION_HASH_SEED;
+      long			number = 0;
+      bool			negative = false;
+      bool			numeric = false;
+      T_Action		action;
+
+      // name, hashed as it is scanned
+      while ( (*p != '\0') && (*p != ' ') && (*p != '=') && (*p != '&') ) {
+         hash = (uint32_t)((hash ^ (uint8_t)*p++) * FNV_PRIME);
+      }
+      uint8_t length = p - name;
+
+      // value
+      if ( *p == '=' ) {
+         text = ++p;
+         if ( *p == '-' ) {
+            negative = true;
+            ++p;
+         }
+         numeric = isdigit(*p);
+         while ( isdigit(*p) ) {
+            int digit = *p++ - '0';
+
+            if ( number > ((LONG_MAX - digit) / 10) ) {
+               numeric = false;										// out of range: rejected like any other non-number
+               number = 0;
+               break;
+            }
+            number = (number * 10) + digit;
+         }
+         while ( (*p != '\0') && (*p != ' ') && (*p != '&') ) {
+            numeric = false;
+            ++p;
+         }
+      } else {
+         text = p;
+      }
+
+      if ( lookupAction(name, length, hash, action) ) {
+         params[count].action = action;
+         params[count].numeric = numeric;
+         params[count].length = p - text;
+         params[count].value = negative ? -number : number;
+         params[count].text = text;
+         ++count;
+      }
+      if ( *p == '&' ) {
+         ++p;
+      }
+   }
+   return count;
+}
+
+/*
+ true if the value of param is exactly text (case insensitive)
+*/
+bool dispatchValueIs ( const Action_Param &param, const char *text ) {
+   return (strlen(text) == param.length) && (strncasecmp(param.text, text, param.length) == 0);
+}
+
+/*
+ time the dispatcher over a set of real request lines and print the average cost per request
+*/
+void dispatchBenchmark ( void ) {
+   static const char *corpus[] = {
+      "GET / HTTP/1.1",
+      "GET /?MODE_BTN=Video HTTP/1.1",
+      "GET /?ENDSTOP_BTN=Stop HTTP/1.1",
+      "GET /?DISTANCE=48 HTTP/1.1",
+      "GET /?DURATION=120 HTTP/1.1",
+      "GET /?TL_DIST=36 HTTP/1.1",
+      "GET /?TL_DURN=3600 HTTP/1.1",
+      "GET /?TL_IMAGES=360 HTTP/1.1",
+      "GET /?TL_DIST=36&TL_DURN=3600&TL_IMAGES=360&TL_SHOTS=3&TL_GAP=1000&TL_STOPS=1&TL_HOLD=100 HTTP/1.1",
+      "GET /?DIRECTION_BTN=Away HTTP/1.1",
+      "GET /?START_BTN=Standby HTTP/1.1",
+      "GET /?REFRESH_BTN=Refresh HTTP/1.1",
+      "GET /?HOME_BTN=Home HTTP/1.1",
+      "GET /?DISTANCE=48&DURATION=120&START_BTN=Standby HTTP/1.1",
+      "GET /?DISTANCE=48&DURATION=120&DIR=away&START=1 HTTP/1.1",
+      "GET /favicon.ico HTTP/1.1",
+   };
+   const uint8_t	count = sizeof(corpus) / sizeof(corpus[0]);
+   const uint16_t	passes = 1000;
+   uint32_t			start = ESP.getCycleCount();
+   Action_Param	params[DISPATCH_PARAMS_MAX];
+
+   for ( uint16_t pass = 0; pass < passes; pass++ ) {
+      for ( uint8_t i = 0; i < count; i++ ) {
+         const char *path = strchr(corpus[i], ' ') + 1;
+         const char *query = strchr(path, '?');
+
+         dispatchActions(path, query ? query + 1 : NULL, params, DISPATCH_PARAMS_MAX);
+      }
+   }
+   uint32_t cycles = ESP.getCycleCount() - start;
+
+   LOG(PSTR("Dispatch: %u requests, %u cycles per request\n"), (unsigned int)(passes * count), (unsigned int)(cycles / (passes * count)));
+}
@@ -0,0 +1,48 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller request dispatcher
+
+   Maps an HTTP request to the user actions it carries. The query string is tokenized once: each parameter name
+   is hashed while it is scanned and looked up with a compile-time perfect hash (see Dispatch.cpp), and its value
+   is parsed as an integer in the same pass, so handlers never need to search or convert the request text.
+   A request may carry several actions (e.g. ?DISTANCE=48&DURATION=120&DIR=away&START=1); they are returned in the
+   order they were sent and the caller applies them as one transaction.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <Arduino.h>
+
+/*
+ user actions in HTML request stream
+ also includes URI requests that invoke no action but will send the HTML file anyways (always need to reply to client)
+*/
+typedef enum:uint8_t { 
+   NULL_ACTION, IGNORE, SLIDER_STATE, ENDSTOP_STATE, SET_DISTANCE, SET_DURATION, SET_TL_DISTANCE,
+   SET_TL_DURATION, SET_TL_IMAGES, SET_DIRECTION, START_STATE, HOME_CARRIAGE, CALIBRATE, FORGET, RESUME,
+   DIRECTION, START_MOVE, MECHANICS, SHUTTER_STATE, SET_TL_SHOTS, SET_TL_GAP, SET_TL_STOPS, SET_TL_HOLD,
+} T_Action;
+
+#define DISPATCH_PARAMS_MAX	12							// actions kept per request (any more are ignored)
+
+// one recognized request parameter
+typedef struct {
+   T_Action		action;
+   bool			numeric;										// the value is an integer that fits in a long
+   uint8_t		length;										// characters in text
+   long			value;										// integer value (0 if none, not a number or out of range)
+   const char	*text;										// value as sent, ending at '&', ' ' or NUL (not terminated)
+} Action_Param;
+
+uint8_t	dispatchActions(const char *path, const char *query, Action_Param *params, const uint8_t max);
+bool		dispatchValueIs(const Action_Param &param, const char *text);
+void		dispatchBenchmark(void);
+
+#endif
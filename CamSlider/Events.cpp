@@ -0,0 +1,153 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller live status events (Server-Sent Events)
+
+   eventNotify() may be called from an ISR, so it only sets bits in a volatile mask. eventService() collects the
+   mask with interrupts disabled, adds it to each subscriber's pending set, then sends pending messages round-robin
+   until the time budget is used up. A message is only written when it fits in the client's free send space, so a
+   slow reader never blocks the loop. Anything not sent stays pending for the next pass.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_INFO
+
+#include "Events.h"
+#include "CamSlider.h"
+#include "Motion.h"
+#include "DebugLib.h"
+
+#define EVENT_MESSAGE_MAX		96							// longest single message
+
+// main sketch externs
+extern TL_Data						timelapse;
+extern const char					*carriageStateNames[];
+
+static const char eventHeader[] PROGMEM =
+   "HTTP/1.1 200 OK\r\n"
+   "Content-Type: text/event-stream\r\n"
+   "Cache-Control: no-cache\r\n"
+   "Connection: keep-alive\r\n"
+   "\r\n";
+
+static struct {
+   WiFiClient	client;
+   uint8_t		pending;												// events not yet sent to this subscriber
+   uint32_t		lastSteps;											// millis() when the step count was last sent
+} subscribers[EVENT_SUBSCRIBERS];
+
+static volatile uint8_t	notified = 0;							// events since the last service
+static uint8_t				next = 0;								// round-robin start position
+
+/*
+ called from loop() and from the endstop ISR, so the read-modify-write is done with interrupts masked
+*/
+void ICACHE_RAM_ATTR eventNotify ( const uint8_t events ) {
+   uint32_t saved = xt_rsil(15);
+
+   notified |= events;
+   xt_wsr_ps(saved);
+}
+
+/*
+ take over a client that requested the event stream; its current state is sent first
+ returns false if there is no free subscriber slot
+*/
+bool eventSubscribe ( WiFiClient &client ) {
+   for ( uint8_t i = 0; i < EVENT_SUBSCRIBERS; i++ ) {
+      if ( !subscribers[i].client.connected() ) {
+         subscribers[i].client = client;
+         subscribers[i].client.setNoDelay(true);
+         subscribers[i].client.write_P(eventHeader, sizeof(eventHeader) - 1);
+         subscribers[i].pending = EVENT_STATE | EVENT_STEPS | EVENT_IMAGES;
+         subscribers[i].lastSteps = 0;
+         INFO(F("Event subscriber"), i);
+         return true;
+      }
+   }
+   return false;
+}
+
+/*
+ format the message for one event into buf; returns its length
+*/
+static int formatEvent ( const uint8_t event, char *buf ) {
+   switch ( event ) {
+   case EVENT_STATE:
+      return snprintf_P(buf, EVENT_MESSAGE_MAX, PSTR("event: state\ndata: {\"state\":\"%s\",\"running\":%s}\n\n"),
+         carriageStateNames[motionStatus().state], motionStatus().running ? "true" : "false");
+
+   case EVENT_STEPS:
+      return snprintf_P(buf, EVENT_MESSAGE_MAX, PSTR("event: steps\ndata: {\"steps\":%d}\n\n"), motionStatus().stepsTaken);
+
+   case EVENT_IMAGES:
+      return snprintf_P(buf, EVENT_MESSAGE_MAX, PSTR("event: images\ndata: {\"count\":%d,\"images\":%d}\n\n"),
+         timelapse.imageCount, timelapse.totalImages);
+
+   case EVENT_ENDSTOP:
+      return snprintf_P(buf, EVENT_MESSAGE_MAX, PSTR("event: endstop\ndata: {\"steps\":%d}\n\n"), motionStatus().stepsTaken);
+
+   default:
+      return 0;
+   }
+}
+
+/*
+ push pending events to the subscribers
+*/
+void eventService ( void ) {
+   uint32_t	start = micros();
+   uint8_t	events;
+   char		buf[EVENT_MESSAGE_MAX];
+
+   noInterrupts();
+   events = notified;
+   notified = 0;
+   interrupts();
+
+   for ( uint8_t i = 0; i < EVENT_SUBSCRIBERS; i++ ) {
+      if ( subscribers[i].client.connected() ) {
+         subscribers[i].pending |= events;
+      } else {
+         subscribers[i].pending = 0;
+      }
+   }
+
+   for ( uint8_t n = 0; n < EVENT_SUBSCRIBERS; n++ ) {
+      uint8_t i = (next + n) % EVENT_SUBSCRIBERS;
+
+      if ( !subscribers[i].pending ) {
+         continue;
+      }
+      for ( uint8_t event = EVENT_STATE; event <= EVENT_ENDSTOP; event <<= 1 ) {
+         int length;
+
+         if ( !(subscribers[i].pending & event) ) {
+            continue;
+         }
+         // throttled: leave it pending until the interval has passed
+         if ( (event == EVENT_STEPS) && ((millis() - subscribers[i].lastSteps) < EVENT_STEPS_MSEC) ) {
+            continue;
+         }
+         if ( (micros() - start) > EVENT_BUDGET_USEC ) {
+            // resume with this subscriber on the next pass
+            next = i;
+            return;
+         }
+         length = formatEvent(event, buf);
+         if ( (int)subscribers[i].client.availableForWrite() < length ) {
+            // a slow reader: keep its events pending rather than wait for the TCP window
+            break;
+         }
+         subscribers[i].client.write((const uint8_t *)buf, length);
+         subscribers[i].pending &= ~event;
+         if ( event == EVENT_STEPS ) {
+            subscribers[i].lastSteps = millis();
+         }
+      }
+   }
+}
@@ -0,0 +1,37 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller live status events (Server-Sent Events)
+
+   Browsers subscribe with GET /events and keep the connection open. The motion code calls eventNotify() when
+   something changes and the changes are pushed to every subscriber as small SSE messages from eventService(),
+   which is called on each loop() pass and stops after EVENT_BUDGET_USEC. Step counts are sent at most every
+   EVENT_STEPS_MSEC; the final count is always sent.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <ESP8266WiFi.h>
+
+#define EVENT_PATH				"/events"
+#define EVENT_SUBSCRIBERS		3							// max concurrent subscribers
+#define EVENT_BUDGET_USEC		1000						// max time spent pushing events per loop() pass
+#define EVENT_STEPS_MSEC		250						// minimum time between step count updates
+
+// change notifications (bit mask)
+#define EVENT_STATE				0x01						// carriageState transition
+#define EVENT_STEPS				0x02						// step count
+#define EVENT_IMAGES				0x04						// timelapse image count
+#define EVENT_ENDSTOP			0x08						// endstop hit
+
+void	eventNotify(const uint8_t events);
+bool	eventSubscribe(WiFiClient &client);
+void	eventService(void);
+
+#endif
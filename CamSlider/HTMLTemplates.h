@@ -0,0 +1,431 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller HTML templates
+
+   GENERATED by tools/html2progmem.py from the .html files in CamSlider/data - DO NOT EDIT
+
+   Each table is a list of literal fragments, each followed by the token whose value is substituted there.
+   The last entry of every table has the token TOK_END.
+   static_assets holds the gzip compressed static files, served by URL path.
+
+*/
+
+#ifndef HTMLTEMPLATES_H
+#define HTMLTEMPLATES_H
+
+typedef enum:uint8_t {
+   TOK_DIRECTION,
+   TOK_DIRECTION_CSS,
+   TOK_DISTANCE,
+   TOK_DISTANCE_CSS,
+   TOK_DURATION,
+   TOK_DURATION_CSS,
+   TOK_ELAPSED,
+   TOK_ENDSTOP,
+   TOK_ENDSTOP_CSS,
+   TOK_MEAS_SPEED,
+   TOK_MECH,
+   TOK_MODE,
+   TOK_MODE_CSS,
+   TOK_RESUME_COUNT,
+   TOK_RESUME_CSS,
+   TOK_SHUTTER,
+   TOK_SHUTTER_CSS,
+   TOK_SPEED,
+   TOK_START,
+   TOK_START_CSS,
+   TOK_TL_COUNT,
+   TOK_TL_DISTANCE,
+   TOK_TL_DISTANCE_CSS,
+   TOK_TL_DURATION,
+   TOK_TL_DURATION_CSS,
+   TOK_TL_GAP,
+   TOK_TL_HOLD,
+   TOK_TL_IMAGES,
+   TOK_TL_IMAGES_CSS,
+   TOK_TL_INTERVAL,
+   TOK_TL_MOVEDIST,
+   TOK_TL_SHOTS,
+   TOK_TL_SHUTTER_CSS,
+   TOK_TL_STOPS,
+   TOK_TRAVELED,
+   TOK_END
+} T_Token;
+
+typedef struct {
+   PGM_P       literal;                            // fragment text (NUL terminated, in flash)
+   uint16_t    length;                             // strlen(literal)
+   T_Token     token;                              // substitution following the literal
+} HTML_Fragment;
+
+// video_body.html
+static const char video_body_html_0[] PROGMEM =
+   "\n"
+   "\t<BODY>\n"
+   "\t\t<H1>CAMERA SLIDER CONTROL</H1>\n"
+   "\t\t<! the movement form sends all of its fields with whichever of its buttons is pressed; the server applies them together>\n"
+   "\n"
+   "\t\t<fieldset>\n"
+   "\t\t\t<legend>Mode</legend>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char video_body_html_1[] PROGMEM =
+   "\" value=\"";
+static const char video_body_html_2[] PROGMEM =
+   "\" name=\"MODE_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t\t<BR><BR>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<label>Endstop Action</label>\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char video_body_html_3[] PROGMEM =
+   "\" value=\"";
+static const char video_body_html_4[] PROGMEM =
+   "\" name=\"ENDSTOP_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t\t<fieldset>\n"
+   "\t\t\t\t<legend>Slider Movement</legend>\n"
+   "\t\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char video_body_html_5[] PROGMEM =
+   "\">Distance (inches)</label>\n"
+   "\t\t\t\t\t<input type =\"text\" name=\"DISTANCE\" class =\"bigtext\" size=\"3\" value=\"";
+static const char video_body_html_6[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char video_body_html_7[] PROGMEM =
+   "\">Duration (sec)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"DURATION\" class=\"bigtext\" size=\"5\" value=\"";
+static const char video_body_html_8[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Submit\" />\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label>Speed (in/sec)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"SPEED\" class=\"bigtext\" size=\"5\" value=\"";
+static const char video_body_html_9[] PROGMEM =
+   "\" disabled />\n"
+   "\t\t\t\t\t<BR><BR>\n"
+   "\t\t\t\t\t<label>Direction</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char video_body_html_10[] PROGMEM =
+   "\" value=\"";
+static const char video_body_html_11[] PROGMEM =
+   "\" name=\"DIRECTION_BTN\"/>\n"
+   "\t\t\t\t\t<label>Run</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char video_body_html_12[] PROGMEM =
+   "\" value=\"";
+static const char video_body_html_13[] PROGMEM =
+   "\" name=\"START_BTN\"/>\n"
+   "\t\t\t\t</form>\n"
+   "\t\t\t</fieldset>\n"
+   "\t\t\t<fieldset>\n"
+   "\t\t\t\t<legend>Status</legend>\n"
+   "\t\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t\t<label>Distance (in):</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"travel\" class=\"bigtext\" value=\"";
+static const char video_body_html_14[] PROGMEM =
+   "\" size=\"6\" disabled />\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label>Time (sec):</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"elapsed\" class=\"bigtext\" value=\"";
+static const char video_body_html_15[] PROGMEM =
+   "\" size=\"6\" disabled />\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label>Speed (in/sec)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"meas\" class=\"bigtext\" value=\"";
+static const char video_body_html_16[] PROGMEM =
+   "\" size=\"6\" disabled />\n"
+   "\t\t\t\t</form>\n"
+   "\t\t\t</fieldset>\n"
+   "\t\t</fieldset>\n"
+   "\t\t<BR><BR>\n"
+   "\t\t<form  class=\"big\" method=\"get\">\n"
+   "\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Refresh\" name=\"REFRESH_BTN\"/>\n"
+   "\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Home\" name=\"HOME_BTN\"/>\n"
+   "\t\t</form>\n"
+   "\t</BODY>\n"
+   "\n";
+static const HTML_Fragment video_body_html[] PROGMEM = {
+   { video_body_html_0, 265, TOK_MODE_CSS },
+   { video_body_html_1, 9, TOK_MODE },
+   { video_body_html_2, 139, TOK_ENDSTOP_CSS },
+   { video_body_html_3, 9, TOK_ENDSTOP },
+   { video_body_html_4, 134, TOK_DISTANCE_CSS },
+   { video_body_html_5, 102, TOK_DISTANCE },
+   { video_body_html_6, 39, TOK_DURATION_CSS },
+   { video_body_html_7, 97, TOK_DURATION },
+   { video_body_html_8, 186, TOK_SPEED },
+   { video_body_html_9, 98, TOK_DIRECTION_CSS },
+   { video_body_html_10, 9, TOK_DIRECTION },
+   { video_body_html_11, 89, TOK_START_CSS },
+   { video_body_html_12, 9, TOK_START },
+   { video_body_html_13, 207, TOK_TRAVELED },
+   { video_body_html_14, 125, TOK_ELAPSED },
+   { video_body_html_15, 125, TOK_MEAS_SPEED },
+   { video_body_html_16, 294, TOK_END },
+};
+
+// timelapse_body.html
+static const char timelapse_body_html_0[] PROGMEM =
+   "\n"
+   "\t<BODY>\n"
+   "\t\t<H1>CAMERA SLIDER CONTROL</H1>\n"
+   "\t\t<! the movement form sends all of its fields with whichever of its buttons is pressed; the server applies them together>\n"
+   "\n"
+   "\t\t<fieldset>\n"
+   "\t\t\t<legend>Mode</legend>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char timelapse_body_html_1[] PROGMEM =
+   "\" value=\"";
+static const char timelapse_body_html_2[] PROGMEM =
+   "\" name=\"MODE_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t\t<BR><BR>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<label>Endstop Action</label>\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char timelapse_body_html_3[] PROGMEM =
+   "\" value=\"";
+static const char timelapse_body_html_4[] PROGMEM =
+   "\" name=\"ENDSTOP_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t\t<fieldset>\n"
+   "\t\t\t\t<legend>Slider Movement</legend>\n"
+   "\t\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_5[] PROGMEM =
+   "\">Distance (in)</label>\n"
+   "\t\t\t\t\t<input type =\"text\" name=\"TL_DIST\" class =\"bigtext\" size=\"3\" value=\"";
+static const char timelapse_body_html_6[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_7[] PROGMEM =
+   "\">Duration (sec)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_DURN\" class=\"bigtext\" size=\"5\" value=\"";
+static const char timelapse_body_html_8[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_9[] PROGMEM =
+   "\">Images</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_IMAGES\" class=\"bigtext\" size=\"4\" value=\"";
+static const char timelapse_body_html_10[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR><BR>\n"
+   "\t\t\t\t\t<label>Shutter</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char timelapse_body_html_11[] PROGMEM =
+   "\" value=\"";
+static const char timelapse_body_html_12[] PROGMEM =
+   "\" name=\"SHUTTER_BTN\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_13[] PROGMEM =
+   "\">Exposure (ms)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_HOLD\" class=\"bigtext\" size=\"6\" value=\"";
+static const char timelapse_body_html_14[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_15[] PROGMEM =
+   "\">Shots</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_SHOTS\" class=\"bigtext\" size=\"1\" value=\"";
+static const char timelapse_body_html_16[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_17[] PROGMEM =
+   "\">Gap (ms)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_GAP\" class=\"bigtext\" size=\"6\" value=\"";
+static const char timelapse_body_html_18[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label style=\"color:";
+static const char timelapse_body_html_19[] PROGMEM =
+   "\">Bracket (EV)</label>\n"
+   "\t\t\t\t\t<input type=\"text\" name=\"TL_STOPS\" class=\"bigtext\" size=\"1\" value=\"";
+static const char timelapse_body_html_20[] PROGMEM =
+   "\"/>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Submit\" />\n"
+   "\t\t\t\t\t<BR><BR>\n"
+   "\t\t\t\t\t<label>Direction</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char timelapse_body_html_21[] PROGMEM =
+   "\" value=\"";
+static const char timelapse_body_html_22[] PROGMEM =
+   "\" name=\"DIRECTION_BTN\"/>\n"
+   "\t\t\t\t\t<label>Run</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char timelapse_body_html_23[] PROGMEM =
+   "\" value=\"";
+static const char timelapse_body_html_24[] PROGMEM =
+   "\" name=\"START_BTN\"/>\n"
+   "\t\t\t\t</form>\n"
+   "\t\t\t</fieldset>\n"
+   "\t\t\t<fieldset>\n"
+   "\t\t\t\t<legend>Sequence</legend>\n"
+   "\t\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t\t<label>Step (in):</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"movedist\" class=\"bigtext\" value=\"";
+static const char timelapse_body_html_25[] PROGMEM =
+   "\" size=\"3\" disabled />\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label>Interval:</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"interval\" class=\"bigtext\" value=\"";
+static const char timelapse_body_html_26[] PROGMEM =
+   "\" size=\"5\" disabled />\n"
+   "\t\t\t\t\t<BR>\n"
+   "\t\t\t\t\t<label>Count</label>\n"
+   "\t\t\t\t\t<input type=\"text\" id=\"count\" class=\"bigtext\" value=\"";
+static const char timelapse_body_html_27[] PROGMEM =
+   "\" size=\"4\" disabled />\n"
+   "\t\t\t\t</form>\n"
+   "\t\t\t\t<form class=\"big\" style=\"display:";
+static const char timelapse_body_html_28[] PROGMEM =
+   "\">\n"
+   "\t\t\t\t\t<label>Interrupted at image ";
+static const char timelapse_body_html_29[] PROGMEM =
+   "</label>\n"
+   "\t\t\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Resume\" name=\"RESUME_BTN\"/>\n"
+   "\t\t\t\t</form>\n"
+   "\t\t\t</fieldset>\n"
+   "\t\t</fieldset>\n"
+   "\t\t<BR><BR>\n"
+   "\t\t<form  class=\"big\" method=\"get\">\n"
+   "\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Refresh\" name=\"REFRESH_BTN\"/>\n"
+   "\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Home\" name=\"HOME_BTN\"/>\n"
+   "\t\t</form>\n"
+   "\t</BODY>\n"
+   "\n";
+static const HTML_Fragment timelapse_body_html[] PROGMEM = {
+   { timelapse_body_html_0, 265, TOK_MODE_CSS },
+   { timelapse_body_html_1, 9, TOK_MODE },
+   { timelapse_body_html_2, 139, TOK_ENDSTOP_CSS },
+   { timelapse_body_html_3, 9, TOK_ENDSTOP },
+   { timelapse_body_html_4, 134, TOK_TL_DISTANCE_CSS },
+   { timelapse_body_html_5, 97, TOK_TL_DISTANCE },
+   { timelapse_body_html_6, 39, TOK_TL_DURATION_CSS },
+   { timelapse_body_html_7, 96, TOK_TL_DURATION },
+   { timelapse_body_html_8, 39, TOK_TL_IMAGES_CSS },
+   { timelapse_body_html_9, 90, TOK_TL_IMAGES },
+   { timelapse_body_html_10, 86, TOK_SHUTTER_CSS },
+   { timelapse_body_html_11, 9, TOK_SHUTTER },
+   { timelapse_body_html_12, 58, TOK_TL_SHUTTER_CSS },
+   { timelapse_body_html_13, 95, TOK_TL_HOLD },
+   { timelapse_body_html_14, 39, TOK_TL_SHUTTER_CSS },
+   { timelapse_body_html_15, 88, TOK_TL_SHOTS },
+   { timelapse_body_html_16, 39, TOK_TL_SHUTTER_CSS },
+   { timelapse_body_html_17, 89, TOK_TL_GAP },
+   { timelapse_body_html_18, 39, TOK_TL_SHUTTER_CSS },
+   { timelapse_body_html_19, 95, TOK_TL_STOPS },
+   { timelapse_body_html_20, 156, TOK_DIRECTION_CSS },
+   { timelapse_body_html_21, 9, TOK_DIRECTION },
+   { timelapse_body_html_22, 89, TOK_START_CSS },
+   { timelapse_body_html_23, 9, TOK_START },
+   { timelapse_body_html_24, 207, TOK_TL_MOVEDIST },
+   { timelapse_body_html_25, 124, TOK_TL_INTERVAL },
+   { timelapse_body_html_26, 117, TOK_TL_COUNT },
+   { timelapse_body_html_27, 72, TOK_RESUME_CSS },
+   { timelapse_body_html_28, 36, TOK_RESUME_COUNT },
+   { timelapse_body_html_29, 365, TOK_END },
+};
+
+// disabled_body.html
+static const char disabled_body_html_0[] PROGMEM =
+   "\n"
+   "\t<BODY>\n"
+   "\t\t<H1>CAMERA SLIDER CONTROL</H1>\n"
+   "\t\t<! every button must be in its own form so the GET request has ONLY that entry>\n"
+   "\n"
+   "\t\t<fieldset>\n"
+   "\t\t\t<legend>Mode</legend>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button ";
+static const char disabled_body_html_1[] PROGMEM =
+   "\" value=\"";
+static const char disabled_body_html_2[] PROGMEM =
+   "\" name=\"MODE_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t</fieldset>\n"
+   "\t\t<fieldset>\n"
+   "\t\t\t<legend>Mechanics</legend>\n"
+   "\t\t\t<form class=\"big\">\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"";
+static const char disabled_body_html_3[] PROGMEM =
+   "\" name=\"MECH_BTN\" />\n"
+   "\t\t\t</form>\n"
+   "\t\t</fieldset>\n"
+   "\t\t<BR><BR>\n"
+   "\t\t<form  class=\"big\" method=\"get\">\n"
+   "\t\t\t<P>\n"
+   "\t\t\t\t<input type=\"submit\" class=\"button greybkgd\" value=\"Refresh\" name=\"REFRESH_BTN\"/>\n"
+   "            <input type=\"submit\" class=\"button orangebkgd\" value=\"Forget Home Net\" name=\"FORGET_BTN\"/>\n"
+   "            <BR><BR>\n"
+   "            <input type=\"submit\" class=\"button bluebkgd\" value=\"Calibrate\" name=\"CALI_BTN\"/>\n"
+   "\t\t\t</P>\n"
+   "\t\t</form>\n"
+   "\t</BODY>\n"
+   "\n";
+static const HTML_Fragment disabled_body_html[] PROGMEM = {
+   { disabled_body_html_0, 224, TOK_MODE_CSS },
+   { disabled_body_html_1, 9, TOK_MODE },
+   { disabled_body_html_2, 167, TOK_MECH },
+   { disabled_body_html_3, 430, TOK_END },
+};
+
+typedef struct {
+   const char      *path;                         // URL path
+   const char      *type;                         // Content-Type
+   PGM_P           etag;                          // strong ETag, quoted
+   const uint8_t   *data;                         // gzip compressed content (in flash)
+   uint16_t        length;                        // bytes in data
+} Static_Asset;
+
+#define STATIC_ASSET_COUNT 1
+#define ASSET_ETAG_MAX 19                          // longest ETag including the quotes and NUL
+
+// style.css: 1141 bytes, 454 compressed
+#define STYLE_CSS_PATH "/style.css"
+static const char style_css_etag[] PROGMEM = "\"bcff5a8efccce7a2\"";
+static const uint8_t style_css_gz[] PROGMEM = {
+   0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x53, 0xDB, 0x4E, 0xEB, 0x30,
+   0x10, 0x7C, 0x4E, 0xBE, 0x62, 0x25, 0xC4, 0x0B, 0x52, 0x42, 0x5A, 0x4E, 0x01, 0x35, 0x4F, 0x88,
+   0x8B, 0xCE, 0x23, 0xD2, 0xE1, 0x07, 0xEC, 0x78, 0xE3, 0x5A, 0x75, 0xED, 0xC8, 0x76, 0xA0, 0x39,
+   0xA8, 0xFF, 0xCE, 0xBA, 0xA1, 0x55, 0x69, 0x13, 0x10, 0x89, 0x94, 0x44, 0x3B, 0x9E, 0x19, 0xEF,
+   0x64, 0xCD, 0xAD, 0xE8, 0xE0, 0x3D, 0x4D, 0x38, 0xAB, 0x96, 0xD2, 0xD9, 0xD6, 0x88, 0xAC, 0xB2,
+   0xDA, 0xBA, 0x39, 0x70, 0x4D, 0xA5, 0x32, 0xDD, 0xA4, 0x8B, 0x49, 0x5C, 0xF0, 0x59, 0xED, 0x50,
+   0x6B, 0xFB, 0x56, 0xA6, 0x49, 0x6D, 0x4D, 0xC8, 0xBC, 0xFA, 0x8F, 0x73, 0x98, 0x4C, 0x8B, 0xF3,
+   0x5D, 0xA5, 0x66, 0x2B, 0xA5, 0xBB, 0x39, 0x78, 0x66, 0x7C, 0xE6, 0xD1, 0xA9, 0x3A, 0x4A, 0x34,
+   0x07, 0x0A, 0x6F, 0x0B, 0x15, 0x30, 0x16, 0x35, 0xE3, 0xA8, 0x07, 0x01, 0x94, 0x68, 0x44, 0x44,
+   0x0E, 0x4C, 0xAE, 0x8A, 0xEF, 0x4D, 0x76, 0x2A, 0x55, 0xC7, 0x4C, 0x14, 0xC9, 0x23, 0xB8, 0xD7,
+   0x18, 0xDE, 0x56, 0xCE, 0x95, 0xFC, 0xA5, 0x4D, 0x4F, 0x0A, 0xB8, 0x0E, 0x47, 0xC4, 0x9F, 0x43,
+   0x20, 0x66, 0x1B, 0x82, 0x35, 0xC3, 0x71, 0x9F, 0xFD, 0xB9, 0xBF, 0x7B, 0x9A, 0x15, 0x25, 0x5C,
+   0x5E, 0x40, 0xEB, 0x11, 0xA4, 0x43, 0x34, 0xB0, 0x40, 0x87, 0x10, 0x2C, 0xAC, 0xD8, 0x92, 0xDE,
+   0x0B, 0xE5, 0xE9, 0x81, 0x20, 0xB0, 0x66, 0xAD, 0x0E, 0xC0, 0xB1, 0xB6, 0x84, 0x7B, 0x34, 0xF4,
+   0xDD, 0x6D, 0xA1, 0xC7, 0x7F, 0xCF, 0xB7, 0xD3, 0xEB, 0x6B, 0xF8, 0xFB, 0xF2, 0xF2, 0x4C, 0x80,
+   0x7B, 0x45, 0x07, 0x17, 0x97, 0x64, 0x68, 0x9D, 0x40, 0xB2, 0x31, 0xD6, 0x60, 0x79, 0x1C, 0x79,
+   0xD2, 0x30, 0x21, 0x94, 0x91, 0x73, 0x98, 0x35, 0x6B, 0x8A, 0xA0, 0x59, 0x53, 0x2D, 0xF6, 0x98,
+   0x31, 0xAD, 0xA4, 0xA1, 0x50, 0xC9, 0x01, 0xDD, 0xAE, 0x28, 0xB0, 0xB2, 0x8E, 0x05, 0x65, 0xCD,
+   0x5E, 0x4F, 0x28, 0xDF, 0x68, 0x46, 0x2D, 0x2B, 0xA3, 0x95, 0xC1, 0x8C, 0x6B, 0x1B, 0x87, 0xE7,
+   0x30, 0xA0, 0x59, 0x2F, 0xBB, 0x62, 0x4E, 0x2A, 0x22, 0x4E, 0xC9, 0x69, 0x3A, 0xDB, 0x96, 0xAA,
+   0xD6, 0xF9, 0xB8, 0x9B, 0xC6, 0xAA, 0xDE, 0x26, 0x66, 0x45, 0xFD, 0x77, 0x7C, 0x29, 0x05, 0x24,
+   0xC9, 0xFB, 0x40, 0x5A, 0x78, 0x13, 0xEF, 0x12, 0xBE, 0x0C, 0xEB, 0x86, 0x16, 0x53, 0x7C, 0x91,
+   0x4A, 0x4D, 0xC3, 0x56, 0x04, 0xCD, 0xB8, 0xCA, 0x16, 0xDE, 0x6B, 0xF4, 0x61, 0xD0, 0x0F, 0x76,
+   0x28, 0xC6, 0x39, 0x04, 0x1E, 0x33, 0xC8, 0x88, 0xF2, 0x30, 0x12, 0x7B, 0xD6, 0x00, 0xA9, 0x87,
+   0x4F, 0x9D, 0xB8, 0x6E, 0x71, 0xDC, 0x2A, 0xA2, 0x47, 0x1C, 0xD8, 0x24, 0x69, 0x1E, 0x47, 0xFC,
+   0x9B, 0x68, 0x8A, 0xE2, 0xFE, 0xF1, 0x61, 0x72, 0x42, 0x84, 0x78, 0x51, 0x3A, 0x0C, 0x04, 0x73,
+   0x4B, 0x1A, 0x8B, 0x28, 0x13, 0x67, 0x23, 0x6F, 0x5A, 0xD7, 0xE8, 0xF1, 0xCD, 0xF7, 0xF0, 0x89,
+   0x5E, 0x9A, 0xAF, 0x18, 0x9D, 0xD3, 0xC0, 0x46, 0x89, 0x9F, 0xF8, 0x29, 0xF3, 0x03, 0xA2, 0x06,
+   0x30, 0x60, 0x75, 0x04, 0x00, 0x00,
+};
+
+static const Static_Asset static_assets[] PROGMEM = {
+   { STYLE_CSS_PATH, "text/css", style_css_etag, style_css_gz, 454 },
+};
+
+#endif
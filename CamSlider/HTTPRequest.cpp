@@ -0,0 +1,219 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller incremental HTTP request parser
+
+   Only the request line is kept. The offsets of the path and the query string are recorded as the separators
+   arrive: in "GET /?DISTANCE=12 HTTP/1.1" the path starts at offset 4 and the query at offset 6.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include "HTTPRequest.h"
+
+#define CONTENT_LENGTH			"content-length:"
+#define IF_NONE_MATCH			"if-none-match:"
+#define CONNECTION				"connection:"
+#define HTTP_1_1					" HTTP/1.1"
+
+void requestBegin ( HTTP_Request &request ) {
+   request.state = REQ_METHOD;
+   request.length = 0;
+   request.path = 0;
+   request.query = 0;
+   request.headerLength = 0;
+   request.eol = 0;
+   request.contentLength = 0;
+   request.bodyLength = 0;
+   request.line[0] = '\0';
+   request.body[0] = '\0';
+   request.etag[0] = '\0';
+   request.http11 = false;
+   request.keepAlive = false;
+   request.start = millis();
+}
+
+/*
+ a partial request has taken too long, or a kept-alive connection has been idle too long
+*/
+bool requestTimedOut ( const HTTP_Request &request ) {
+   return (millis() - request.start) > (requestIdle(request) ? REQUEST_IDLE_MSEC : REQUEST_TIMEOUT_MSEC);
+}
+
+/*
+ true until the first byte of the request is received
+*/
+bool requestIdle ( const HTTP_Request &request ) {
+   return (request.state == REQ_METHOD) && (request.length == 0);
+}
+
+/*
+ true if the comma separated header value contains token (case insensitive)
+*/
+static bool headerHas ( const char *value, const char *token ) {
+   size_t length = strlen(token);
+
+   for ( ; *value; value++ ) {
+      if ( strncasecmp(value, token, length) == 0 ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+/*
+ true if the request method is method (e.g. "GET")
+*/
+bool requestMethodIs ( const HTTP_Request &request, const char *method ) {
+   size_t length = strlen(method);
+
+   return (request.path == (length + 1)) && (strncmp(request.line, method, length) == 0);
+}
+
+/*
+ true if the request path (without the query string) is exactly path
+*/
+bool requestPathIs ( const HTTP_Request &request, const char *path ) {
+   size_t		length = strlen(path);
+   const char	*start = &request.line[request.path];
+
+   return (strncmp(start, path, length) == 0) && ((start[length] == ' ') || (start[length] == '?') || (start[length] == '\0'));
+}
+
+/*
+ add one character of the request line
+*/
+static void parseLine ( HTTP_Request &request, const char c ) {
+   if ( c == '\r' ) {
+      return;
+   } else if ( c == '\n' ) {
+      // end of the request line
+      if ( requestIdle(request) ) {
+         return;														// empty lines ahead of a request (e.g. a stray CRLF after the last one)
+      }
+      if ( request.state == REQ_METHOD ) {
+         request.state = REQ_ERROR;
+         return;
+      }
+      request.line[request.length] = '\0';
+      request.http11 = (request.length >= (sizeof(HTTP_1_1) - 1)) &&
+         (strcmp(&request.line[request.length - (sizeof(HTTP_1_1) - 1)], HTTP_1_1) == 0);
+      request.keepAlive = request.http11;
+      request.eol = 1;
+      request.state = REQ_HEADERS;
+      return;
+   }
+   if ( request.length >= (REQUEST_LINE_MAX - 1) ) {
+      request.state = REQ_ERROR;
+      return;
+   }
+
+   switch ( request.state ) {
+   case REQ_METHOD:
+      if ( c == ' ' ) {
+         request.path = request.length + 1;
+         request.state = REQ_PATH;
+      }
+      break;
+
+   case REQ_PATH:
+   case REQ_QUERY:
+      if ( c == ' ' ) {
+         request.state = REQ_VERSION;
+      } else if ( (c == '?') && (request.state == REQ_PATH) ) {
+         request.query = request.length + 1;
+         request.state = REQ_QUERY;
+      }
+      break;
+
+   default:
+      break;
+   }
+   request.line[request.length++] = c;
+}
+
+/*
+ a complete header line has been received - pick out the ones we use
+*/
+static void parseHeader ( HTTP_Request &request ) {
+   request.header[request.headerLength] = '\0';
+   if ( strncasecmp(request.header, CONTENT_LENGTH, sizeof(CONTENT_LENGTH) - 1) == 0 ) {
+      long length = atol(&request.header[sizeof(CONTENT_LENGTH) - 1]);
+
+      if ( (length < 0) || (length >= REQUEST_BODY_MAX) ) {
+         request.state = REQ_ERROR;
+      } else {
+         request.contentLength = (uint16_t)length;
+      }
+   } else if ( strncasecmp(request.header, IF_NONE_MATCH, sizeof(IF_NONE_MATCH) - 1) == 0 ) {
+      strncpy(request.etag, &request.header[sizeof(IF_NONE_MATCH) - 1], REQUEST_ETAG_MAX - 1);
+      request.etag[REQUEST_ETAG_MAX - 1] = '\0';
+   } else if ( strncasecmp(request.header, CONNECTION, sizeof(CONNECTION) - 1) == 0 ) {
+      if ( headerHas(&request.header[sizeof(CONNECTION) - 1], "close") ) {
+         request.keepAlive = false;
+      } else if ( headerHas(&request.header[sizeof(CONNECTION) - 1], "keep-alive") ) {
+         request.keepAlive = true;
+      }
+   }
+   request.headerLength = 0;
+}
+
+/*
+ add one character of the header section; a blank line ends it
+*/
+static void parseHeaders ( HTTP_Request &request, const char c ) {
+   if ( c == '\n' ) {
+      if ( ++request.eol == 2 ) {
+         request.state = request.contentLength ? REQ_BODY : REQ_READY;
+      } else {
+         parseHeader(request);
+      }
+   } else if ( c != '\r' ) {
+      request.eol = 0;
+      if ( request.headerLength < (HEADER_LINE_MAX - 1) ) {
+         request.header[request.headerLength++] = c;
+      }
+   }
+}
+
+/*
+ read whatever is available from the client, spending no more than budget usec
+ returns REQ_READY once the request line, all header lines and the body (if any) have been received
+*/
+RequestState requestPoll ( HTTP_Request &request, WiFiClient &client, const uint32_t budget ) {
+   uint32_t start = micros();
+
+   while ( (request.state != REQ_READY) && (request.state != REQ_ERROR) && client.available() ) {
+      char c = (char)client.read();
+
+      if ( requestIdle(request) ) {
+         request.start = millis();									// the request timeout runs from its first byte
+      }
+
+      switch ( request.state ) {
+      case REQ_HEADERS:
+         parseHeaders(request, c);
+         break;
+
+      case REQ_BODY:
+         request.body[request.bodyLength++] = c;
+         if ( request.bodyLength == request.contentLength ) {
+            request.body[request.bodyLength] = '\0';
+            request.state = REQ_READY;
+         }
+         break;
+
+      default:
+         parseLine(request, c);
+         break;
+      }
+
+      if ( (micros() - start) > budget ) {
+         break;
+      }
+   }
+   return request.state;
+}
@@ -0,0 +1,60 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller incremental HTTP request parser
+
+   Reads whatever bytes the client has available on each loop() pass, up to a time budget, so a slow client can
+   never stall loop(). The request line is kept in a bounded buffer and split into its path and query string as it
+   arrives. Header lines are examined one at a time for the few headers we use and then discarded, and a (short)
+   body is read if Content-Length is given. The If-None-Match value is kept for revalidating static assets.
+   Connections are persistent by default for HTTP/1.1 (and for HTTP/1.0 only with Connection: keep-alive, and then
+   only for a response with a Content-Length - see HTTPWriter.h); after the response, requestBegin() is called again
+   to read the next request from the same connection. The caller polls until the request is complete.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef HTTPREQUEST_H
+#define HTTPREQUEST_H
+
+#include <ESP8266WiFi.h>
+
+#define REQUEST_LINE_MAX		128						// longest accepted request line (including NUL)
+#define HEADER_LINE_MAX			64							// longer header lines are truncated (they are never needed in full)
+#define REQUEST_BODY_MAX		128						// largest accepted request body (including NUL)
+#define REQUEST_ETAG_MAX		48							// If-None-Match value kept (including NUL)
+#define REQUEST_BUDGET_USEC	500						// max time spent reading per poll
+#define REQUEST_TIMEOUT_MSEC	3000						// drop clients that do not complete a request in this time
+#define REQUEST_IDLE_MSEC		10000						// drop keep-alive connections idle this long between requests
+
+typedef enum:uint8_t { REQ_METHOD, REQ_PATH, REQ_QUERY, REQ_VERSION, REQ_HEADERS, REQ_BODY, REQ_READY, REQ_ERROR } RequestState;
+
+typedef struct {
+   RequestState	state;
+   char				line[REQUEST_LINE_MAX];			// request line as received, NUL terminated
+   uint8_t			length;								// characters in line
+   uint8_t			path;									// offset of the path in line
+   uint8_t			query;								// offset of the query string in line (0 == none)
+   char				header[HEADER_LINE_MAX];		// header line being received
+   uint8_t			headerLength;
+   uint8_t			eol;									// consecutive line ends seen (2 == blank line ending the headers)
+   char				body[REQUEST_BODY_MAX];			// request body, NUL terminated
+   uint16_t			contentLength;						// from the Content-Length header
+   uint16_t			bodyLength;							// body characters received so far
+   char				etag[REQUEST_ETAG_MAX];			// If-None-Match header value (empty == none)
+   bool				http11;								// request line version is HTTP/1.1 (false == HTTP/1.0)
+   bool				keepAlive;							// keep the connection open after the response
+   uint32_t			start;								// millis() at requestBegin(), then at the first byte of the request
+} HTTP_Request;
+
+void				requestBegin(HTTP_Request &request);
+RequestState	requestPoll(HTTP_Request &request, WiFiClient &client, const uint32_t budget);
+bool				requestTimedOut(const HTTP_Request &request);
+bool				requestIdle(const HTTP_Request &request);
+bool				requestMethodIs(const HTTP_Request &request, const char *method);
+bool				requestPathIs(const HTTP_Request &request, const char *path);
+
+#endif
@@ -0,0 +1,193 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller streaming HTTP response writer
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include "HTTPWriter.h"
+
+/*
+ reason phrase for the status codes we send
+*/
+static const __FlashStringHelper *reason ( const int code ) {
+   switch ( code ) {
+   case 200:
+      return F("OK");
+
+   case 304:
+      return F("Not Modified");
+
+   case 400:
+      return F("Bad Request");
+
+   case 404:
+      return F("Not Found");
+
+   case 409:
+      return F("Conflict");
+
+   case 503:
+      return F("Service Unavailable");
+
+   default:
+      return F("Error");
+   }
+}
+
+/*
+ start a response: the status line and headers are sent as-is, everything after that is chunked unless the length
+ of the body is given (or the client is HTTP/1.0, when it is sent as-is and the connection must be closed after it)
+ headers (optional) are extra header lines, each terminated by CRLF; contentType may be NULL for a 304 response
+*/
+void HTTPWriter::begin ( WiFiClient &target, const int code, const char *contentType, const char *headers,
+                         const int32_t length ) {
+   client = &target;
+   used = 0;
+   total = 0;
+   chunked = false;
+   lost = false;
+   if ( !http11 && (code != 304) && (length == RESPONSE_CHUNKED) ) {
+      keepAlive = false;												// the end of the body is the end of the connection
+   }
+
+   print(http11 ? F("HTTP/1.1 ") : F("HTTP/1.0 "));
+   print(code);
+   print(' ');
+   println(reason(code));
+   if ( contentType ) {
+      print(F("Content-Type: "));
+      println(contentType);
+   }
+   if ( headers ) {
+      print(headers);
+   }
+   if ( code == 304 ) {
+      // no body
+   } else if ( length == RESPONSE_CHUNKED ) {
+      if ( http11 ) {
+         println(F("Transfer-Encoding: chunked"));
+      }
+   } else {
+      print(F("Content-Length: "));
+      println(length);
+   }
+   println(keepAlive ? F("Connection: keep-alive") : F("Connection: close"));
+   println();
+   flush();
+   chunked = http11 && (code != 304) && (length == RESPONSE_CHUNKED);
+}
+
+/*
+ send any buffered output followed by the terminating zero-length chunk
+*/
+void HTTPWriter::end ( void ) {
+   flush();
+   if ( chunked ) {
+      send((const uint8_t *)"0\r\n\r\n", 5);
+      chunked = false;
+   }
+}
+
+size_t HTTPWriter::write ( uint8_t c ) {
+   if ( used == RESPONSE_BUFFER_SIZE ) {
+      flush();
+   }
+   buffer[CHUNK_HEADER_SIZE + used++] = c;
+   return 1;
+}
+
+size_t HTTPWriter::write ( const uint8_t *data, size_t length ) {
+   size_t count = length;
+
+   while ( count ) {
+      size_t n = RESPONSE_BUFFER_SIZE - used;
+
+      if ( n == 0 ) {
+         flush();
+         continue;
+      }
+      if ( n > count ) {
+         n = count;
+      }
+      memcpy(&buffer[CHUNK_HEADER_SIZE + used], data, n);
+      used += n;
+      data += n;
+      count -= n;
+   }
+   return length;
+}
+
+/*
+ same as write() for data in flash
+*/
+size_t HTTPWriter::write_P ( PGM_P data, size_t length ) {
+   size_t count = length;
+
+   while ( count ) {
+      size_t n = RESPONSE_BUFFER_SIZE - used;
+
+      if ( n == 0 ) {
+         flush();
+         continue;
+      }
+      if ( n > count ) {
+         n = count;
+      }
+      memcpy_P(&buffer[CHUNK_HEADER_SIZE + used], data, n);
+      used += n;
+      data += n;
+      count -= n;
+   }
+   return length;
+}
+
+/*
+ send the buffer contents, framed as a chunk once the header has been sent
+ the chunk size line is written right-aligned into the space reserved in front of the payload
+*/
+void HTTPWriter::flush ( void ) {
+   uint8_t	*start = &buffer[CHUNK_HEADER_SIZE];
+   size_t	length = used;
+
+   if ( (used == 0) || (client == nullptr) ) {
+      return;
+   }
+   if ( chunked ) {
+      char	sizeLine[sizeof("FFFF\r\n")];								// used is at most RESPONSE_BUFFER_SIZE: 3 digits
+      int	n = snprintf(sizeLine, sizeof(sizeLine), "%X\r\n", (unsigned int)used);
+
+      start -= n;
+      memcpy(start, sizeLine, n);
+      buffer[CHUNK_HEADER_SIZE + used] = '\r';
+      buffer[CHUNK_HEADER_SIZE + used + 1] = '\n';
+      length += n + 2;
+   }
+   send(start, length);
+   used = 0;
+}
+
+/*
+ write to the client until all of it has been taken
+ WiFiClient::write() returns less than asked for when the send buffer fills up, and 0 when the connection is gone
+ or the client has stopped reading for longer than the write timeout: then the connection is closed
+*/
+void HTTPWriter::send ( const uint8_t *data, size_t length ) {
+   while ( length && !lost ) {
+      size_t n = client->write(data, length);
+
+      if ( n == 0 ) {
+         lost = true;
+         keepAlive = false;
+         client->stop();
+         break;
+      }
+      data += n;
+      length -= n;
+      total += n;
+   }
+}
@@ -0,0 +1,62 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller streaming HTTP response writer
+
+   Output is collected in a small fixed buffer and sent to the client one chunk at a time using chunked transfer
+   encoding, so the memory needed to serve a page does not depend on the size of the page.
+   Each chunk (including its size line and trailing CRLF) goes to the client in a single write; a short write is
+   continued with the rest, and if the client takes nothing at all the connection is closed and the rest of the
+   response is discarded. Content of a known
+   size (static assets) is sent unframed with a Content-Length header instead, and a 304 response has no body.
+   HTTP/1.0 clients get an HTTP/1.0 status line and, as they do not understand chunked encoding, a body of unknown
+   size is sent unframed and ended by closing the connection.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef HTTPWRITER_H
+#define HTTPWRITER_H
+
+#include <ESP8266WiFi.h>
+
+#define RESPONSE_BUFFER_SIZE	512						// payload bytes per chunk
+#define CHUNK_HEADER_SIZE		5						// room for the chunk size line: up to 3 hex digits + CRLF
+#if RESPONSE_BUFFER_SIZE > 0xFFF
+   #error "RESPONSE_BUFFER_SIZE does not fit in the CHUNK_HEADER_SIZE chunk size line"
+#endif
+#define RESPONSE_CHUNKED		-1							// begin() length: body size not known in advance
+
+class HTTPWriter : public Print {
+public:
+   void		begin(WiFiClient &client, const int code, const char *contentType, const char *headers = nullptr,
+                    const int32_t length = RESPONSE_CHUNKED);
+   void		end(void);
+   size_t	write(uint8_t c) override;
+   size_t	write(const uint8_t *data, size_t length) override;
+   size_t	write_P(PGM_P data, size_t length);
+   uint32_t	sent(void) { return total; }					// bytes sent to the client for the current response
+   void		setKeepAlive(const bool keep) { keepAlive = keep; }	// Connection header for the following responses
+   void		setVersion(const bool version11) { http11 = version11; }	// request version for the following responses
+   bool		persistent(void) { return keepAlive; }		// false if the connection must be closed after this response
+
+   using Print::write;
+
+private:
+   void		flush(void);
+   void		send(const uint8_t *data, size_t length);
+
+   WiFiClient	*client = nullptr;
+   uint8_t		buffer[CHUNK_HEADER_SIZE + RESPONSE_BUFFER_SIZE + 2];	// chunk size line + payload + CRLF
+   uint16_t		used = 0;											// payload bytes in buffer
+   bool			chunked = false;									// false while sending the (unframed) header
+   bool			keepAlive = false;								// connection stays open after the response
+   bool			http11 = true;										// false == HTTP/1.0 client: no chunked encoding
+   bool			lost = false;										// a write failed: the rest of the response is dropped
+   uint32_t		total = 0;
+};
+
+#endif
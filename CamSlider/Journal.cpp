@@ -0,0 +1,223 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller persistent run state
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <stddef.h>
+#include "Journal.h"
+
+#define DEBUG_ERROR
+#include "DebugLib.h"
+
+extern "C" {
+#include "spi_flash.h"
+#include "user_interface.h"
+}
+
+extern "C" uint32_t _SPIFFS_start;								// SPIFFS area from the linker script
+extern "C" uint32_t _SPIFFS_end;									// the EEPROM emulation's sector follows it
+
+#define JOURNAL_RECORDS			(SPI_FLASH_SEC_SIZE / sizeof(Journal_Record))	// records per sector
+
+static_assert((CRED_ADDR + 1 + sizeof(struct station_config)) <= EEPROMSIZE, "EEPROMSIZE too small for the credentials shadow");
+static_assert((sizeof(Journal_Record) % 4) == 0, "flash is written in 4 byte words");
+
+static Journal_Record	state;									// last commit
+static uint16_t			firstSector = 0;						// first journal sector (0 == no journal)
+static uint8_t				sector = 0;								// sector being appended to (0 .. JOURNAL_SECTORS-1)
+static uint16_t			next = 0;								// record in that sector to write next
+static bool					resumable = false;					// an interrupted sequence was found at boot
+
+static uint32_t crc32 ( const void *data, size_t length ) {
+   const uint8_t	*p = (const uint8_t *)data;
+   uint32_t			crc = 0xFFFFFFFFUL;
+
+   while ( length-- ) {
+      crc ^= *p++;
+      for ( uint8_t bit = 0; bit < 8; bit++ ) {
+         crc = (crc >> 1) ^ (0xEDB88320UL & (0 - (crc & 1)));
+      }
+   }
+   return ~crc;
+}
+
+static uint32_t recordAddress ( const uint8_t journalSector, const uint16_t record ) {
+   return ((firstSector + journalSector) * SPI_FLASH_SEC_SIZE) + (record * sizeof(Journal_Record));
+}
+
+/*
+ true if a record slot has never been written since its sector was erased
+*/
+static bool blank ( const Journal_Record &record ) {
+   const uint32_t *word = (const uint32_t *)&record;
+
+   for ( size_t i = 0; i < (sizeof(record) / 4); i++ ) {
+      if ( word[i] != 0xFFFFFFFFUL ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+/*
+ append the state to the journal
+ a slot that is not blank (a write torn by a reset) is skipped, as flash bits can only be cleared; a full sector moves
+ the journal on to the next one, which is erased first
+ flash writes run with interrupts disabled, so only call this while the carriage is stopped
+*/
+static void commit ( void ) {
+   ++state.commit;
+   state.crc = crc32(&state, offsetof(Journal_Record, crc));
+   if ( firstSector == 0 ) {
+      return;
+   }
+
+   // the rest of this sector, then at most one erase: a failing flash must not wipe the older records
+   for ( uint16_t attempts = 0; attempts <= JOURNAL_RECORDS; attempts++ ) {
+      Journal_Record	record;
+      SpiFlashOpResult	result;
+
+      if ( next >= JOURNAL_RECORDS ) {
+         sector = (sector + 1) % JOURNAL_SECTORS;
+         next = 0;
+         noInterrupts();
+         result = spi_flash_erase_sector(firstSector + sector);
+         interrupts();
+         if ( result != SPI_FLASH_RESULT_OK ) {
+            ERROR(F("Journal sector erase failed"), firstSector + sector);
+            next = JOURNAL_RECORDS;
+            continue;
+         }
+      }
+      spi_flash_read(recordAddress(sector, next), (uint32_t *)&record, sizeof(record));
+      if ( !blank(record) ) {
+         ++next;
+         continue;
+      }
+      noInterrupts();
+      result = spi_flash_write(recordAddress(sector, next), (uint32_t *)&state, sizeof(state));
+      interrupts();
+      ++next;
+      if ( result == SPI_FLASH_RESULT_OK ) {
+         return;
+      }
+   }
+   ERROR(F("Journal commit failed"), state.commit);
+}
+
+/*
+ load the newest valid record
+*/
+void journalBegin ( void ) {
+   uint32_t	start = ((uint32_t)(uintptr_t)&_SPIFFS_start - 0x40200000UL) / SPI_FLASH_SEC_SIZE;
+   uint32_t	end = ((uint32_t)(uintptr_t)&_SPIFFS_end - 0x40200000UL) / SPI_FLASH_SEC_SIZE;
+   bool		found = false;
+
+   memset(&state, 0, sizeof(state));
+   resumable = false;
+   if ( (end < start) || ((end - start) < JOURNAL_SECTORS) ) {
+      ERROR(F("No SPIFFS area for the journal, sectors"), end - start);
+      firstSector = 0;
+      return;
+   }
+   firstSector = end - JOURNAL_SECTORS;
+
+   // nothing found: the first commit erases sector 0
+   sector = JOURNAL_SECTORS - 1;
+   next = JOURNAL_RECORDS;
+   for ( uint8_t s = 0; s < JOURNAL_SECTORS; s++ ) {
+      for ( uint16_t i = 0; i < JOURNAL_RECORDS; i++ ) {
+         Journal_Record	record;
+
+         spi_flash_read(recordAddress(s, i), (uint32_t *)&record, sizeof(record));
+         if ( (record.crc == crc32(&record, offsetof(Journal_Record, crc))) && (!found || ((int32_t)(record.commit - state.commit) > 0)) ) {
+            state = record;
+            sector = s;
+            next = i + 1;
+            found = true;
+         }
+      }
+   }
+   resumable = found && state.active;
+}
+
+const Journal_Record &journalState ( void ) {
+   return state;
+}
+
+/*
+ true while an interrupted sequence found at boot can still be resumed
+*/
+bool journalResumable ( void ) {
+   return resumable;
+}
+
+/*
+ the interrupted sequence is being continued (progress keeps going to the same journal sequence)
+*/
+void journalResume ( void ) {
+   resumable = false;
+}
+
+void journalCalibrated ( const uint32_t distance ) {
+   if ( distance != state.maxDistance ) {
+      state.maxDistance = distance;
+      commit();
+   }
+}
+
+void journalSequenceStart ( const TL_Data &sequence, const bool clockwise ) {
+   state.sequence = state.commit + 1;									// the commit made below
+   state.totalDistance = sequence.totalDistance;
+   state.totalDuration = sequence.totalDuration;
+   state.totalImages = sequence.totalImages;
+   state.moveDistance = sequence.moveDistance;
+   state.moveInterval = sequence.moveInterval;
+   state.shutter = sequence.shutter;
+   state.frames = 0;
+   state.active = true;
+   state.clockwise = clockwise;
+   resumable = false;
+   commit();
+}
+
+/*
+ a move of the active sequence has completed: frames moves are done and the carriage is at frame position frames
+*/
+void journalFrame ( const uint16_t frames, const bool clockwise ) {
+   state.frames = frames;
+   state.clockwise = clockwise;
+   commit();
+}
+
+/*
+ remember the access point of a successful connection - only committed when it changed
+*/
+void journalNetwork ( const Journal_Network &network ) {
+   if ( memcmp(&network, &state.network, sizeof(network)) != 0 ) {
+      state.network = network;
+      commit();
+   }
+}
+
+void journalMechanics ( const Mechanics_Profile &mechanics ) {
+   if ( memcmp(&mechanics, &state.mechanics, sizeof(mechanics)) != 0 ) {
+      state.mechanics = mechanics;
+      commit();
+   }
+}
+
+void journalSequenceEnd ( void ) {
+   resumable = false;
+   if ( state.active ) {
+      state.active = false;
+      state.frames = 0;
+      commit();
+   }
+}
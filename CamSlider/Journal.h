@@ -0,0 +1,82 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller persistent run state
+
+   Keeps the slider calibration and the active timelapse sequence (inputs and progress) across resets so a sequence
+   interrupted by a brownout or watchdog reset can be resumed from the last recorded frame. The access point used
+   for the last successful connection is kept as well, for the fast boot path in setupWiFi(), and so is the
+   mechanics profile (see Mechanics.h).
+
+   The state is journaled to JOURNAL_SECTORS flash sectors of its own at the top of the SPIFFS area (the file system
+   is not used), just below the sector the EEPROM emulation rewrites for the WiFi credentials shadow. Each commit
+   appends a CRC-checked record with a commit number to the current sector, and on boot the valid record with the
+   highest commit number wins. A sector is only erased when the journal moves on to it, so erases are spread evenly
+   over all the sectors, and a reset during a write or an erase can only damage that record or that sector: the
+   previous commit is earlier in the same sector or in another one.
+
+   Progress is committed after every move of a sequence, so a resumed sequence continues from where the last completed
+   move left the carriage. A move that was under way when the power failed is not recorded: the carriage can then be
+   up to one move further along than the journal says.
+
+   Flash writes run with interrupts disabled (about 1 msec for a record, tens of msec for a sector erase), so commits
+   are only made while the carriage is stopped. The flash layout must have a SPIFFS area of at least JOURNAL_SECTORS
+   sectors (e.g. 4M (1M SPIFFS)); without one nothing is kept.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Mechanics.h"
+
+#define JOURNAL_SECTORS			8							// flash sectors the journal rotates through
+
+// last working station connection
+typedef struct {
+   uint8_t	bssid[6];										// access point
+   uint8_t	channel;											// 0 == nothing cached
+   uint8_t	reserved;
+   uint32_t	ip;												// DHCP lease (used as a static address with FAST_BOOT_STATIC_IP)
+   uint32_t	gateway;
+   uint32_t	mask;
+   uint32_t	dns;
+} Journal_Network;
+
+// one journal record
+typedef struct {
+   uint32_t				commit;								// commit number - the valid record with the highest one is current
+   uint32_t				sequence;							// commit number at the start of the active sequence
+   uint32_t				maxDistance;						// calibrated slider length in inches (0 == not calibrated)
+   int32_t				totalDistance;						// timelapse inputs (see TL_Data)
+   int32_t				totalDuration;
+   int32_t				totalImages;
+   int32_t				moveDistance;
+   int32_t				moveInterval;
+   Shutter_Sequence	shutter;
+   uint16_t				frames;								// moves completed in the active sequence
+   uint8_t				active;								// a sequence was running
+   uint8_t				clockwise;							// carriage direction
+   Mechanics_Profile	mechanics;							// selected drive train profile
+   Journal_Network	network;
+   uint32_t				crc;									// CRC-32 of everything above
+} Journal_Record;
+
+void						journalBegin(void);
+const Journal_Record	&journalState(void);
+bool						journalResumable(void);
+void						journalCalibrated(const uint32_t distance);
+void						journalResume(void);
+void						journalSequenceStart(const TL_Data &sequence, const bool clockwise);
+void						journalFrame(const uint16_t frames, const bool clockwise);
+void						journalSequenceEnd(void);
+void						journalNetwork(const Journal_Network &network);
+void						journalMechanics(const Mechanics_Profile &mechanics);
+
+#endif
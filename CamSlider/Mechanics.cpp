@@ -0,0 +1,103 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller mechanics profiles
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_ERROR
+
+#include "Mechanics.h"
+#include "Journal.h"
+#include "DebugLib.h"
+
+Mechanics_State				mechanics;
+static Mechanics_Profile	selected;							// as persisted, including the custom profile values
+
+#define MECH_NAME(id, name, ...)	name,
+static const char *names[MECH_COUNT] = { MECH_BUILTIN(MECH_NAME) "custom" };
+#undef MECH_NAME
+
+const char *mechanicsName ( const uint8_t profile ) {
+   return (profile < MECH_COUNT) ? names[profile] : "";
+}
+
+/*
+ the values of a built-in profile (the custom profile has no defaults and comes back zeroed)
+*/
+Mechanics_Profile mechanicsDefaults ( const uint8_t profile ) {
+   Mechanics_Profile values;
+
+   memset(&values, 0, sizeof(values));
+   values.profile = profile;
+   switch ( profile ) {
+#define MECH_DEFAULTS(id, name, rev, teeth, pitch, micro, fullSpeed, fullAccel, travel)		\
+   case id:																								\
+      values.microsteps = micro;																	\
+      values.maxTravel = travel;																	\
+      values.stepsPerMM = MECH_STEPS_PER_MM(rev, teeth, pitch);						\
+      values.maxSpeed = (uint16_t)(fullSpeed);													\
+      values.accel = (uint16_t)(fullAccel);														\
+      break;
+   MECH_BUILTIN(MECH_DEFAULTS)
+#undef MECH_DEFAULTS
+
+   default:
+      break;
+   }
+   return values;
+}
+
+/*
+ make profile the active one and save the selection
+ for a built-in profile only the profile number is used (the saved custom values are kept); returns false, with
+ nothing changed, if the profile is not usable
+*/
+bool mechanicsSelect ( const Mechanics_Profile &profile ) {
+   Mechanics_Profile	values = (profile.profile == MECH_CUSTOM) ? profile : mechanicsDefaults(profile.profile);
+   uint64_t				stepsPerInch = ((uint64_t)values.stepsPerMM * values.microsteps * 254) / 10;
+
+   // steps per inch must fit the 16.16 fixed point and not round down to nothing
+   if ( (profile.profile >= MECH_COUNT) || !values.stepsPerMM || !values.maxSpeed || !values.accel || !values.maxTravel ||
+        !values.microsteps || (values.microsteps > MECH_MAX_MICROSTEPS) || (values.microsteps & (values.microsteps - 1)) ||
+        ((uint32_t)values.maxSpeed * values.microsteps > MECH_MAX_STEP_RATE) || !stepsPerInch || (stepsPerInch > UINT32_MAX) ) {
+      ERROR(F("Unusable mechanics profile"), profile.profile);
+      return false;
+   }
+
+   mechanics.profile = profile.profile;
+   mechanics.stepsPerInch = (uint32_t)stepsPerInch;
+   mechanics.inchesPerStep = (float)(1UL << MECH_FRAC_BITS) / mechanics.stepsPerInch;
+   mechanics.maxSpeed = (float)values.maxSpeed * values.microsteps;
+   mechanics.accel = (float)values.accel * values.microsteps;
+   mechanics.maxTravel = values.maxTravel;
+
+   if ( profile.profile == MECH_CUSTOM ) {
+      selected = profile;
+   } else {
+      selected.profile = profile.profile;
+   }
+   journalMechanics(selected);
+   return true;
+}
+
+/*
+ select the saved profile, or the first built-in one if it can no longer be used
+*/
+void mechanicsBegin ( const Mechanics_Profile &saved ) {
+   Mechanics_Profile fallback = saved;
+
+   selected = saved;
+   if ( !mechanicsSelect(saved) ) {
+      fallback.profile = 0;
+      mechanicsSelect(fallback);
+   }
+}
+
+const Mechanics_Profile &mechanicsProfile ( void ) {
+   return selected;
+}
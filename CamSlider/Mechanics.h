@@ -0,0 +1,135 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller mechanics profiles
+
+   A profile describes the drive train: full steps per mm of carriage travel (16.16 fixed point), the A4988
+   microstep factor, the motor's maximum speed and acceleration in full steps, and the longest travel. Distances in
+   the UI and the journal stay in inches; everything the step engine and the planner see is in (micro)steps.
+
+   The built-in profiles are listed in MECH_BUILTIN. Each gets a Mechanics<> specialisation whose conversions are
+   integer multiplies by a compile-time steps per inch, as cheap as the old INCHES_TO_STEPS() macro; the custom
+   profile (set through /api/mechanics) uses the generic fixed-point path. mechInchesToSteps() and friends switch on
+   the active profile once and call the matching specialisation.
+
+   The selection, and the custom profile values, are kept in the run state journal (see Journal.h).
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef MECHANICS_H
+#define MECHANICS_H
+
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Planner.h"
+
+#define MECH_FRAC_BITS			16							// fixed point fraction of steps per mm/inch
+#define MECH_MAX_MICROSTEPS	16							// A4988 limit
+#define MECH_MAX_STEP_RATE		20000						// fastest microstep rate a profile may ask of the step engine
+
+/*
+ built-in profiles: X(id, name, full steps per rev, pulley teeth, belt pitch in mm, microsteps, max speed, accel, travel)
+ full steps per rev * microsteps * 25.4 / (teeth * pitch) must be a whole number of steps per inch
+*/
+#define MECH_BUILTIN(X) \
+   X(MECH_HS24_GT2_FULL,	"17HS24 GT2 20T 1/1",	200, 20, 2, 1,  HS24_MAX_SPEED, MOVE_ACCEL, MAX_TRAVEL_DISTANCE) \
+   X(MECH_HS24_GT2_8TH,		"17HS24 GT2 20T 1/8",	200, 20, 2, 8,  HS24_MAX_SPEED, MOVE_ACCEL, MAX_TRAVEL_DISTANCE) \
+   X(MECH_HS24_GT2_16TH,	"17HS24 GT2 20T 1/16",	200, 20, 2, 16, HS24_MAX_SPEED, MOVE_ACCEL, MAX_TRAVEL_DISTANCE)
+
+#define MECH_ID(id, ...)	id,
+typedef enum:uint8_t { MECH_BUILTIN(MECH_ID) MECH_CUSTOM, MECH_COUNT } MechProfile;
+#undef MECH_ID
+
+#define MECH_STEPS_PER_INCH(rev, teeth, pitch, micro)	(((rev) * (micro) * 254UL) / ((teeth) * (pitch) * 10UL))
+#define MECH_STEPS_PER_MM(rev, teeth, pitch)				(((uint32_t)(rev) << MECH_FRAC_BITS) / ((teeth) * (pitch)))
+
+// persistent profile selection
+typedef struct {
+   uint8_t		profile;										// MechProfile
+   uint8_t		microsteps;									// the rest is the custom profile, kept while a built-in one is used
+   uint16_t		maxTravel;									// inches
+   uint32_t		stepsPerMM;									// full steps per mm, 16.16 fixed point
+   uint16_t		maxSpeed;									// full steps/sec
+   uint16_t		accel;										// full steps/sec/sec
+} Mechanics_Profile;
+
+// active profile, derived when it is selected
+typedef struct {
+   uint8_t		profile;
+   uint32_t		stepsPerInch;								// microsteps per inch, 16.16 fixed point
+   float			inchesPerStep;
+   float			maxSpeed;									// microsteps/sec
+   float			accel;										// microsteps/sec/sec
+   uint16_t		maxTravel;
+} Mechanics_State;
+
+extern Mechanics_State	mechanics;
+
+// one specialisation per profile
+template <uint8_t PROFILE> struct Mechanics;
+
+#define MECH_SPECIALISE(id, name, rev, teeth, pitch, micro, fullSpeed, fullAccel, travel)											\
+template <> struct Mechanics<id> {																									\
+   static const uint32_t STEPS_PER_INCH = MECH_STEPS_PER_INCH(rev, teeth, pitch, micro);									\
+   static_assert((MECH_STEPS_PER_INCH(rev, teeth, pitch, micro) * (teeth) * (pitch) * 10UL) == ((rev) * (micro) * 254UL),	\
+      "built-in profile must have a whole number of steps per inch");															\
+   static inline int32_t inchesToSteps ( const int32_t inches ) { return inches * (int32_t)STEPS_PER_INCH; }			\
+   static inline float stepsToInches ( const float steps ) { return steps * (1.0f / STEPS_PER_INCH); }					\
+};
+MECH_BUILTIN(MECH_SPECIALISE)
+#undef MECH_SPECIALISE
+
+// generic path for the custom profile
+template <> struct Mechanics<MECH_CUSTOM> {
+   static inline int32_t inchesToSteps ( const int32_t inches ) {
+      return (int32_t)(((int64_t)inches * mechanics.stepsPerInch + (1L << (MECH_FRAC_BITS - 1))) >> MECH_FRAC_BITS);
+   }
+   static inline float stepsToInches ( const float steps ) { return steps * mechanics.inchesPerStep; }
+};
+
+// conversions for the active profile
+#define MECH_TO_STEPS(id, ...)	case id: return Mechanics<id>::inchesToSteps(inches);
+#define MECH_TO_INCHES(id, ...)	case id: return Mechanics<id>::stepsToInches(steps);
+
+static inline int32_t mechInchesToSteps ( const int32_t inches ) {
+   switch ( mechanics.profile ) {
+   MECH_BUILTIN(MECH_TO_STEPS)
+   default:
+      return Mechanics<MECH_CUSTOM>::inchesToSteps(inches);
+   }
+}
+
+static inline float mechStepsToInches ( const float steps ) {
+   switch ( mechanics.profile ) {
+   MECH_BUILTIN(MECH_TO_INCHES)
+   default:
+      return Mechanics<MECH_CUSTOM>::stepsToInches(steps);
+   }
+}
+
+#undef MECH_TO_STEPS
+#undef MECH_TO_INCHES
+
+static inline float mechMaxSpeed ( void ) {
+   return mechanics.maxSpeed;
+}
+
+static inline float mechAccel ( void ) {
+   return mechanics.accel;
+}
+
+static inline uint16_t mechMaxTravel ( void ) {
+   return mechanics.maxTravel;
+}
+
+void							mechanicsBegin(const Mechanics_Profile &saved);
+bool							mechanicsSelect(const Mechanics_Profile &profile);
+const Mechanics_Profile	&mechanicsProfile(void);
+const char					*mechanicsName(const uint8_t profile);
+Mechanics_Profile			mechanicsDefaults(const uint8_t profile);
+
+#endif
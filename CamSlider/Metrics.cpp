@@ -0,0 +1,190 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller metrics registry
+
+   Each counter and histogram has a single writer (loop() or one interrupt handler), so updates are plain
+   increments. The page may read a histogram while an interrupt is updating it; a scrape can be off by one
+   observation, which is fine for monitoring.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include "Metrics.h"
+#include "Scheduler.h"
+
+#ifdef METRICS
+
+extern "C" {
+#include "umm_malloc/umm_malloc.h"
+}
+
+// one histogram: per-bucket counts (the last bucket is everything above the largest bound)
+typedef struct {
+   uint32_t	bucket[METRICS_BUCKETS + 1];
+   uint32_t	count;
+   uint64_t	sum;												// usec
+} Metric_Data;
+
+static const uint32_t			bounds[METRICS_BUCKETS] = METRICS_BOUNDS;	// in RAM: read from interrupts
+static volatile uint32_t		counters[C_COUNT];
+static volatile Metric_Data	histograms[H_COUNT];
+
+#define METRICS_STRINGS(id, name, help)	static const char name_##id[] PROGMEM = name; static const char help_##id[] PROGMEM = help;
+METRICS_COUNTERS(METRICS_STRINGS)
+METRICS_HISTOGRAMS(METRICS_STRINGS)
+#undef METRICS_STRINGS
+
+#define METRICS_NAMES(id, name, help)		{ name_##id, help_##id },
+static const struct {
+   PGM_P		name;
+   PGM_P		help;
+} counterNames[C_COUNT] = { METRICS_COUNTERS(METRICS_NAMES) },
+  histogramNames[H_COUNT] = { METRICS_HISTOGRAMS(METRICS_NAMES) };
+#undef METRICS_NAMES
+
+void ICACHE_RAM_ATTR metricsCount ( const Metric_Counter counter ) {
+   ++counters[counter];
+}
+
+void ICACHE_RAM_ATTR metricsObserve ( const Metric_Histogram histogram, const uint32_t usec ) {
+   volatile Metric_Data	*h = &histograms[histogram];
+   uint8_t					b = 0;
+
+   while ( (b < METRICS_BUCKETS) && (usec > bounds[b]) ) {
+      ++b;
+   }
+   ++h->bucket[b];
+   ++h->count;
+   h->sum += usec;
+}
+
+/*
+ Print has no 64 bit overload
+*/
+static void printU64 ( Print &out, uint64_t value ) {
+   char	buf[21];
+   char	*p = &buf[sizeof(buf) - 1];
+
+   *p = '\0';
+   do {
+      *--p = '0' + (char)(value % 10);
+      value /= 10;
+   } while ( value );
+   out.print(p);
+}
+
+static void printHeader ( Print &out, PGM_P name, PGM_P help, const __FlashStringHelper *type ) {
+   out.print(F("# HELP "));
+   out.print(FPSTR(name));
+   out.print(' ');
+   out.println(FPSTR(help));
+   out.print(F("# TYPE "));
+   out.print(FPSTR(name));
+   out.print(' ');
+   out.println(type);
+}
+
+static void printGauge ( Print &out, const __FlashStringHelper *name, const __FlashStringHelper *help, const uint32_t value ) {
+   out.print(F("# HELP "));
+   out.print(name);
+   out.print(' ');
+   out.println(help);
+   out.print(F("# TYPE "));
+   out.print(name);
+   out.println(F(" gauge"));
+   out.print(name);
+   out.print(' ');
+   out.println((unsigned long)value);
+}
+
+typedef enum:uint8_t { TASK_RUNS, TASK_USEC, TASK_MAX_USEC } TaskSeries;
+
+/*
+ one series per scheduler task, labeled with the task name
+*/
+static void printTasks ( Print &out, const __FlashStringHelper *name, const __FlashStringHelper *help,
+                         const __FlashStringHelper *type, const TaskSeries series ) {
+   out.print(F("# HELP "));
+   out.print(name);
+   out.print(' ');
+   out.println(help);
+   out.print(F("# TYPE "));
+   out.print(name);
+   out.print(' ');
+   out.println(type);
+   for ( uint8_t i = 0; i < schedulerTaskCount(); i++ ) {
+      const Sched_Task &task = schedulerTask(i);
+
+      out.print(name);
+      out.print(F("{task=\""));
+      out.print(task.name);
+      out.print(F("\"} "));
+      switch ( series ) {
+      case TASK_RUNS:
+         out.println((unsigned long)task.runs);
+         break;
+
+      case TASK_USEC:
+         printU64(out, task.usec);
+         out.println();
+         break;
+
+      case TASK_MAX_USEC:
+      default:
+         out.println((unsigned long)task.maxUsec);
+         break;
+      }
+   }
+}
+
+/*
+ write the text exposition format (version 0.0.4) to out
+*/
+void metricsRender ( Print &out ) {
+   for ( uint8_t i = 0; i < C_COUNT; i++ ) {
+      printHeader(out, counterNames[i].name, counterNames[i].help, F("counter"));
+      out.print(FPSTR(counterNames[i].name));
+      out.print(' ');
+      out.println((unsigned long)counters[i]);
+   }
+
+   for ( uint8_t i = 0; i < H_COUNT; i++ ) {
+      volatile Metric_Data	*h = &histograms[i];
+      uint32_t					cumulative = 0;
+
+      printHeader(out, histogramNames[i].name, histogramNames[i].help, F("histogram"));
+      for ( uint8_t b = 0; b < METRICS_BUCKETS; b++ ) {
+         cumulative += h->bucket[b];
+         out.print(FPSTR(histogramNames[i].name));
+         out.print(F("_bucket{le=\""));
+         out.print((unsigned long)bounds[b]);
+         out.print(F("\"} "));
+         out.println((unsigned long)cumulative);
+      }
+      out.print(FPSTR(histogramNames[i].name));
+      out.print(F("_bucket{le=\"+Inf\"} "));
+      out.println((unsigned long)(cumulative + h->bucket[METRICS_BUCKETS]));
+      out.print(FPSTR(histogramNames[i].name));
+      out.print(F("_sum "));
+      printU64(out, h->sum);
+      out.println();
+      out.print(FPSTR(histogramNames[i].name));
+      out.print(F("_count "));
+      out.println((unsigned long)h->count);
+   }
+
+   umm_info(NULL, 0);
+   printGauge(out, F("camslider_heap_free_bytes"), F("free heap"), ESP.getFreeHeap());
+   printGauge(out, F("camslider_heap_max_block_bytes"), F("largest free heap block"),
+      (uint32_t)ummHeapInfo.maxFreeContiguousBlocks * METRICS_UMM_BLOCK);
+
+   printTasks(out, F("camslider_task_runs_total"), F("scheduler task runs"), F("counter"), TASK_RUNS);
+   printTasks(out, F("camslider_task_microseconds_total"), F("scheduler task run time"), F("counter"), TASK_USEC);
+   printTasks(out, F("camslider_task_max_microseconds"), F("longest scheduler task run"), F("gauge"), TASK_MAX_USEC);
+}
+
+#endif
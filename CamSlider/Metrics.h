@@ -0,0 +1,66 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller metrics registry
+
+   Counters and fixed-bucket histograms updated from the hot paths (loop(), request handling, the step and endstop
+   interrupts) and served as a Prometheus-style text page at /metrics. Updates are a handful of integer operations
+   with no allocation; the page is rendered straight into the response writer.
+
+   All histograms count durations in microseconds against the same bucket bounds (METRICS_BOUNDS).
+
+   Enable by defining METRICS in CamSlider.h. When it is not defined, the macros below compile to nothing and
+   /metrics is not served.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+#include "CamSlider.h"
+
+#define METRICS_PATH				"/metrics"
+#define METRICS_BUCKETS			8							// finite buckets; the +Inf bucket is the total count
+#define METRICS_BOUNDS			{ 50, 100, 500, 1000, 5000, 10000, 50000, 100000 }		// bucket upper bounds (usec)
+#define METRICS_UMM_BLOCK		8							// umm_malloc block size in bytes
+
+// counters: X(id, name, help)
+#define METRICS_COUNTERS(X) \
+   X(C_LOOPS,					"camslider_loop_iterations_total",		"loop() iterations") \
+   X(C_REQUESTS,				"camslider_requests_total",				"HTTP requests served") \
+   X(C_ENDSTOP_HITS,			"camslider_endstop_hits_total",			"endstop switch closures acted on") \
+   X(C_STEPS,					"camslider_steps_total",					"step pulses issued")
+
+// histograms: X(id, name, help)
+#define METRICS_HISTOGRAMS(X) \
+   X(H_LOOP,					"camslider_loop_microseconds",			"loop() iteration time") \
+   X(H_WIFI,					"camslider_wifi_service_microseconds",	"time spent in WiFiService()") \
+   X(H_RENDER,					"camslider_render_microseconds",			"sendResponse() page render time") \
+   X(H_STEP_GAP,				"camslider_step_gap_microseconds",		"interval between step pulses") \
+   X(H_TIMER_LATE,			"camslider_timer_late_microseconds",	"timelapseMove() timer lateness")
+
+#define METRICS_ENUM(id, name, help)	id,
+typedef enum:uint8_t { METRICS_COUNTERS(METRICS_ENUM) C_COUNT } Metric_Counter;
+typedef enum:uint8_t { METRICS_HISTOGRAMS(METRICS_ENUM) H_COUNT } Metric_Histogram;
+#undef METRICS_ENUM
+
+#ifdef METRICS
+void		metricsCount(const Metric_Counter counter);
+void		metricsObserve(const Metric_Histogram histogram, const uint32_t usec);
+void		metricsRender(Print &out);
+
+   #define METRIC_COUNT(counter)				metricsCount(counter)
+   #define METRIC_TIMER(var)					uint32_t var = micros()
+   #define METRIC_OBSERVE(histogram, usec)	metricsObserve((histogram), (usec))
+#else
+   #define METRIC_COUNT(counter)
+   #define METRIC_TIMER(var)
+   #define METRIC_OBSERVE(histogram, usec)
+#endif
+
+#endif
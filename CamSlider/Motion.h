@@ -0,0 +1,64 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller motion command interface
+
+   The web front end never writes the motion state directly. It queues typed commands with motionCommand(), and the
+   endstop interrupt queues its events the same way on a queue of its own. The motion state machine in loop() applies
+   them in motionApply() between its iterations, so a command never lands in the middle of a state transition, and
+   publishes a snapshot of its state that everything outside the motion code reads through motionStatus().
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "CamSlider.h"
+
+#define MOTION_QUEUE_SIZE		8							// commands per queue (one slot is always free)
+
+typedef enum:uint8_t {
+   CMD_SET_PARAMS,											// set the move length (position, steps) and speed (steps/sec)
+   CMD_SET_DIRECTION,										// set the direction of the next move
+   CMD_SET_ENDSTOP,											// set the endstop action
+   CMD_START,													// start a move with the current parameters
+   CMD_STOP,													// stop the carriage and any timelapse sequence
+   CMD_HOME,													// return to the motor end
+   CMD_CALIBRATE,												// home, then measure the slider length
+   CMD_TIMELAPSE,												// start the timelapse sequence with the current inputs
+   CMD_RESUME,													// continue the timelapse sequence interrupted by a reset
+   CMD_ENDSTOP_HIT											// (interrupt) an endstop switch closed after position steps
+} MotionCommandType;
+
+typedef struct {
+   MotionCommandType	type;
+   bool					clockwise;
+   EndstopMode			endstop;
+   long					position;
+   float					speed;
+} Motion_Command;
+
+// state published by the motion state machine
+typedef struct {
+   CarriageMode		state;
+   bool					running;								// carriage is moving
+   bool					clockwise;							// true: away, false: towards motor
+   EndstopMode			endstop;								// action to take when an endstop is hit
+   bool					homing;								// homing (or calibration) move in progress
+   long					targetPosition;					// steps to travel
+   float					targetSpeed;						// steps/second
+   int					stepsTaken;							// steps executed in the current or last move
+   unsigned long		travelStart;						// start of the current move (millis)
+   unsigned long		lastRunDuration;					// duration of the last move (msec)
+   uint32_t				maxDistance;						// slider length in inches
+} Motion_Status;
+
+bool						motionCommand(const Motion_Command &command);
+void						motionApply(void);
+const Motion_Status	&motionStatus(void);
+
+#endif
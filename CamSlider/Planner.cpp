@@ -0,0 +1,178 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller motion planner
+
+   Both ramps take rampTime = k * V / A to reach cruise speed V with peak acceleration A (k = 1 for the trapezoid,
+   1.5 for the smoothstep S-curve) and cover V * rampTime / 2 steps. The time t(n) at which the carriage reaches
+   step n is computed once per table entry:
+      trapezoid	t = sqrt(2n / A)
+      S-curve		n = V * T * (u^3 - u^4 / 2) with u = t / T, solved for u by Newton's method from the previous u
+   and each entry holds the mean interval over the steps it covers, so the planned move time is preserved.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_LOG
+
+#include "Planner.h"
+#include "StepEngine.h"
+#include "CamSlider.h"
+#include "Mechanics.h"
+#include "DebugLib.h"
+
+#define SCURVE_FACTOR		1.5							// S-curve ramp time relative to the trapezoid
+#define NEWTON_ITERATIONS	4
+
+static float rampFactor ( const RampType type ) {
+   return (type == RAMP_SCURVE) ? SCURVE_FACTOR : 1.0;
+}
+
+/*
+ time in seconds to reach position (steps) on a ramp to speed with peak acceleration accel
+ u carries the S-curve solution from one call to the next (start at 0)
+*/
+static float rampTime ( const RampType type, const float position, const float speed, const float accel, float &u ) {
+   if ( type == RAMP_TRAPEZOID ) {
+      return sqrt(2.0 * position / accel);
+   }
+
+   float	T = SCURVE_FACTOR * speed / accel;
+   float	scale = speed * T;
+
+   if ( u <= 0.0 ) {
+      u = cbrt(position / scale);										// small-u approximation as a starting point
+   }
+   for ( uint8_t i = 0; i < NEWTON_ITERATIONS; i++ ) {
+      float f = scale * (u * u * u - u * u * u * u / 2.0) - position;
+      float df = scale * (3.0 * u * u - 2.0 * u * u * u);
+
+      if ( df <= 0.0 ) {
+         break;
+      }
+      u -= f / df;
+   }
+   u = constrain(u, 0.0, 1.0);
+   return u * T;
+}
+
+/*
+ plan a move of steps at cruise speed (steps/sec)
+*/
+void plannerBuild ( Motion_Plan &plan, const uint32_t steps, const float speed, const float accel, const RampType type ) {
+   float		cruiseSpeed = (speed < STEP_MIN_SPEED) ? STEP_MIN_SPEED : speed;
+   float		u = 0.0;
+   float		tPrev = 0.0;
+   uint32_t	total = 0;
+
+   plan.type = ((type == RAMP_CONSTANT) || (accel <= 0.0)) ? RAMP_CONSTANT : type;
+   plan.steps = steps;
+   plan.cruise = (uint32_t)(STEP_TIMER_HZ / cruiseSpeed);
+   plan.rampSteps = 0;
+   plan.shift = 0;
+   plan.entries = 0;
+
+   if ( plan.type != RAMP_CONSTANT ) {
+      // a short move never reaches cruise speed - ramp up for half of it and back down for the other half
+      plan.rampSteps = min((uint32_t)ceil(cruiseSpeed * rampFactor(type) * cruiseSpeed / accel / 2.0), steps / 2);
+      while ( (plan.rampSteps >> plan.shift) >= RAMP_TABLE_SIZE ) {
+         ++plan.shift;
+      }
+      plan.entries = (plan.rampSteps + ((uint32_t)1 << plan.shift) - 1) >> plan.shift;
+
+      for ( uint16_t i = 0; i < plan.entries; i++ ) {
+         uint32_t	first = (uint32_t)i << plan.shift;
+         uint32_t	last = min(first + ((uint32_t)1 << plan.shift), plan.rampSteps);
+         float		t = rampTime(plan.type, last, cruiseSpeed, accel, u);
+         uint32_t	interval = (uint32_t)(((t - tPrev) / (last - first)) * STEP_TIMER_HZ + 0.5);
+
+         plan.table[i] = max(interval, plan.cruise);				// never faster than cruise
+         total += plan.table[i] * (last - first);
+         tPrev = t;
+      }
+   }
+   plan.durationMsec = (uint32_t)((2ULL * total + (uint64_t)(steps - 2 * plan.rampSteps) * plan.cruise) / (STEP_TIMER_HZ / 1000));
+}
+
+/*
+ cruise speed that completes a move of steps in seconds including both ramps: solves seconds = k * V / A + steps / V
+ falls back to the constant speed estimate if the move is too short to fit the ramps
+*/
+float plannerCruiseSpeed ( const uint32_t steps, const float seconds, const float accel, const RampType type ) {
+   float k = rampFactor(type);
+   float discriminant = (accel * seconds) * (accel * seconds) - 4.0 * k * accel * steps;
+
+   if ( (type == RAMP_CONSTANT) || (accel <= 0.0) || (discriminant < 0.0) ) {
+      return steps / seconds;
+   }
+   return (accel * seconds - sqrt(discriminant)) / (2.0 * k);
+}
+
+/*
+ planned move time in msec without building the table
+*/
+uint32_t plannerMoveTime ( const uint32_t steps, const float speed, const float accel, const RampType type ) {
+   float k = rampFactor(type);
+
+   if ( (type == RAMP_CONSTANT) || (accel <= 0.0) ) {
+      return (uint32_t)(1000.0 * steps / speed);
+   }
+   if ( (k * speed * speed / accel) > steps ) {
+      // triangular: the first half of the full ramp up, then back down
+      float u = 0.0;
+
+      return (uint32_t)(1000.0 * 2.0 * rampTime(type, steps / 2.0, speed, accel, u));
+   }
+   return (uint32_t)(1000.0 * (k * speed / accel + steps / speed));
+}
+
+/*
+ time to let the carriage settle before an exposure
+ an abrupt stop needs the full CARR_SETTLE_MSEC; a ramped stop leaves less vibration, and less still the slower the
+ carriage was moving, so scale from CARR_SETTLE_MIN_MSEC up to the ceiling for the ramp type by the peak speed
+*/
+uint32_t plannerSettleTime ( const Motion_Plan &plan ) {
+   if ( plan.type == RAMP_CONSTANT ) {
+      return CARR_SETTLE_MSEC;
+   }
+
+   uint32_t	fastest = plan.entries ? plan.table[plan.entries - 1] : plan.cruise;
+   float		peak = (float)STEP_TIMER_HZ / fastest;
+   uint32_t	ceiling = (plan.type == RAMP_SCURVE) ? (CARR_SETTLE_MSEC / 3) : (CARR_SETTLE_MSEC / 2);
+
+   return CARR_SETTLE_MIN_MSEC + (uint32_t)((ceiling - CARR_SETTLE_MIN_MSEC) * min(peak / mechMaxSpeed(), (float)1.0));
+}
+
+/*
+ time plan construction for typical moves and print the cost per plan
+ distances are in inches, converted with the active mechanics profile
+ the per-step cost is reported by the loop profiler (step ISR cycles) while moves run
+*/
+void plannerBenchmark ( void ) {
+   static Motion_Plan	plan;
+   const struct {
+      uint32_t	steps;
+      float		speed;
+      RampType	type;
+   } moves[] = {
+      { (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_CONSTANT },				// 1 ft video move
+      { (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_TRAPEZOID },
+      { (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_SCURVE },
+      { (uint32_t)mechInchesToSteps(1), mechMaxSpeed(), RAMP_SCURVE },				// 1 in timelapse step (triangular)
+      { (uint32_t)mechInchesToSteps(mechMaxTravel()), mechInchesToSteps(1) / 2.0f, RAMP_SCURVE },	// full length slow video move (0.5 in/sec)
+   };
+
+   for ( uint8_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++ ) {
+      uint32_t start = ESP.getCycleCount();
+
+      plannerBuild(plan, moves[i].steps, moves[i].speed, mechAccel(), moves[i].type);
+      uint32_t cycles = ESP.getCycleCount() - start;
+
+      LOG(PSTR("Planner: type %u %u steps: %u usec, %u entries x %u steps, move %u msec, settle %u msec\n"), (unsigned int)moves[i].type,
+         (unsigned int)moves[i].steps, (unsigned int)(cycles / (F_CPU / 1000000L)), (unsigned int)plan.entries, (unsigned int)(1U << plan.shift),
+         (unsigned int)plan.durationMsec, (unsigned int)plannerSettleTime(plan));
+   }
+}
@@ -0,0 +1,51 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller motion planner
+
+   Builds the step interval schedule for a move before it starts. The acceleration ramp is tabulated in timer1 ticks
+   (fixed point, 0.2 usec per tick) so the step engine interrupt only indexes the table - no float math per step.
+   Deceleration uses the same table in reverse, and moves too short to reach the cruise speed use the first half of
+   the ramp on each side (triangular profile).
+
+   Ramp types:
+      RAMP_CONSTANT		no acceleration: every step at the cruise interval
+      RAMP_TRAPEZOID		constant acceleration
+      RAMP_SCURVE			jerk-limited: velocity follows a smoothstep curve, so acceleration rises and falls gradually;
+							takes 1.5 times as long as the trapezoid for the same peak acceleration
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <Arduino.h>
+
+#define RAMP_TABLE_SIZE			128						// ramp entries; longer ramps use one entry per 2^shift steps
+#define MOVE_ACCEL				800.0						// 17HS24 peak acceleration in full steps/sec/sec (see Mechanics.h)
+#define CARR_SETTLE_MIN_MSEC	500						// settle time after a slow ramped move
+
+typedef enum:uint8_t { RAMP_CONSTANT, RAMP_TRAPEZOID, RAMP_SCURVE } RampType;
+
+typedef struct {
+   RampType	type;
+   uint32_t	steps;										// total steps in the move
+   uint32_t	cruise;										// timer1 ticks per step at cruise speed
+   uint32_t	rampSteps;									// steps in the acceleration ramp (== deceleration ramp)
+   uint8_t	shift;										// each table entry covers 2^shift steps
+   uint16_t	entries;										// table entries in use
+   uint32_t	durationMsec;								// planned move time
+   uint32_t	table[RAMP_TABLE_SIZE];					// ticks between steps during the ramp, slowest first
+} Motion_Plan;
+
+void		plannerBuild(Motion_Plan &plan, const uint32_t steps, const float speed, const float accel, const RampType type);
+float		plannerCruiseSpeed(const uint32_t steps, const float seconds, const float accel, const RampType type);
+uint32_t	plannerMoveTime(const uint32_t steps, const float speed, const float accel, const RampType type);
+uint32_t	plannerSettleTime(const Motion_Plan &plan);
+void		plannerBenchmark(void);
+
+#endif
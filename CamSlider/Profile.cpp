@@ -0,0 +1,140 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller loop() profiling
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <Arduino.h>
+#include "Profile.h"
+#include "StepEngine.h"
+
+#ifdef LOOP_PROFILE
+
+#define DEBUG_LOG
+#include "DebugLib.h"
+
+#define PROFILE_STATES		4							// one entry per CarriageMode value
+
+// statistics for a single carriage state over one reporting window
+typedef struct {
+   uint32_t	iterations;								// loop() iterations in this state
+   uint32_t	totalMicros;							// time spent in loop() in this state
+   uint32_t	maxMicros;								// longest single iteration
+   uint32_t	maxPollGap;								// longest gap between consecutive motion FSM services
+   uint32_t	steps;									// steps actually taken
+   float		targetSpeed;							// last requested speed (steps/sec)
+} Loop_Stats;
+
+static Loop_Stats		stats[PROFILE_STATES];
+static uint32_t		loopStart = 0;						// micros() at the top of the current iteration
+static uint32_t		lastPoll = 0;						// micros() at the last FSM service (0 == none yet)
+static uint32_t		pollGap = 0;						// largest poll gap seen during the current iteration
+static uint32_t		stepCount = 0;						// steps taken during the current iteration
+static unsigned long	windowStart = 0;					// millis() at the start of the reporting window
+
+static const char *stateName ( const uint8_t state ) {
+   switch ( state ) {
+   case CARRIAGE_STOP:
+      return "STOP";
+
+   case CARRIAGE_TRAVEL:
+      return "TRAVEL";
+
+   case CARRIAGE_TRAVEL_REVERSE:
+      return "REVERSE";
+
+   case CARRIAGE_PARKED:
+      return "PARKED";
+
+   default:
+      return "?";
+   }
+}
+
+/*
+ print and reset the statistics for all states that saw any activity in this window
+*/
+static void profileReport ( void ) {
+   LOG(PSTR("---- loop() profile (%u msec window) ----\n"), (unsigned int)(millis() - windowStart));
+   for ( uint8_t i = 0; i < PROFILE_STATES; i++ ) {
+      Loop_Stats *s = &stats[i];
+
+      if ( s->iterations ) {
+         LOG(PSTR("%-8s n=%u avg=%u us max=%u us"), stateName(i), (unsigned int)s->iterations,
+            (unsigned int)(s->totalMicros / s->iterations), (unsigned int)s->maxMicros);
+         if ( s->steps || s->maxPollGap ) {
+            // step rate in hundredths of a step/sec to avoid float formatting
+            uint32_t rate = s->totalMicros ? (uint32_t)((uint64_t)s->steps * 100000000ULL / s->totalMicros) : 0;
+
+            LOG(PSTR(" poll gap max=%u us rate=%u.%02u steps/s (target %u)"), (unsigned int)s->maxPollGap,
+               (unsigned int)(rate / 100), (unsigned int)(rate % 100),
+               (unsigned int)s->targetSpeed);
+         }
+         LOG(PSTR("\n"));
+      }
+   }
+   LOG(PSTR("step interval jitter max=%u us, step ISR max=%u cycles\n"), (unsigned int)stepEngineJitter(true),
+      (unsigned int)stepEngineISRCycles(true));
+   memset(stats, 0, sizeof(stats));
+   windowStart = millis();
+}
+
+void profileLoopStart ( void ) {
+   loopStart = micros();
+   pollGap = 0;
+   stepCount = 0;
+}
+
+/*
+ called each time the motion FSM services the travel state
+ the gap between services is the longest time a segment change (end of move, endstop) could have been delayed
+*/
+void profilePoll ( void ) {
+   uint32_t now = micros();
+
+   if ( lastPoll && ((now - lastPoll) > pollGap) ) {
+      pollGap = now - lastPoll;
+   }
+   lastPoll = now;
+}
+
+void profileSteps ( const int steps ) {
+   if ( steps > 0 ) {
+      stepCount += steps;
+   }
+}
+
+void profileLoopEnd ( const CarriageMode state, const float speed ) {
+   uint32_t elapsed = micros() - loopStart;
+
+   if ( state < PROFILE_STATES ) {
+      Loop_Stats *s = &stats[state];
+
+      ++s->iterations;
+      s->totalMicros += elapsed;
+      if ( elapsed > s->maxMicros ) {
+         s->maxMicros = elapsed;
+      }
+      if ( pollGap > s->maxPollGap ) {
+         s->maxPollGap = pollGap;
+      }
+      s->steps += stepCount;
+      s->targetSpeed = speed;
+   }
+   if ( state != CARRIAGE_TRAVEL ) {
+      // gap measurement only makes sense between polls of the same move
+      lastPoll = 0;
+   }
+
+   if ( (millis() - windowStart) >= PROFILE_REPORT_MSEC ) {
+      profileReport();
+      lastPoll = 0;												// don't charge the report itself to the next poll gap
+   }
+}
+
+#endif
@@ -0,0 +1,44 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller loop() profiling
+
+   Measures the time spent in each loop() iteration, the worst-case gap between motion FSM services while the
+   carriage is moving, the achieved step rate compared with the requested speed and the step engine interval
+   jitter. Statistics are kept separately for each carriage state and printed on the serial port every
+   PROFILE_REPORT_MSEC.
+
+   Enable by defining LOOP_PROFILE in CamSlider.h. When it is not defined, the macros below compile to nothing.
+   The host simulation benchmark (sim/bench.cpp) builds with LOOP_PROFILE and supplies these hooks itself.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "CamSlider.h"
+
+#define PROFILE_REPORT_MSEC	5000						// reporting (and statistics reset) interval
+
+#ifdef LOOP_PROFILE
+void profileLoopStart(void);
+void profileLoopEnd(const CarriageMode state, const float speed);
+void profilePoll(void);
+void profileSteps(const int steps);
+
+   #define PROFILE_LOOP_START()				profileLoopStart()
+   #define PROFILE_LOOP_END(state, speed)	profileLoopEnd((state), (speed))
+   #define PROFILE_POLL()						profilePoll()
+   #define PROFILE_STEPS(n)					profileSteps(n)
+#else
+   #define PROFILE_LOOP_START()
+   #define PROFILE_LOOP_END(...)
+   #define PROFILE_POLL()
+   #define PROFILE_STEPS(n)
+#endif
+
+#endif
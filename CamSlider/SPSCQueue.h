@@ -0,0 +1,75 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller single-producer/single-consumer queue
+
+   A fixed size ring that one producer (e.g. an interrupt handler or the web front end) fills and one consumer
+   (the motion state machine) drains, without disabling interrupts. Only the producer writes head and only the
+   consumer writes tail; the item is copied before the index that publishes it is advanced, with a memory barrier
+   in between so neither the compiler nor the CPU can reorder the two.
+
+   SIZE must be a power of 2 and one slot is always left empty, so the queue holds SIZE - 1 items.
+   push() is forced inline so it can be called from an ICACHE_RAM_ATTR interrupt handler.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <Arduino.h>
+
+template <typename T, uint8_t SIZE>
+class SPSCQueue {
+   static_assert((SIZE >= 2) && ((SIZE & (SIZE - 1)) == 0), "SPSCQueue size must be a power of 2");
+
+public:
+   SPSCQueue() : head(0), tail(0), dropped(0) {}
+
+   // producer: returns false (and counts the loss) if the queue is full
+   __attribute__((always_inline)) inline bool push ( const T &item ) {
+      uint8_t h = head;
+      uint8_t next = (h + 1) & (SIZE - 1);
+
+      if ( next == tail ) {
+         ++dropped;
+         return false;
+      }
+      buffer[h] = item;
+      __sync_synchronize();
+      head = next;
+      return true;
+   }
+
+   // consumer: returns false if the queue is empty
+   bool pop ( T &item ) {
+      uint8_t t = tail;
+
+      if ( t == head ) {
+         return false;
+      }
+      item = buffer[t];
+      __sync_synchronize();
+      tail = (t + 1) & (SIZE - 1);
+      return true;
+   }
+
+   bool empty ( void ) const {
+      return head == tail;
+   }
+
+   uint16_t lost ( void ) const {
+      return dropped;
+   }
+
+private:
+   T						buffer[SIZE];
+   volatile uint8_t	head;									// next slot to write (producer)
+   volatile uint8_t	tail;									// next slot to read (consumer)
+   volatile uint16_t	dropped;								// items refused because the queue was full
+};
+
+#endif
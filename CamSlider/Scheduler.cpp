@@ -0,0 +1,197 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller cooperative task scheduler
+
+   Tasks are kept in the order they were added within each priority class. Times are compared as differences so
+   that millis() and micros() wrapping is harmless.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_ERROR
+
+#include "Scheduler.h"
+#include "DebugLib.h"
+
+typedef struct {
+   uint32_t			due;											// millis()
+   uint32_t			period;										// 0 == one-shot
+   Task_Function	function;
+} Sched_Timer;
+
+static Sched_Task		tasks[SCHED_TASKS] = { { "timers", NULL, TASK_CRITICAL } };	// entry 0 accounts for the timers
+static uint8_t			taskCount = 1;
+static Sched_Timer	heap[SCHED_TIMERS];
+static uint8_t			timerCount = 0;
+static uint8_t			nextIdle = 0;								// round-robin position among the idle tasks
+
+/*
+ true if timer a is due before timer b
+*/
+static inline bool before ( const Sched_Timer &a, const Sched_Timer &b ) {
+   return (int32_t)(a.due - b.due) < 0;
+}
+
+static void heapPush ( const Sched_Timer &timer ) {
+   uint8_t i = timerCount++;
+
+   // sift up
+   while ( (i > 0) && before(timer, heap[(i - 1) / 2]) ) {
+      heap[i] = heap[(i - 1) / 2];
+      i = (i - 1) / 2;
+   }
+   heap[i] = timer;
+}
+
+static void heapPop ( void ) {
+   Sched_Timer	last = heap[--timerCount];
+   uint8_t		i = 0;
+
+   // sift the last entry down from the root
+   while ( true ) {
+      uint8_t child = (2 * i) + 1;
+
+      if ( child >= timerCount ) {
+         break;
+      }
+      if ( ((child + 1) < timerCount) && before(heap[child + 1], heap[child]) ) {
+         ++child;
+      }
+      if ( !before(heap[child], last) ) {
+         break;
+      }
+      heap[i] = heap[child];
+      i = child;
+   }
+   heap[i] = last;
+}
+
+static bool addTimer ( const uint32_t msec, const uint32_t period, Task_Function function ) {
+   Sched_Timer timer = { (uint32_t)(millis() + msec), period, function };
+
+   if ( timerCount == SCHED_TIMERS ) {
+      ERROR(F("Timer heap full"), SCHED_TIMERS);
+      return false;
+   }
+   heapPush(timer);
+   return true;
+}
+
+/*
+ run a task and account for its run time
+*/
+static void runTask ( Sched_Task &task, Task_Function function ) {
+   uint32_t start = micros();
+   uint32_t elapsed;
+
+   function();
+   elapsed = micros() - start;
+   ++task.runs;
+   task.usec += elapsed;
+   if ( elapsed > task.maxUsec ) {
+      task.maxUsec = elapsed;
+   }
+   task.lastRun = millis();
+}
+
+static void runCritical ( void ) {
+   for ( uint8_t i = 1; i < taskCount; i++ ) {
+      if ( tasks[i].priority == TASK_CRITICAL ) {
+         runTask(tasks[i], tasks[i].function);
+      }
+   }
+}
+
+/*
+ run every timer that is due; a periodic timer is put back with its next due time
+*/
+static void runTimers ( void ) {
+   while ( timerCount && ((int32_t)(millis() - heap[0].due) >= 0) ) {
+      Sched_Timer timer = heap[0];
+
+      heapPop();
+      if ( timer.period ) {
+         timer.due += timer.period;
+         heapPush(timer);
+      }
+      runTask(tasks[0], timer.function);
+   }
+}
+
+/*
+ add a task; returns false if the table is full
+*/
+bool schedulerAdd ( const char *name, Task_Function function, const TaskPriority priority, const uint16_t interval ) {
+   if ( taskCount == SCHED_TASKS ) {
+      ERROR(F("Task table full"), name);
+      return false;
+   }
+   tasks[taskCount].name = name;
+   tasks[taskCount].function = function;
+   tasks[taskCount].priority = priority;
+   tasks[taskCount].interval = interval;
+   tasks[taskCount].lastRun = millis();
+   ++taskCount;
+   return true;
+}
+
+/*
+ call function once, msec from now
+*/
+bool schedulerTimeout ( const uint32_t msec, Task_Function function ) {
+   return addTimer(msec, 0, function);
+}
+
+/*
+ call function every msec, starting msec from now
+*/
+bool schedulerInterval ( const uint32_t msec, Task_Function function ) {
+   return addTimer(msec, msec, function);
+}
+
+/*
+ one scheduler pass - call from loop()
+*/
+void schedulerRun ( void ) {
+   uint32_t passStart = micros();
+
+   runCritical();
+   if ( timerCount && ((int32_t)(millis() - heap[0].due) >= 0) ) {
+      runTimers();
+      runCritical();
+   }
+
+   for ( uint8_t i = 1; i < taskCount; i++ ) {
+      if ( tasks[i].priority == TASK_NORMAL ) {
+         runTask(tasks[i], tasks[i].function);
+         runCritical();
+      }
+   }
+
+   // idle tasks share what is left of the pass; one that has waited longer than its interval runs anyway
+   for ( uint8_t n = 1; n < taskCount; n++ ) {
+      uint8_t		i = 1 + ((nextIdle + n) % (taskCount - 1));
+      Sched_Task	&task = tasks[i];
+
+      if ( task.priority != TASK_IDLE ) {
+         continue;
+      }
+      if ( ((micros() - passStart) < SCHED_PASS_USEC) || (task.interval && ((millis() - task.lastRun) >= task.interval)) ) {
+         runTask(task, task.function);
+         runCritical();
+         nextIdle = i - 1;
+      }
+   }
+}
+
+uint8_t schedulerTaskCount ( void ) {
+   return taskCount;
+}
+
+const Sched_Task &schedulerTask ( const uint8_t index ) {
+   return tasks[index];
+}
@@ -0,0 +1,57 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller cooperative task scheduler
+
+   loop() calls schedulerRun() once per pass. Tasks are added in setup() with a priority class:
+      TASK_CRITICAL	run on every pass, first, and again after every lower priority task (motion, shutter)
+      TASK_NORMAL		run once per pass, after the due timers (web serving - bounded by its own time budgets)
+      TASK_IDLE		run round-robin while the pass is shorter than SCHED_PASS_USEC, or when one has not run for
+							its interval (LED, OTA, log draining)
+   so the motion FSM is never more than one lower priority task away from its next service.
+
+   One-shot and periodic timers are kept in a binary min-heap ordered by due time, so
+   checking for due timers on each pass costs one comparison. They run right after the critical tasks.
+
+   Each task (and the timers, as one entry) keeps runtime accounting - runs, total and longest run time - which is
+   served with the metrics at /metrics.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+
+#define SCHED_TASKS				10							// max tasks, including the timers entry
+#define SCHED_TIMERS				8							// max pending timers
+#define SCHED_PASS_USEC			2000						// idle tasks only run while the pass is shorter than this
+
+typedef enum:uint8_t { TASK_CRITICAL, TASK_NORMAL, TASK_IDLE } TaskPriority;
+
+typedef void (*Task_Function)(void);
+
+typedef struct {
+   const char		*name;
+   Task_Function	function;
+   TaskPriority	priority;
+   uint16_t			interval;									// TASK_IDLE: run at least this often (msec, 0 == no guarantee)
+   uint32_t			lastRun;										// millis() at the last run
+   uint32_t			runs;
+   uint64_t			usec;											// total run time
+   uint32_t			maxUsec;										// longest run
+} Sched_Task;
+
+bool					schedulerAdd(const char *name, Task_Function function, const TaskPriority priority,
+                                 const uint16_t interval = 0);
+bool					schedulerTimeout(const uint32_t msec, Task_Function function);
+bool					schedulerInterval(const uint32_t msec, Task_Function function);
+void					schedulerRun(void);
+uint8_t				schedulerTaskCount(void);
+const Sched_Task	&schedulerTask(const uint8_t index);
+
+#endif
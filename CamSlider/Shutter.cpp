@@ -0,0 +1,193 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller shutter pulse scheduler
+
+   Each pulse edge is scheduled with a one-shot Ticker (SDK software timer): the pin is raised, a timer lowers it
+   holdMsec later and, if more shots remain, another timer raises it again after gapMsec. Ticker callbacks run in
+   the SDK system context, so they only flip the pin and advance the sequence - the completion callback is deferred
+   to shutterService() so that it can safely start moves and schedule timers.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <Ticker.h>
+#include "Shutter.h"
+
+static Ticker						pulseTimer;
+static uint8_t						shutterPin;
+
+static Shutter_Sequence			active;								// sequence in progress
+static volatile uint8_t			shot = 0;							// index of the current (or next) exposure
+static volatile bool				busy = false;
+static volatile bool				complete = false;					// sequence ended, callback not yet called
+static ShutterCallback			onComplete = NULL;
+
+static const char					*modeNames[] = { "single", "burst", "bracket", "bulb" };
+
+/*
+ hold time for exposure index of a sequence
+ bracket exposures run from -stops * (shots / 2) to +stops * (shots / 2) around holdMsec
+*/
+static uint32_t holdTime ( const Shutter_Sequence &sequence, const uint8_t index ) {
+   if ( sequence.mode != SHUTTER_BRACKET ) {
+      return sequence.holdMsec;
+   }
+
+   int ev = ((int)index - (int)(sequence.shots / 2)) * min(sequence.stops, (uint8_t)SHUTTER_MAX_STOPS);
+   uint32_t hold = (ev < 0) ? (sequence.holdMsec >> -ev) : (sequence.holdMsec << ev);
+
+   return (hold < SHUTTER_MIN_MSEC) ? SHUTTER_MIN_MSEC : hold;
+}
+
+static void pulseStart(void);
+
+static void pulseEnd ( void ) {
+   digitalWrite(shutterPin, LOW);
+   if ( ++shot < active.shots ) {
+      pulseTimer.once_ms(active.gapMsec, pulseStart);
+   } else {
+      busy = false;
+      complete = true;
+   }
+}
+
+static void pulseStart ( void ) {
+   digitalWrite(shutterPin, HIGH);
+   pulseTimer.once_ms(holdTime(active, shot), pulseEnd);
+}
+
+void shutterBegin ( const uint8_t pin ) {
+   shutterPin = pin;
+   pinMode(shutterPin, OUTPUT);
+   digitalWrite(shutterPin, LOW);
+}
+
+/*
+ start a sequence; done (may be NULL) is called from shutterService() once the last pulse has ended
+ returns false if a sequence is already running
+*/
+bool shutterStart ( const Shutter_Sequence &sequence, const ShutterCallback done ) {
+   if ( busy ) {
+      return false;
+   }
+   active = sequence;
+   if ( (active.mode == SHUTTER_SINGLE) || (active.mode == SHUTTER_BULB) ) {
+      active.shots = 1;
+   }
+   active.shots = constrain(active.shots, 1, SHUTTER_MAX_SHOTS);
+   active.stops = constrain(active.stops, 0, SHUTTER_MAX_STOPS);
+   if ( active.holdMsec < SHUTTER_MIN_MSEC ) {
+      active.holdMsec = SHUTTER_MIN_MSEC;
+   }
+   onComplete = done;
+   shot = 0;
+   complete = false;
+   busy = true;
+   pulseStart();
+   return true;
+}
+
+/*
+ release the shutter and drop the rest of the sequence without calling the completion callback
+*/
+void shutterAbort ( void ) {
+   pulseTimer.detach();
+   digitalWrite(shutterPin, LOW);
+   busy = false;
+   complete = false;
+}
+
+bool shutterBusy ( void ) {
+   return busy || complete;
+}
+
+/*
+ call from loop(): runs the completion callback of a finished sequence
+*/
+void shutterService ( void ) {
+   if ( complete ) {
+      complete = false;
+      if ( onComplete ) {
+         onComplete();
+      }
+   }
+}
+
+/*
+ total time from the first rising edge to the last falling edge in msec
+*/
+uint32_t shutterDuration ( const Shutter_Sequence &sequence ) {
+   uint8_t	shots = ((sequence.mode == SHUTTER_SINGLE) || (sequence.mode == SHUTTER_BULB)) ? 1 : constrain(sequence.shots, 1, SHUTTER_MAX_SHOTS);
+   uint32_t	total = (shots - 1) * sequence.gapMsec;
+
+   for ( uint8_t i = 0; i < shots; i++ ) {
+      total += holdTime(sequence, i);
+   }
+   return total;
+}
+
+/*
+ change the mode of a sequence; a burst or bracket set without its count, gap or spacing gets the defaults
+*/
+void shutterSetMode ( Shutter_Sequence &sequence, const ShutterMode mode ) {
+   sequence.mode = mode;
+   if ( (mode == SHUTTER_BURST) || (mode == SHUTTER_BRACKET) ) {
+      if ( sequence.shots < 2 ) {
+         sequence.shots = SHUTTER_SHOTS;
+      }
+      if ( sequence.gapMsec < SHUTTER_MIN_MSEC ) {
+         sequence.gapMsec = SHUTTER_GAP_MSEC;
+      }
+   }
+   if ( (mode == SHUTTER_BRACKET) && (sequence.stops == 0) ) {
+      sequence.stops = 1;
+   }
+}
+
+/*
+ true if the camera can take every exposure of the sequence: pulses and gaps it sees, a burst or bracket of
+ 2..SHUTTER_MAX_SHOTS and a bracket whose longest exposure is no more than SHUTTER_MAX_MSEC
+ the fields a mode does not use are not checked
+*/
+bool shutterValid ( const Shutter_Sequence &sequence ) {
+   if ( (sequence.mode > SHUTTER_BULB) || (sequence.holdMsec < SHUTTER_MIN_MSEC) || (sequence.holdMsec > SHUTTER_MAX_MSEC) ) {
+      return false;
+   }
+   if ( (sequence.mode == SHUTTER_SINGLE) || (sequence.mode == SHUTTER_BULB) ) {
+      return true;
+   }
+   if ( (sequence.shots < 2) || (sequence.shots > SHUTTER_MAX_SHOTS) || (sequence.gapMsec < SHUTTER_MIN_MSEC) ||
+      (sequence.gapMsec > SHUTTER_MAX_MSEC) ) {
+      return false;
+   }
+   if ( sequence.mode == SHUTTER_BRACKET ) {
+      if ( (sequence.stops == 0) || (sequence.stops > SHUTTER_MAX_STOPS) ) {
+         return false;
+      }
+      // the longest exposure is the last; compared as a shift so it cannot overflow
+      return sequence.holdMsec <= (SHUTTER_MAX_MSEC >> (sequence.stops * (sequence.shots / 2)));
+   }
+   return true;
+}
+
+const char *shutterModeName ( const ShutterMode mode ) {
+   return (mode <= SHUTTER_BULB) ? modeNames[mode] : "";
+}
+
+/*
+ the mode named by the length characters at name (not terminated)
+ returns false if there is no such mode
+*/
+bool shutterModeFind ( const char *name, const size_t length, ShutterMode &mode ) {
+   for ( uint8_t i = 0; i <= SHUTTER_BULB; i++ ) {
+      if ( (strlen(modeNames[i]) == length) && (strncmp(name, modeNames[i], length) == 0) ) {
+         mode = (ShutterMode)i;
+         return true;
+      }
+   }
+   return false;
+}
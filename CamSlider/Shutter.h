@@ -0,0 +1,61 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller shutter pulse scheduler
+
+   Drives the camera trigger output from timer events instead of holding the CPU in delay(). A sequence of one or
+   more shutter pulses is started with shutterStart() and runs in the background; when the last pulse has ended the
+   completion callback is called from shutterService() in loop() context.
+
+   Sequences:
+      SHUTTER_SINGLE		one pulse of holdMsec
+      SHUTTER_BURST		shots pulses of holdMsec separated by gapMsec
+      SHUTTER_BRACKET	shots pulses centered on holdMsec, each stops EV apart (hold time doubles/halves per stop),
+							for cameras in bulb mode; gapMsec between exposures
+      SHUTTER_BULB		one pulse of holdMsec (long exposure in bulb mode)
+
+   shutterValid() checks a sequence set up by the user before it is used; shutterStart() only clamps what it is given.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SHUTTER_H
+#define SHUTTER_H
+
+#include <Arduino.h>
+
+#define SHUTTER_PULSE_MSEC		100						// how long to hold the shutter button down for a normal exposure
+#define SHUTTER_MIN_MSEC		10							// shortest pulse the camera reliably sees
+#define SHUTTER_MAX_SHOTS		9							// longest burst or bracket set
+#define SHUTTER_MAX_STOPS		3							// widest bracket spacing
+#define SHUTTER_MAX_MSEC		600000UL				// longest pulse or gap (10 minute bulb exposure)
+#define SHUTTER_GAP_MSEC		1000						// gap between exposures when burst or bracket is selected
+#define SHUTTER_SHOTS			3							// exposures when burst or bracket is selected
+
+typedef enum:uint8_t { SHUTTER_SINGLE, SHUTTER_BURST, SHUTTER_BRACKET, SHUTTER_BULB } ShutterMode;
+
+typedef struct {
+   ShutterMode	mode;
+   uint8_t		shots;										// number of exposures (burst & bracket)
+   uint8_t		stops;										// bracket spacing in EV stops
+   uint32_t		holdMsec;									// pulse width (bracket: middle exposure)
+   uint32_t		gapMsec;										// time between the end of one pulse and the start of the next
+} Shutter_Sequence;
+
+typedef void (*ShutterCallback)(void);
+
+void		shutterBegin(const uint8_t pin);
+bool		shutterStart(const Shutter_Sequence &sequence, const ShutterCallback done);
+void		shutterAbort(void);
+bool		shutterBusy(void);
+void		shutterService(void);
+uint32_t	shutterDuration(const Shutter_Sequence &sequence);
+void		shutterSetMode(Shutter_Sequence &sequence, const ShutterMode mode);
+bool		shutterValid(const Shutter_Sequence &sequence);
+const char	*shutterModeName(const ShutterMode mode);
+bool		shutterModeFind(const char *name, const size_t length, ShutterMode &mode);
+
+#endif
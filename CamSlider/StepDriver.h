@@ -0,0 +1,117 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller step/direction pin drivers
+
+   The step engine is compiled against one of these, selected with STEP_GPIO in CamSlider.h. Both have the same
+   static interface and take the pins as template parameters, so each pin write is resolved at compile time:
+      Digital_Step_Driver	digitalWrite() - pin lookup and checks on every write (the reference driver)
+      GPIO_Step_Driver		one store to the GPIO set/clear register (GPIO16, on the RTC block, is a read-modify-write
+								of GP16O)
+
+   A4988 timing: STEP high and low for at least 1 usec each, DIR stable 200 nsec before the STEP rising edge. The
+   engine raises STEP at the top of the interrupt, does its interval work, and only then waits out what is left of
+   STEP_PULSE_USEC in pulseEnd(), so the pulse width mostly overlaps useful work. The low time is the step interval,
+   and DIR is written when a segment starts, a full step interval before its first pulse.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef STEPDRIVER_H
+#define STEPDRIVER_H
+
+#include <Arduino.h>
+
+#define STEP_PULSE_USEC			2						// A4988 STEP high time (min 1 usec)
+#define STEP_PULSE_CYCLES		(STEP_PULSE_USEC * (F_CPU / 1000000L))
+
+/*
+ spin until the STEP high time has passed since the cycle count at the rising edge
+*/
+static inline void ICACHE_RAM_ATTR pulseWait ( const uint32_t since ) {
+   while ( (ESP.getCycleCount() - since) < STEP_PULSE_CYCLES ) {
+   }
+}
+
+// GPIO0-15 through the W1TS/W1TC registers: a single store, no read back
+template <uint8_t PIN> struct GPIO_Pin {
+   static inline void ICACHE_RAM_ATTR write ( const bool high ) {
+      if ( high ) {
+         GPOS = (1UL << PIN);
+      } else {
+         GPOC = (1UL << PIN);
+      }
+   }
+};
+
+// GPIO16 is in the RTC block and only has an output register
+template <> struct GPIO_Pin<16> {
+   static inline void ICACHE_RAM_ATTR write ( const bool high ) {
+      if ( high ) {
+         GP16O |= 1;
+      } else {
+         GP16O &= ~1;
+      }
+   }
+};
+
+template <uint8_t STEP, uint8_t DIR, uint8_t EN> struct GPIO_Step_Driver {
+   static void begin ( void ) {
+      pinMode(STEP, OUTPUT);
+      pinMode(DIR, OUTPUT);
+      pinMode(EN, OUTPUT);
+      GPIO_Pin<STEP>::write(false);
+   }
+
+   // returns the cycle count at the rising edge for pulseEnd()
+   static inline uint32_t ICACHE_RAM_ATTR pulseStart ( void ) {
+      GPIO_Pin<STEP>::write(true);
+      return ESP.getCycleCount();
+   }
+
+   static inline void ICACHE_RAM_ATTR pulseEnd ( const uint32_t since ) {
+      pulseWait(since);
+      GPIO_Pin<STEP>::write(false);
+   }
+
+   static inline void direction ( const bool forward ) {
+      GPIO_Pin<DIR>::write(forward);						// HIGH == FWD
+   }
+
+   // ENABLE is active LOW on the Allegro A4988
+   static inline void enable ( const bool enable ) {
+      GPIO_Pin<EN>::write(!enable);
+   }
+};
+
+template <uint8_t STEP, uint8_t DIR, uint8_t EN> struct Digital_Step_Driver {
+   static void begin ( void ) {
+      pinMode(STEP, OUTPUT);
+      pinMode(DIR, OUTPUT);
+      pinMode(EN, OUTPUT);
+      digitalWrite(STEP, LOW);
+   }
+
+   static inline uint32_t ICACHE_RAM_ATTR pulseStart ( void ) {
+      digitalWrite(STEP, HIGH);
+      return ESP.getCycleCount();
+   }
+
+   static inline void ICACHE_RAM_ATTR pulseEnd ( const uint32_t since ) {
+      pulseWait(since);
+      digitalWrite(STEP, LOW);
+   }
+
+   static inline void direction ( const bool forward ) {
+      digitalWrite(DIR, forward ? HIGH : LOW);
+   }
+
+   static inline void enable ( const bool enable ) {
+      digitalWrite(EN, enable ? LOW : HIGH);
+   }
+};
+
+#endif
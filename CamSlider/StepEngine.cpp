@@ -0,0 +1,274 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller step pulse engine
+
+   Timer1 runs in single-shot mode and is re-armed at the top of each interrupt, so the step period is
+   measured from ISR entry to ISR entry and does not include the time spent producing the pulse.
+   Everything the ISR touches must be in IRAM and all shared state is volatile.
+
+   Ramped moves index the planner's fixed-point table by the number of steps taken (acceleration) or remaining
+   (deceleration); the table is read in place, so the plan must not be rebuilt while the engine is running.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#define DEBUG_LOG
+
+#include <Arduino.h>
+#include "StepEngine.h"
+#include "StepDriver.h"
+#include "Planner.h"
+#include "Mechanics.h"
+#include "CamSlider.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "DebugLib.h"
+
+#define CYCLES_PER_TICK		(F_CPU / STEP_TIMER_HZ)			// CPU cycles per timer1 tick
+#define CYCLES_PER_USEC		(F_CPU / 1000000L)
+
+#ifdef STEP_GPIO
+typedef GPIO_Step_Driver<STEP_PIN, DIR_PIN, ENABLE_PIN>		Step_Driver;
+#else
+typedef Digital_Step_Driver<STEP_PIN, DIR_PIN, ENABLE_PIN>	Step_Driver;
+#endif
+
+// current segment - written by loop() only while the timer is stopped
+static volatile struct {
+   uint32_t	remaining;										// steps left in this segment
+   uint32_t	taken;											// steps issued in this segment
+   uint32_t	interval;										// timer1 ticks until the next step
+   uint32_t	cruise;											// timer1 ticks between steps at cruise speed
+   const uint32_t	*ramp;									// planner ramp table (NULL == constant speed)
+   uint32_t	rampSteps;										// steps in each ramp
+   uint8_t	shift;											// ramp table entry covers 2^shift steps
+   bool		running;											// timer is active
+   bool		done;												// segment completed (cleared when collected)
+} segment = { 0, 0, 0, 0, NULL, 0, 0, false, false };
+
+static volatile uint32_t	lastStepCycle = 0;					// ESP cycle counter at the previous step
+static volatile uint32_t	maxJitter = 0;						// worst deviation from the nominal interval (cycles)
+static volatile uint32_t	maxISRCycles = 0;					// longest time spent in the ISR
+
+/*
+ ticks before step n (counted from 0) of the segment, with m steps still to follow it
+ the slower of the acceleration and deceleration entries wins, which also handles triangular moves
+*/
+static inline uint32_t ICACHE_RAM_ATTR stepInterval ( const uint32_t n, const uint32_t m ) {
+   uint32_t interval = segment.cruise;
+
+   if ( segment.ramp ) {
+      if ( (n < segment.rampSteps) && (segment.ramp[n >> segment.shift] > interval) ) {
+         interval = segment.ramp[n >> segment.shift];
+      }
+      if ( (m < segment.rampSteps) && (segment.ramp[m >> segment.shift] > interval) ) {
+         interval = segment.ramp[m >> segment.shift];
+      }
+   }
+   return interval;
+}
+
+/*
+ timer1 interrupt: issue one step and re-arm for the next one
+*/
+static void ICACHE_RAM_ATTR stepISR ( void ) {
+   uint32_t now = ESP.getCycleCount();
+   uint32_t expected = segment.interval * CYCLES_PER_TICK;	// interval that ended with this step
+   uint32_t rising = Step_Driver::pulseStart();
+
+   // the next interval is worked out while STEP is high
+   if ( segment.remaining > 1 ) {
+      segment.interval = stepInterval(segment.taken + 1, segment.remaining - 2);
+      timer1_write(segment.interval);
+   }
+   Step_Driver::pulseEnd(rising);
+
+   uint32_t actual = now - lastStepCycle;						// the first step is timed from the segment start
+
+   TRACE_STEP(actual / CYCLES_PER_USEC);
+   if ( segment.taken ) {
+      // deviation of the actual step interval from the requested one
+      uint32_t jitter = (actual > expected) ? (actual - expected) : (expected - actual);
+
+      if ( jitter > maxJitter ) {
+         maxJitter = jitter;
+      }
+      METRIC_OBSERVE(H_STEP_GAP, actual / CYCLES_PER_USEC);
+   }
+   lastStepCycle = now;
+   ++segment.taken;
+   METRIC_COUNT(C_STEPS);
+
+   if ( --segment.remaining == 0 ) {
+      timer1_disable();
+      segment.running = false;
+      segment.done = true;
+      TRACE_MARK(TRACE_STOP, segment.taken);
+   }
+
+   uint32_t cost = ESP.getCycleCount() - now;
+   if ( cost > maxISRCycles ) {
+      maxISRCycles = cost;
+   }
+}
+
+void stepEngineBegin ( void ) {
+   Step_Driver::begin();
+   stepEngineEnable(false);
+
+   timer1_isr_init();
+   timer1_attachInterrupt(stepISR);
+}
+
+/*
+ energize the motor - ENABLE is active LOW on the Allegro A4988
+*/
+void stepEngineEnable ( const bool enable ) {
+   Step_Driver::enable(enable);
+}
+
+/*
+ the segment is set up and the timer armed with interrupts disabled: an endstop interrupt calling stepEngineStop()
+ part way through would otherwise be undone by the timer1_enable() that follows it; taken after the arm, it stops
+ the segment before its first step
+*/
+static void startSegment ( const uint32_t steps, const bool forward ) {
+   uint32_t saved;
+
+   Step_Driver::direction(forward);
+   saved = xt_rsil(15);
+   segment.remaining = steps;
+   segment.taken = 0;
+   segment.interval = stepInterval(0, steps ? steps - 1 : 0);
+   segment.done = (steps == 0);
+   segment.running = !segment.done;
+   if ( segment.running ) {
+      TRACE_START(steps);
+      lastStepCycle = ESP.getCycleCount();
+      timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+      timer1_write(segment.interval);
+   }
+   xt_wsr_ps(saved);
+}
+
+/*
+ start a planned (ramped) segment
+ plan must stay unchanged until the segment is done or stopped
+*/
+void stepEngineStart ( const Motion_Plan &plan, const bool forward ) {
+   stepEngineStop();
+   segment.ramp = plan.entries ? plan.table : NULL;
+   segment.rampSteps = plan.rampSteps;
+   segment.shift = plan.shift;
+   segment.cruise = plan.cruise;
+   startSegment(plan.steps, forward);
+}
+
+/*
+ stop immediately; steps taken so far remain available
+ safe to call from an interrupt (the endstop ISR stops the carriage without waiting for loop())
+*/
+void ICACHE_RAM_ATTR stepEngineStop ( void ) {
+   timer1_disable();
+   if ( segment.running ) {
+      TRACE_MARK(TRACE_STOP, segment.taken);
+   }
+   segment.running = false;
+   segment.remaining = 0;
+}
+
+bool stepEngineRunning ( void ) {
+   return segment.running;
+}
+
+/*
+ returns true once when a segment completes all of its steps
+*/
+bool stepEngineDone ( void ) {
+   if ( segment.done ) {
+      segment.done = false;
+      return true;
+   }
+   return false;
+}
+
+uint32_t ICACHE_RAM_ATTR stepEngineSteps ( void ) {
+   return segment.taken;
+}
+
+/*
+ worst step interval deviation in usec since the last reset
+*/
+uint32_t stepEngineJitter ( const bool reset ) {
+   uint32_t result = maxJitter / CYCLES_PER_USEC;
+
+   if ( reset ) {
+      maxJitter = 0;
+   }
+   return result;
+}
+
+/*
+ longest step interrupt service time in CPU cycles since the last reset
+*/
+uint32_t stepEngineISRCycles ( const bool reset ) {
+   uint32_t result = maxISRCycles;
+
+   if ( reset ) {
+      maxISRCycles = 0;
+   }
+   return result;
+}
+
+/*
+ cycles for STEP_BENCH_PULSES back to back pulses, the way the step interrupt issues them with no interval work
+ to overlap the pulse width; the second count is the pin writes alone
+*/
+template <class Driver> static void benchmarkDriver ( uint32_t &pulse, uint32_t &writes ) {
+   uint32_t start;
+
+   noInterrupts();
+   start = ESP.getCycleCount();
+   for ( uint16_t i = 0; i < STEP_BENCH_PULSES; i++ ) {
+      Driver::pulseEnd(Driver::pulseStart());
+   }
+   pulse = (ESP.getCycleCount() - start) / STEP_BENCH_PULSES;
+   start = ESP.getCycleCount();
+   for ( uint16_t i = 0; i < STEP_BENCH_PULSES; i++ ) {
+      Driver::pulseStart();
+      Driver::pulseEnd(start);										// long past: no wait
+   }
+   writes = (ESP.getCycleCount() - start) / STEP_BENCH_PULSES;
+   interrupts();
+}
+
+/*
+ compare the step drivers: cycles per step, the step rate the pulse alone allows (high time plus the 1 usec minimum
+ low time) and the CPU share at the active mechanics profile's full speed
+ the ISR entry, interval and accounting cycles come on top (see stepEngineISRCycles(), reported by the loop profiler)
+ pulses the real STEP pin, so it must run while the A4988 is disabled
+*/
+void stepEngineBenchmark ( void ) {
+   const struct {
+      const char	*name;
+      void			(*run)(uint32_t &, uint32_t &);
+   } drivers[] = {
+      { "digitalWrite", benchmarkDriver<Digital_Step_Driver<STEP_PIN, DIR_PIN, ENABLE_PIN> > },
+      { "GPIO register", benchmarkDriver<GPIO_Step_Driver<STEP_PIN, DIR_PIN, ENABLE_PIN> > },
+   };
+   const uint32_t fullSpeed = (uint32_t)mechMaxSpeed();
+
+   for ( uint8_t i = 0; i < sizeof(drivers) / sizeof(drivers[0]); i++ ) {
+      uint32_t pulse, writes;
+
+      drivers[i].run(pulse, writes);
+      LOG(PSTR("Step driver %s: %u cycles per pulse (%u in pin writes), max %u steps/sec, %u.%02u%% CPU at %u steps/sec\n"),
+         drivers[i].name, (unsigned int)pulse, (unsigned int)writes, (unsigned int)(F_CPU / (pulse + CYCLES_PER_USEC)),
+         (unsigned int)((uint64_t)pulse * fullSpeed * 100 / F_CPU), (unsigned int)((uint64_t)pulse * fullSpeed * 10000 / F_CPU % 100),
+         (unsigned int)fullSpeed);
+   }
+}
@@ -0,0 +1,41 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller step pulse engine
+
+   Step pulses are generated from the ESP8266 hardware timer1 interrupt, so the carriage keeps moving at a
+   steady rate regardless of what loop() is doing (serving HTTP requests, firing the shutter, printing, ...).
+   The motion FSM in loop() only hands a segment (step count, speed, direction) to the engine and later
+   collects the completion event.
+
+   Timer1 is dedicated to the step engine, so nothing else in the sketch may use it (e.g. tone() or the
+   waveform generator behind analogWrite()). The pins are written through the driver selected with STEP_GPIO
+   (see StepDriver.h).
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef STEPENGINE_H
+#define STEPENGINE_H
+
+#include "Planner.h"
+
+#define STEP_TIMER_HZ			5000000L				// timer1 tick rate with TIM_DIV16 (80 MHz / 16)
+#define STEP_MIN_SPEED			1.0					// slowest supported speed in steps/sec (timer1 limit is ~0.6)
+#define STEP_BENCH_PULSES		1000					// pulses timed per driver by stepEngineBenchmark()
+
+void		stepEngineBegin(void);
+void		stepEngineEnable(const bool enable);
+void		stepEngineStart(const Motion_Plan &plan, const bool forward);
+void		stepEngineStop(void);
+bool		stepEngineRunning(void);
+bool		stepEngineDone(void);
+uint32_t	stepEngineSteps(void);
+uint32_t	stepEngineJitter(const bool reset);
+uint32_t	stepEngineISRCycles(const bool reset);
+void		stepEngineBenchmark(void);
+
+#endif
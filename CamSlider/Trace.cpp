@@ -0,0 +1,88 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller step timing trace
+
+   Only the step and endstop interrupts write entries while a capture is active, and they do not nest, so the ring
+   needs no locking. The blob is only sent once the capture has ended.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include "Trace.h"
+
+#ifdef STEP_TRACE
+
+static uint32_t				ring[TRACE_ENTRIES];
+static volatile uint32_t	recorded = 0;						// entries written in this capture (free running)
+static volatile TraceState	state = TRACE_IDLE;
+
+static inline void ICACHE_RAM_ATTR traceAdd ( const TraceType type, const uint32_t value ) {
+   ring[recorded & (TRACE_ENTRIES - 1)] = ((uint32_t)type << TRACE_TYPE_SHIFT) | (value & TRACE_VALUE_MASK);
+   ++recorded;
+}
+
+/*
+ capture the next move - ignored while a capture is running
+*/
+void traceArm ( void ) {
+   if ( state != TRACE_ACTIVE ) {
+      state = TRACE_ARMED;
+   }
+}
+
+TraceState traceState ( void ) {
+   return state;
+}
+
+/*
+ a move is starting (step timer not yet running)
+*/
+void traceStart ( const uint32_t steps ) {
+   if ( state == TRACE_ARMED ) {
+      recorded = 0;
+      traceAdd(TRACE_START, steps);
+      state = TRACE_ACTIVE;
+   }
+}
+
+void ICACHE_RAM_ATTR traceStep ( const uint32_t usec ) {
+   if ( state == TRACE_ACTIVE ) {
+      traceAdd(TRACE_STEP, usec);
+   }
+}
+
+/*
+ endstop or end of move marker; the end of the move also ends the capture
+*/
+void ICACHE_RAM_ATTR traceMark ( const TraceType type, const uint32_t steps ) {
+   if ( state == TRACE_ACTIVE ) {
+      traceAdd(type, steps);
+      if ( type == TRACE_STOP ) {
+         state = TRACE_READY;
+      }
+   }
+}
+
+/*
+ write the last capture as a packed blob: header, then the entries oldest first
+*/
+void traceSend ( Print &out ) {
+   Trace_Header	header;
+   uint32_t			first = (recorded > TRACE_ENTRIES) ? (recorded - TRACE_ENTRIES) : 0;
+
+   header.magic = TRACE_MAGIC;
+   header.version = TRACE_VERSION;
+   header.entrySize = sizeof(ring[0]);
+   header.count = recorded - first;
+   header.recorded = recorded;
+   out.write((const uint8_t *)&header, sizeof(header));
+   for ( uint32_t i = first; i < recorded; i++ ) {
+      out.write((const uint8_t *)&ring[i & (TRACE_ENTRIES - 1)], sizeof(ring[0]));
+   }
+}
+
+#endif
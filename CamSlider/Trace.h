@@ -0,0 +1,68 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller step timing trace
+
+   Records the time between consecutive step pulses, with markers for the start and end of the move and endstop
+   hits, in a fixed ring written from the step and endstop interrupts. A capture is armed over the JSON API
+   (POST /api/trace) and covers the next move; GET /api/trace downloads it as a packed binary blob for
+   tools/trace_analyze.py.
+
+   Blob layout (little-endian): Trace_Header followed by header.count entries, oldest first. Each entry is a
+   uint32_t with the type in the top two bits:
+      TRACE_STEP			usec since the previous step (the first step of a move is relative to the start marker)
+      TRACE_START			steps planned for the move
+      TRACE_STOP			steps taken when the move ended (completed or stopped)
+      TRACE_ENDSTOP		steps taken when the endstop interrupt ran
+
+   Enable by defining STEP_TRACE in CamSlider.h. When it is not defined, the macros below compile to nothing and
+   /api/trace is not served.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include "CamSlider.h"
+
+#define TRACE_ENTRIES			1024						// ring size (power of 2)
+#define TRACE_MAGIC				0x52545343				// "CSTR"
+#define TRACE_VERSION			1
+#define TRACE_TYPE_SHIFT		30
+#define TRACE_VALUE_MASK		((1UL << TRACE_TYPE_SHIFT) - 1)
+
+typedef enum:uint8_t { TRACE_STEP, TRACE_START, TRACE_STOP, TRACE_ENDSTOP } TraceType;
+typedef enum:uint8_t { TRACE_IDLE, TRACE_ARMED, TRACE_ACTIVE, TRACE_READY } TraceState;
+
+// start of the downloaded blob
+typedef struct {
+   uint32_t	magic;
+   uint16_t	version;
+   uint16_t	entrySize;										// bytes per entry
+   uint32_t	count;											// entries that follow
+   uint32_t	recorded;										// entries recorded - more than count if the ring wrapped
+} Trace_Header;
+
+#ifdef STEP_TRACE
+void			traceArm(void);
+TraceState	traceState(void);
+void			traceStart(const uint32_t steps);
+void			traceStep(const uint32_t usec);
+void			traceMark(const TraceType type, const uint32_t steps);
+void			traceSend(Print &out);
+
+   #define TRACE_START(steps)				traceStart(steps)
+   #define TRACE_STEP(usec)				traceStep(usec)
+   #define TRACE_MARK(type, steps)		traceMark((type), (steps))
+#else
+   #define TRACE_START(steps)
+   #define TRACE_STEP(usec)
+   #define TRACE_MARK(type, steps)
+#endif
+
+#endif
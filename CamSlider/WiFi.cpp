@@ -3,8 +3,8 @@
 
    camera slider WiFi control interface
    
-   Prior to running this sketch, the HTML file must be loaded into the ESP8266 SPIFFS file system.
-   Currently, the instructions for installing and running the uplaod tool can be found here: http://esp8266.github.io/Arduino/versions/2.3.0/doc/filesystem.html
+   The HTML pages and the stylesheet are compiled into the sketch: after editing any file in the data directory, regenerate HTMLTemplates.h
+   by running tools/html2progmem.py
 
    Copyright 2016/2017 Rob Redford
    This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
@@ -29,123 +29,36 @@ extern "C" {
 #include <ESP8266WiFi.h>
 #include <WiFiClient.h> 
 #include <ESP8266WebServer.h>
-#include <FS.h>
 #include <LEDManager.h>                           //  download from https://github.com/Rom3oDelta7/LEDManager
 #include <WiFiManager.h>                          // [Local Modifications] tapzu Wifi Manager RD7 fork: https://github.com/Rom3oDelta7/WiFiManager
 #include <ArduinoOTA.h>
 #include <EEPROM.h>
 #include "CamSlider.h"
 #include "DebugLib.h"
+#include "HTMLTemplates.h"
+#include "HTTPWriter.h"
+#include "HTTPRequest.h"
+#include "Events.h"
+#include "Dispatch.h"
+#include "Planner.h"
+#include "Motion.h"
+#include "BinLog.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include "Journal.h"
+#include "Mechanics.h"
 
 // main sketch externs
-extern volatile bool				newMove;					// true when we need to initiate a new move
-extern volatile bool				clockwise;
-extern volatile EndstopMode	endstopAction;			// action to take when an endstop is hit
-extern volatile CarriageMode	carriageState;			// current state of the carriage (for the motion state machine)
-extern long							targetPosition;		// inches to travel
-extern float						targetSpeed;			// speed in steps/second
-extern unsigned long				travelStart;			// start of curent carriage movement
-extern unsigned long				lastRunDuration;		// duration of last movement
-extern int							stepsTaken;				// counts steps actually executed
-extern bool							running;					// true only while the carriage is in motion
 extern RGBLED                 led;                 // status status LED 
 
 
-// inline variable substitution
-#define STATE_VAR					"%MODE%"					// mode (video, timelapse, disabled)
-#define ENDSTOP_VAR				"%ENDSTOP%"				// endstop state (toggle)
-#define DISTANCE_VAR				"%DISTANCE%"			// req distance to travel
-#define DURATION_VAR				"%DURATION%"			// req travel time
-#define TL_DISTANCE_VAR			"%TL_DISTANCE%"		// timelapse move distance (per move)
-#define TL_DURATION_VAR			"%TL_DURATION%"		// interval between timelapse moves
-#define TL_IMAGES_VAR			"%TL_IMAGES%"			// number of moves in a timelapse sequence
-#define SPEED_VAR					"%SPEED%"				// speed translated form user inputs
-#define DIRECTION_VAR			"%DIRECTION%"			// direction of travel (fwd/rev)
-#define START_VAR					"%START%"				// running/standby
-#define TRAVELED_VAR				"%TRAVELED%"			// distance traveled in last move
-#define ELAPSED_VAR				"%ELAPSED%"				// elapsed time of last move
-#define MEASURED_VAR				"%MEAS_SPEED%"			// actual speed (vs target)
-#define TL_MEAS_DIST_VAR		"%TL_MEAS_DIST%"		// distance so far in this timelapse sequence
-#define TL_MOVECOUNT_VAR		"%TL_MOVECOUNT%"		// count of current timelapse moves
-#define TL_REMAINING_VAR		"%TL_REMAINING%"		// timelapse moves to go
-#define TL_MOVEDIST				"%TL_MOVEDIST%"		// incremental move distance in inches
-#define TL_INTERVAL				"%TL_INTERVAL%"		// incremental move interval (including move)
-#define TL_COUNT					"%TL_COUNT%"				// current image count
-
-// string objects for (static) filesystem contents
-#define VIDEO_BODY_FILE			"/video_body.html"		// html code <body> for video mode
-#define TIMELAPSE_BODY_FILE	"/timelapse_body.html"	// html code <body> for timelapse mode
-#define DISABLED_BODY_FILE		"/disabled_body.html"	// very short body with just the state mode button
-#define CSS_FILE					"/css.html"					// static CSS HTML contents to reduce burden on String objects
-#define STRING_MAX				3000							// max String obj length for holding HTML file content
-#define STRING_MAX_SHORT		512							// for smaller files
-
-String	videoBodyFile;											// String copy of video body file segment
-String	timelapseBodyFile;									// String copy of timelapse body file segment
-String	disabledBodyFile;										// String copy of disabled mode body file segment
-String	cssFile;													// String copy of CSS file segment
-
-/*
- user actions in HTML request stream
- also includes URI requests that invoke no action but will send the HTML file anyways (always need to reply to client)
- this table is searched to-to-bottom, first match, so ensure that tokens are not substrings of each other or the first one will always be found
-*/
-#define ACTION_MODE				"MODE_BTN="					// mode button
-#define ACTION_ENDSTOP			"ENDSTOP_BTN="				// endstop state change button
-#define ACTION_DISTANCE			"DISTANCE="					// input distance to travel
-#define ACTION_DURATION			"DURATION="					// input travel duration
-#define ACTION_TL_DISTANCE		"TL_DIST="					// input total timelapse travel distance 
-#define ACTION_TL_DURATION		"TL_DURN="					// input total timelapse duration in sec
-#define ACTION_TL_IMAGES		"TL_IMAGES="				// input total number of images to take
-#define ACTION_DIRECTION		"DIRECTION_BTN="			// toggle carriage direction
-#define ACTION_START				"START_BTN="				// initiate/stop movement
-#define ACTION_REFRESH			"REFRESH_BTN="				// refresh display
-#define ACTION_FORGET         "FORGET_BTN="           // clear saved user credentials
-#define ACTION_HOME				"HOME_BTN="					// home the carriage
-#define ACTION_CALIBRATE      "CALI_BTN="             // calibrate slider length
-
-typedef enum:uint8_t { 
-   NULL_ACTION, IGNORE, SLIDER_STATE, ENDSTOP_STATE, SET_DISTANCE, SET_DURATION, SET_TL_DISTANCE,
-   SET_TL_DURATION, SET_TL_IMAGES, SET_DIRECTION, START_STATE, HOME_CARRIAGE, CALIBRATE, FORGET, 
-} T_Action;
-
-#define ACTION_TABLE_SIZE		16
-const struct {	
-   char 		action[20];
-   T_Action	type;
-} actionTable[ACTION_TABLE_SIZE] = {
-   {ACTION_MODE, 			SLIDER_STATE},
-   {ACTION_ENDSTOP, 		ENDSTOP_STATE},
-   {ACTION_DISTANCE,		SET_DISTANCE},
-   {ACTION_DURATION,		SET_DURATION},
-   {ACTION_TL_DISTANCE,	SET_TL_DISTANCE},
-   {ACTION_TL_DURATION,	SET_TL_DURATION},
-   {ACTION_TL_IMAGES,	SET_TL_IMAGES},
-   {ACTION_DIRECTION,	SET_DIRECTION},
-   {ACTION_START,			START_STATE},
-   {ACTION_HOME,			HOME_CARRIAGE},
-   {ACTION_CALIBRATE,	CALIBRATE},
-   {ACTION_FORGET,      FORGET},
-   {ACTION_REFRESH,		NULL_ACTION},			// null actions must be at the end so they don't intercept ones above
-   {"GET / ",				NULL_ACTION},					
-   {"GET /index.html",	NULL_ACTION},
-   {"GET /favicon.ico",	IGNORE}					// always comes after another request, so skip it
-};
-
-/*
- CSS color substitution variables and color defines
-*/
-#define MODE_CSS					"%MODE_CSS%"
-#define ENDSTOP_CSS				"%ENDSTOP_CSS%"
-#define DISTANCE_CSS				"%DISTANCE_CSS%"
-#define DURATION_CSS				"%DURATION_CSS%"
-#define TL_DISTANCE_CSS			"%TL_DISTANCE_CSS%"
-#define TL_DURATION_CSS			"%TL_DURATION_CSS%"
-#define TL_IMAGES_CSS			"%TL_IMAGES_CSS%"
-#define DIRECTION_CSS			"%DIRECTION_CSS%"
-#define START_CSS					"%START_CSS%"
-
-// button background colors
+#define TOKEN_VALUE_MAX			16								// buffer size for formatting numeric token values
+#define FAST_CONNECT_MSEC		5000							// give up on the cached access point after this long
+#define ASSET_CACHE_CONTROL	"no-cache"					// keep assets, but revalidate (304) so a firmware update is seen
+#define ASSET_HEADERS_MAX		96								// ETag, Cache-Control and Content-Encoding header lines
+#define HTTP_CONNECTIONS		3								// concurrent client connections
+
+// button background colors (CSS classes)
 #define CSS_GREEN					"greenbkgd"
 #define CSS_RED					"redbkgd"
 #define CSS_ORANGE				"orangebkgd"
@@ -156,11 +69,20 @@ const struct {
 #define CSS_MAGENTA				"magentabkgd"
 
 WiFiServer	server(80);						// web server instance	
-WiFiClient	client; 							// client stream
+struct {
+   WiFiClient		client;
+   HTTP_Request	request;
+} connections[HTTP_CONNECTIONS];			// client connections, kept open between requests
+WiFiClient	*client = &connections[0].client;		// connection being served
+HTTP_Request *request = &connections[0].request;	// request being received on it
+uint8_t		nextConnection = 0;			// round-robin service start
+HTTPWriter	response;						// streams responses to the client through a fixed size buffer
 #define     AP_CHANNEL         11      // WiFi channel to use for STA+AP mode
 
 MoveMode sliderMode = MOVE_NOT_SET;	   // current mode
 
+const char *carriageStateNames[] = { "stop", "travel", "reverse", "parked" };		// for the JSON interface & events
+
 // data for video move mode
 struct {
    int	travelDuration;					// holds travel duration in sec until we convert it to speed
@@ -168,20 +90,22 @@ struct {
 } video = {0, 0};
 
 // data for timelapse mode
-TL_Data timelapse = {false, 0, 0, 0, 0, 0, 0, 0, S_SHUTTER};
-
-// saved state for homing moves
-Home_State homeState = { false, STOP_HERE, 0, 0.0 };				// these initial values are not used
-
-bool calibrating = false;                // true when calibrating slider distance
-
+TL_Data timelapse = {false, 0, 0, 0, 0, 0, 0, 0, S_SHUTTER, {SHUTTER_SINGLE, 1, 0, SHUTTER_PULSE_MSEC, 0}};
+
+// label colors for the input fields on the page being rendered (errors in red, adjusted values in yellow)
+typedef struct {
+   const char	*distance;
+   const char	*duration;
+   const char	*totalDistance;
+   const char	*totalDuration;
+   const char	*totalImages;
+   const char	*shutter;											// all of the shutter sequence fields
+} Label_Colors;
 
 bool userConnected = false;              // true once user is connected
 
 extern void fatalError(const LEDColor color);
-extern void timelapseMove(void);
 
-extern uint32_t maxDistance;             // maximum slider travel distance in inches
 
 /*
 Create and return a unique WiFi SSID using the ESP8266 WiFi MAC address
@@ -292,79 +216,147 @@ void STAMode (void) {
    }
 }
 
-void setupWiFi (void) {
-   WiFiManager wifiManager;                                     // IP address establishment
-   IPAddress   my_IPAddress = createUniqueIP();                 // unique IP address for AP mode to prevent conflicts with multiple devices
-   String      my_password = createUniquePassword();
-
-   // first check that there are WiFi networks to possibly connect to
-   int netCount = WiFi.scanNetworks();
-   bool connectToAP = false;
-
-   if (netCount > 0) {
-      // try to connect (saved credentials or manual entry if not) and default to AP mode if this fails
-#ifdef DEBUG
-      wifiManager.setDebugOutput(true);
-#else
-      wifiManager.setDebugOutput(false);
-#endif
+/*
+we are connected as a client and the ESP is in STA mode Ref: https://github.com/esp8266/Arduino/issues/2352
+*/
+void stationConnected ( const IPAddress &my_IPAddress ) {
+   INFO(F("Connected (STA+IP; local WiFi)"), WiFi.localIP().toString());
+   led.setColor(LEDColor::BLUE);                   // indicates STA mode
+   led.setState(LEDState::ON);
 
-      INFO(F("Network scan count"), netCount);
 
-      wifiManager.setBreakAfterConfig(true);	                       // undocumented function to return if config unsuccessful
-      wifiManager.setSaveCredentialsInEEPROM(true, CRED_ADDR);      // [Local mod] forces credentials to be saved in EEPROM also
-      wifiManager.setExitButtonLabel("Standalone Mode");            // [Local mod] sets the label on the exit button to clarify the meaning of exiting from the portal
+   /*
 
-                                                                    //wifiManager.setAPStaticIPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));    // use native WiFi class call below instead
-      WiFi.softAPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));	                   // workaround for callout issue - see above
-      WiFi.setAutoConnect(true);
+   We also need to know the address of the client as it will be running our HTTP server
+   The trick is to switch to mixed mode and broadcast the local IP address in the AP SSID name.
+   The user can thus find the local address by looking at the scanned SSIDs on their device
 
-      led.setColor(LEDColor::RED, LEDColor::GREEN);                 // indicate setup mode
-      led.setState(LEDState::ALTERNATE, 250);
-      if (wifiManager.autoConnect(createUniqueSSID().c_str(), my_password.c_str())) {
-         // we are connected as a client and the ESP is in STA mode Ref: https://github.com/esp8266/Arduino/issues/2352
-         INFO(F("Connected (STA+IP; local WiFi)"), WiFi.localIP().toString());
-         led.setColor(LEDColor::BLUE);                   // indicates STA mode
-         led.setState(LEDState::ON);
+   Keep this on until the status is disabled using the HTML "Forget ID" button *** TODO *** needs a better name
 
+   */
 
-         /*
+   WiFi.mode(WIFI_AP_STA);
 
-         We also need to know the address of the client as it will be running our HTTP server
-         The trick is to switch to mixed mode and broadcast the local IP address in the AP SSID name.
-         The user can thus find the local address by looking at the scanned SSIDs on their device
+   String ssid = String("WCS: ") + WiFi.localIP().toString();
+   INFO(F("Local IP as SSID"), ssid);
+   WiFi.softAP(ssid.c_str(), "1nfc^Dh3kAz");                // password only to prevent people from connecting by mistake; channel will be the same as STA mode
+   WiFi.softAPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));
 
-         Keep this on until the status is disabled using the HTML "Forget ID" button *** TODO *** needs a better name
+   //WiFi.reconnect();                                        // supposedly required, but does not work if this is called
 
-         */
+#if DEBUG >= 4
+   Serial.println("AP_STA Diag:");
+   WiFi.printDiag(Serial);
+#endif
 
-         WiFi.mode(WIFI_AP_STA);
+#if DEBUG >= 2
+   WiFi.printDiag(Serial);
+#endif
 
-         String ssid = String("WCS: ") + WiFi.localIP().toString();
-         INFO(F("Local IP as SSID"), ssid);
-         WiFi.softAP(ssid.c_str(), "1nfc^Dh3kAz");                // password only to prevent people from connecting by mistake; channel will be the same as STA mode
-         WiFi.softAPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));
+#ifdef FAST_BOOT
+   // remember where we connected for the next boot
+   Journal_Network	network;
+
+   memset(&network, 0, sizeof(network));
+   memcpy(network.bssid, WiFi.BSSID(), sizeof(network.bssid));
+   network.channel = WiFi.channel();
+   network.ip = WiFi.localIP();
+   network.gateway = WiFi.gatewayIP();
+   network.mask = WiFi.subnetMask();
+   network.dns = WiFi.dnsIP();
+   journalNetwork(network);
+#endif
+}
 
-         //WiFi.reconnect();                                        // supposedly required, but does not work if this is called
+#ifdef FAST_BOOT
+/*
+connect with the credentials saved by the SDK directly to the access point and channel cached by the last
+successful connection, skipping the network scan and the WiFiManager portal
+returns false (credentials kept) if there is nothing cached or the connection does not come up in FAST_CONNECT_MSEC
+*/
+bool fastConnect ( void ) {
+   const Journal_Network	&network = journalState().network;
+   String						ssid = WiFi.SSID();
+   String						psk = WiFi.psk();
+   unsigned long				start = millis();
+
+   if ( (network.channel == 0) || (ssid.length() == 0) ) {
+      return false;
+   }
+   INFO(F("Fast connect"), ssid);
+   WiFi.persistent(false);                                      // the saved config is already correct - do not rewrite flash
+   WiFi.mode(WIFI_STA);
+#ifdef FAST_BOOT_STATIC_IP
+   WiFi.config(IPAddress(network.ip), IPAddress(network.gateway), IPAddress(network.mask), IPAddress(network.dns));
+#endif
+   WiFi.begin(ssid.c_str(), psk.c_str(), network.channel, network.bssid);
+   while ( (WiFi.status() != WL_CONNECTED) && ((millis() - start) < FAST_CONNECT_MSEC) ) {
+      delay(10);
+   }
+   if ( WiFi.status() != WL_CONNECTED ) {
+      INFO(F("Fast connect failed"), millis() - start);
+      WiFi.disconnect();                                        // not persistent, so the saved credentials are kept
+#ifdef FAST_BOOT_STATIC_IP
+      WiFi.config(IPAddress(0UL), IPAddress(0UL), IPAddress(0UL));  // back to DHCP
+#endif
+   }
+   WiFi.persistent(true);
+   return WiFi.status() == WL_CONNECTED;
+}
+#endif
 
-#if DEBUG >= 4
-         Serial.println("AP_STA Diag:");
-         WiFi.printDiag(Serial);
+void setupWiFi (void) {
+   WiFiManager wifiManager;                                     // IP address establishment
+   IPAddress   my_IPAddress = createUniqueIP();                 // unique IP address for AP mode to prevent conflicts with multiple devices
+   String      my_password = createUniquePassword();
+   bool        connectToAP = false;
+   bool        fastBoot = false;                                // connected to the cached access point
+
+#ifdef FAST_BOOT
+   if ( fastConnect() ) {
+      stationConnected(my_IPAddress);
+      BLOG(BL_BOOT_WIFI, millis(), 1);
+      fastBoot = true;
+   }
 #endif
+   if (!fastBoot) {
+      // first check that there are WiFi networks to possibly connect to
+      int netCount = WiFi.scanNetworks();
 
-#if DEBUG >= 2
-         WiFi.printDiag(Serial);
+      if (netCount > 0) {
+         // try to connect (saved credentials or manual entry if not) and default to AP mode if this fails
+#ifdef DEBUG
+         wifiManager.setDebugOutput(true);
+#else
+         wifiManager.setDebugOutput(false);
 #endif
+
+         INFO(F("Network scan count"), netCount);
+
+         wifiManager.setBreakAfterConfig(true);	                       // undocumented function to return if config unsuccessful
+         wifiManager.setSaveCredentialsInEEPROM(true, CRED_ADDR);      // [Local mod] forces credentials to be saved in EEPROM also
+         wifiManager.setExitButtonLabel("Standalone Mode");            // [Local mod] sets the label on the exit button to clarify the meaning of exiting from the portal
+
+                                                                       //wifiManager.setAPStaticIPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));    // use native WiFi class call below instead
+         WiFi.softAPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));	                   // workaround for callout issue - see above
+         WiFi.setAutoConnect(true);
+
+         led.setColor(LEDColor::RED, LEDColor::GREEN);                 // indicate setup mode
+         led.setState(LEDState::ALTERNATE, 250);
+         if (wifiManager.autoConnect(createUniqueSSID().c_str(), my_password.c_str())) {
+            stationConnected(my_IPAddress);
+            BLOG(BL_BOOT_WIFI, millis(), 0);
+         } else {
+            /*
+            we get here if the credentials on the setup page are incorrect, blank, or the "Exit" button was used
+            */
+            INFO(F("Did not connect to local WiFi"), ".");
+            connectToAP = true;
+         }
       } else {
-         /*
-         we get here if the credentials on the setup page are incorrect, blank, or the "Exit" button was used
-         */
-         INFO(F("Did not connect to local WiFi"), ".");
+         INFO(F("No WiFI networks"), ".");
          connectToAP = true;
       }
-   } else {
-      INFO(F("No WiFI networks"), ".");
-      connectToAP = true;
    }
 
    if (connectToAP) {
@@ -376,6 +368,7 @@ void setupWiFi (void) {
       //WiFi.softAP(createUniqueSSID().c_str(), my_password.c_str(), AP_CHANNEL);
       //WiFi.softAPConfig(my_IPAddress, my_IPAddress, IPAddress(255, 0, 0, 0));
       WiFi.mode(WIFI_AP);
+      BLOG(BL_BOOT_AP, millis());
 
 #if DEBUG >= 3
       Serial.println(F("AP Diag:"));
@@ -383,112 +376,21 @@ void setupWiFi (void) {
 #endif
    }
 
-   // start the server & init the SPIFFS file system
+#if DEBUG >= 4
+   dispatchBenchmark();
+#endif
+   // start the server
    server.begin();
-   if (!SPIFFS.begin()) {
-      ERROR(F("Cannot open SPIFFS file system."), ".");
-      fatalError(LEDColor::RED);
-   }
-
-#if DEBUG >= 2
-   Dir dir = SPIFFS.openDir("/");
-   Serial.println("SPIFFS directory contents:");
-   while (dir.next()) {
-      Serial.print(dir.fileName());
-      File f = dir.openFile("r");
-      Serial.print(": Size: ");
-      Serial.println(f.size());
-   }
-#endif	
-
-   // open the BODY HTML files on the on-board FS and read it into a String (note that this string is never modified)
-   File serverFile = SPIFFS.open(VIDEO_BODY_FILE, "r");
-   videoBodyFile.reserve(STRING_MAX);
-   if (serverFile) {
-      if (serverFile.available()) {
-         videoBodyFile = serverFile.readString();
-      }
-      serverFile.close();;
-   } else {
-      ERROR(F("error opening"), F("Video BODY file"));
-      fatalError(LEDColor::MAGENTA);
-   }
-
-   serverFile = SPIFFS.open(TIMELAPSE_BODY_FILE, "r");
-   timelapseBodyFile.reserve(STRING_MAX);
-   if (serverFile) {
-      if (serverFile.available()) {
-         timelapseBodyFile = serverFile.readString();
-      }
-      serverFile.close();;
-   } else {
-      ERROR(F("error opening"), F("Timelapse BODY file"));
-      fatalError(LEDColor::PURPLE);
-   }
-
-   serverFile = SPIFFS.open(DISABLED_BODY_FILE, "r");
-   disabledBodyFile.reserve(STRING_MAX_SHORT);
-   if (serverFile) {
-      if (serverFile.available()) {
-         disabledBodyFile = serverFile.readString();
-      }
-      serverFile.close();;
-   } else {
-      ERROR(F("error opening"), F("Disabled BODY file"));
-      fatalError(LEDColor::CYAN);
-   }
-
-   // open the CSS file on the on-board FS and read it into a String (note that this string is never modified)
-   serverFile = SPIFFS.open(CSS_FILE, "r");
-   cssFile.reserve(STRING_MAX);
-   if (serverFile) {
-      if (serverFile.available()) {
-         cssFile = serverFile.readString();
-      }
-      serverFile.close();;
-   } else {
-      ERROR(F("error opening"), F("CSS file"));
-      fatalError(LEDColor::ORANGE);
-   }
-}
-
-/*
-send body string as formatted HTML to client
-Because of issues in the String class, we need to output complete HTML file in segments (header, CSS, working HTML code)
-*/
-void sendHTML (const int code, const char *content_type, const String &body) {
-   String title;
-
-   // get correct IP to add to page title
-   if (WiFi.getMode() == WIFI_AP) {
-      title = String("WiFi CamSlider ") + WiFi.softAPIP().toString();
-   } else {
-      title = String("WiFi CamSlider ") +  WiFi.localIP().toString();
-   }
-   INFO(F("Sending web page"), title);
-
-   // header
-   client.println(String("HTTP/1.1 ") + String(code) + String(" OK"));
-   client.println(String("Content-Type: ") + String(content_type));
-   client.println("Connection: close\n");
-   client.println(String("<!DOCTYPE HTML> <HTML> <HEAD> <TITLE>") + title + String("</TITLE> </HEAD>"));
-
-   // send CSS file contents
-   client.println(cssFile);
-
-   // send body
-   client.println(body);
-   client.println("</HTML>");
+   BLOG(BL_BOOT_SERVER, millis());
 }
 
-
 /*
 clear saved WiFi credentials
 */
 void clearCredentials(void) {
    if (EEPROM.read(CRED_ADDR) == EEPROM_KEY) {
       // EEPROM backup saved credentials
-      for (int i = 1; i <= sizeof(struct station_config); i++) {
+      for (size_t i = 1; i <= sizeof(struct station_config); i++) {
          EEPROM.write(CRED_ADDR + i, 0);
       }
       EEPROM.commit();
@@ -506,487 +408,1372 @@ void clearCredentials(void) {
    ETS_UART_INTR_DISABLE();
    wifi_station_set_config(&conf);
    ETS_UART_INTR_ENABLE();
+
+#ifdef FAST_BOOT
+   // and the cached access point
+   Journal_Network	network;
+
+   memset(&network, 0, sizeof(network));
+   journalNetwork(network);
+#endif
 }
 
 /*
- depending on what the requested action is, make the appropriate changes to the HTML code stream (video or timelapse mode)
- (e.g. variable substation) and state changes to the main sketch code and send the modified HTML
- stream to the client. This is done simply by copying the string with the base HTML code and making modifications 
- to the copy only.
- 
- Color coding:
-  * buttons change color when changing state (e.g. run -> standby)
-  * text labels will indicated errors in red, "cautions" in yellow (e.g. if parameters were reset to meet min/max limits)
+ return the current value of a template token
+ numeric values are formatted into buf (TOKEN_VALUE_MAX bytes), everything else is a constant string
 */
-void sendResponse ( const T_Action actionType, const String &url ) {
-   String 	indexModified;								// all changes made to this String
-   bool		timelapseParamsChanged = false;		// determines if user movement parameters changed
+const char *tokenValue ( const T_Token token, const Label_Colors &colors, char *buf ) {
+   const Motion_Status	&motion = motionStatus();
+   bool						active = (sliderMode == MOVE_TIMELAPSE) ? timelapse.enabled : motion.running;
+   float						t_duration = 0;
+
+   switch ( token ) {
+   // common
+   case TOK_MODE:
+      switch ( sliderMode ) {
+      case MOVE_VIDEO:
+         return "Video";
 
-   INFO(F("ACTION"), actionType);
+      case MOVE_TIMELAPSE:
+         return "Timelapse";
 
-   /*
-     Because the CSS colors below must ALWAYS be substituted, we set the normal defaults first
-     then change as necessary below
-   */
-#if DEBUG > 0
-   INFO(F("MODE"), sliderMode);
-#endif
-   // determine what HTML interface file we need based on current mode
-   switch ( sliderMode ) {
-   case MOVE_VIDEO:
-      indexModified = videoBodyFile;
-      indexModified.reserve(STRING_MAX);
-      break;
+      default:
+         return "Disabled";
+      }
 
-   case MOVE_TIMELAPSE:
-      indexModified = timelapseBodyFile;
-      indexModified.reserve(STRING_MAX);
-      break;
+   case TOK_MODE_CSS:
+      switch ( sliderMode ) {
+      case MOVE_VIDEO:
+         return CSS_CYAN;
 
-   case MOVE_DISABLED:
-   default:
-      indexModified = disabledBodyFile;
-      indexModified.reserve(STRING_MAX_SHORT);
-      break;
-   }
-   
-#if DEBUG >= 4
-   Serial.println("\nIndex file before modification:");
-   Serial.print(indexModified);
-#endif
-   
-   // default colors
-   String distanceTextColor = String("white");
-   String durationTextColor = String("white");
-   
-   String totalDistanceTextColor = String("white");
-   String totalDurationTextColor = String("white");
-   String totalImagesTextColor = String("white");
-   
-   //process user action
-   if ( actionType != IGNORE ) {
-      uint8_t  idx;
+      case MOVE_TIMELAPSE:
+         return CSS_MAGENTA;
 
-      switch ( actionType ) {
-      /*
-       COMMON ACTIONS (implementation may be state-specific)
-      */
-      case SLIDER_STATE:
-          //toggles state to the next state in sequence
-         switch ( sliderMode ) {
-         case MOVE_DISABLED:
-            sliderMode = MOVE_VIDEO;
-            video.travelDistance = 0;
-            video.travelDuration = 0;
-            indexModified = videoBodyFile;
-            break;
-            
-         case MOVE_VIDEO:
-            sliderMode = MOVE_TIMELAPSE;
-            timelapse.totalDistance = 0;
-            timelapse.totalDuration = 0;
-            timelapse.totalImages = 0;
-            indexModified = timelapseBodyFile;
-            break;
-            
-         case MOVE_TIMELAPSE:
-            sliderMode = MOVE_DISABLED;
-            indexModified = disabledBodyFile;
-            break;
-            
-         default:
-            break;
-         }
-         break;
-         
-      case ENDSTOP_STATE:
-         // toggle endstop state to next one in sequence
-         switch ( endstopAction ) {
-         case STOP_HERE:
-            endstopAction = REVERSE;
-            break;
-            
-         case REVERSE:
-            endstopAction = ONE_CYCLE;
-            break;
-            
-         case ONE_CYCLE:
-            endstopAction = STOP_HERE;
-            break;
-         
-         default:
-            break;
-         }
-         break;
-         
-      case SET_DIRECTION:
-         // toggle carriage direction
-         clockwise = !clockwise;
-         break;
-         
-      case START_STATE:
-         /*
-           stop or initiatiate movement
-           indicate errors to user if req data is missing
-         */
-         if ( sliderMode == MOVE_VIDEO ) {
-            if ( running ) {
-               carriageState = CARRIAGE_STOP;								// state machine will clear running flag
-            } else {
-               bool conditionsSatisfied = true;
-               
-               if ( video.travelDistance <= 0 ) {
-                     durationTextColor = String("red");
-                     conditionsSatisfied = false;
-               }
-               if ( video.travelDuration <= 0 ) {
-                     durationTextColor = String("red");
-                     conditionsSatisfied = false;
-               }
-               
-               if ( conditionsSatisfied ) {
-                  // travel position & speed set already at input time, so just set the flag for the FSM to start the move
-                  newMove = true;
-#if DEBUG >= 2
-                  Serial.println(String("Move to position: ") + String(targetPosition) + String(" at speed ") + String(targetSpeed));
-#endif
-               } else {
-                  targetSpeed = 0;
-               }
-            }
-         } else if ( sliderMode == MOVE_TIMELAPSE ) {
-            if ( timelapse.enabled ) {
-               timelapse.enabled = false;
-               carriageState = CARRIAGE_STOP;
-            } else {
-               bool conditionsSatisfied = true;
-               
-               if ( timelapse.totalDistance <= 0 ) {
-                  totalDistanceTextColor = String("red");
-                  conditionsSatisfied = false;
-               }
-               if ( timelapse.totalDuration <= 0 ) {
-                  totalDurationTextColor = String("red");
-                  conditionsSatisfied = false;
-               }
-               if ( timelapse.totalImages <= 0 ) {
-                  totalImagesTextColor = String("red");
-                  conditionsSatisfied = false;
-               }
-
-               if ( conditionsSatisfied ) {
-                  // sequence move plan params calculated when last user input was received
-#if DEBUG >= 2
-                  Serial.println(String("Timelapse seq: ") + String(timelapse.totalImages) + String (" images moving ") + String(timelapse.moveDistance) + 
-                    String (" in @ interval ") + String(timelapse.moveInterval));
-#endif
-                  timelapse.imageCount = 0;
-                  timelapse.state = S_SHUTTER;
-                  timelapse.enabled = true;
-                  timelapseMove();
-               }
-            }
-         }
-         break;
+      default:
+         return CSS_RED;
+      }
 
-      case CALIBRATE:
-         calibrating = true;
-         // fallthru
-      case HOME_CARRIAGE:
-         // save current stepper params to restore after move is complete
-         homeState.homing = true;
-         homeState.lastTargetPosition = targetPosition;
-         homeState.lastTargetSpeed = targetSpeed;
-         homeState.lastEndstopState = endstopAction;
-         
-         // return the carriage to the home position
-         targetPosition = (long)INCHES_TO_STEPS(MAX_TRAVEL_DISTANCE);
-         targetSpeed = HS24_MAX_SPEED;
-         endstopAction = STOP_HERE;
-         clockwise = false;							// towards the motor
-         newMove = true;
-         break;
-      
-         
-      /*
-       VIDEO MODE
-       in this mode, move parameters are built as the commands are entered, then we check before initiatiating a move in START_STATE
-       calculate speed in each state so data can be entered in any order
-       so we can display on the interface, calculate stepper params now and not in START_STATE
-      */
-      case SET_DISTANCE:
-         // get distance to travel in inches
-         idx = url.lastIndexOf('=');
-         if ( idx ) {
-            String value = url.substring(idx+1);
-            
-            video.travelDistance = constrain(value.toInt(), 1, maxDistance);
-            targetPosition = (long)INCHES_TO_STEPS(video.travelDistance);
-            if ( video.travelDuration ) {
-               targetSpeed = constrain((float)(targetPosition / video.travelDuration), 1.0, HS24_MAX_SPEED);	// steps per second
-            } else {
-               targetSpeed = 0;
-            }
-#if DEBUG >= 2
-            Serial.println(String("Travel distance: ") + String(video.travelDistance) + String(" inches "));
-#endif
-         }
-         break;
-         
-      case SET_DURATION:
-         //get travel duration
-         idx = url.lastIndexOf('=');
-         if ( idx ) {
-            String value = url.substring(idx+1);
-            
-            video.travelDuration = constrain(value.toInt(), 1, MAX_TRAVEL_TIME);
-            if ( targetPosition > 0 ) {
-               targetSpeed = constrain((float)(targetPosition / video.travelDuration), 1.0, HS24_MAX_SPEED);	// steps per second
-            } else {
-               targetSpeed = 0;
-            }
-#if DEBUG >= 2
-            Serial.println(String("Travel Duration: ") + String(video.travelDuration) + String(" sec "));
-#endif
-         }
-         break;
-      
-      /*
-       TIMELAPSE MODE
-       in this mode, individual moves are planned in timelapseMove(), not here, so just get the data we need
-      */
-      case SET_TL_DISTANCE:
-         // distance to move in total
-         idx = url.lastIndexOf('=');
-         if ( idx ) {
-            String value = url.substring(idx+1);
-            
-            timelapse.totalDistance = constrain(value.toInt(), 1, maxDistance);
-#if DEBUG >= 2
-            Serial.println(String("Total dist: ") + String(timelapse.totalDistance) + String(" inches "));
-#endif
-            timelapseParamsChanged = true;						// enable parameter checking below
-         }
-         break;
-         
-      case SET_TL_DURATION:
-         // total elapsed timrelapse seq time
-         idx = url.lastIndexOf('=');
-         if ( idx ) {
-            String value = url.substring(idx+1);
-            
-            // carriage needs time to stabalize after a move, so min time is 1 + this delay
-            timelapse.totalDuration = constrain(value.toInt(), CARR_SETTLE_SEC, MAX_TRAVEL_TIME);
-#if DEBUG >= 2
-            Serial.println(String("Total duration: ") + String(timelapse.totalDuration) + String(" sec "));
-#endif
-            timelapseParamsChanged = true;
-         }
-         break;
-         
-      case SET_TL_IMAGES:
-         // number of total images to capture
-         idx = url.lastIndexOf('=');
-         if ( idx ) {
-            String value = url.substring(idx+1);
-            
-            timelapse.totalImages = constrain(value.toInt(), 2, MAX_IMAGES);
-#if DEBUG >= 2
-            Serial.println(String("Total images: ") + String(timelapse.totalImages));
-#endif
-            timelapseParamsChanged = true;
-         }
-         break;
+   case TOK_ENDSTOP:
+      switch ( motion.endstop ) {
+      case REVERSE:
+         return "Reverse";
+
+      case ONE_CYCLE:
+         return "One Cycle";
 
-      case FORGET:
-         clearCredentials();
-         break;
-         
-      case NULL_ACTION:
       default:
-         break;
+         return "Stop";
       }
-      
-      /*
-       substitute current data variables for the placeholders in the base HTML file
-       
-       COMMON
-      */
-      switch ( sliderMode ) {
-      case MOVE_DISABLED:
-         indexModified.replace(String(STATE_VAR), String("Disabled"));
-         break;
-         
-      case MOVE_VIDEO:
-         indexModified.replace(String(STATE_VAR), String("Video"));
-         break;
-         
-      case MOVE_TIMELAPSE:
-         indexModified.replace(String(STATE_VAR), String("Timelapse"));
-         break;
-         
+
+   case TOK_ENDSTOP_CSS:
+      switch ( motion.endstop ) {
+      case REVERSE:
+         return CSS_PURPLE;
+
+      case ONE_CYCLE:
+         return CSS_BLUE;
+
       default:
-         break;
+         return CSS_RED;
       }
 
-      if ( (sliderMode != MOVE_DISABLED) && (sliderMode != MOVE_NOT_SET) ) {
-         // thiese fields not present on this screen
-         switch ( endstopAction ) {
-         case STOP_HERE:
-            indexModified.replace(String(ENDSTOP_VAR), String("Stop"));
-            indexModified.replace(String(ENDSTOP_CSS), String(CSS_RED));
-            break;
+   case TOK_DIRECTION:
+      return motion.clockwise ? "Away" : "Towards";
 
-         case REVERSE:
-            indexModified.replace(String(ENDSTOP_VAR), String("Reverse"));
-            indexModified.replace(String(ENDSTOP_CSS), String(CSS_PURPLE));
-            break;
+   case TOK_DIRECTION_CSS:
+      return motion.clockwise ? CSS_BLUE : CSS_ORANGE;
 
-         case ONE_CYCLE:
-            indexModified.replace(String(ENDSTOP_VAR), String("One Cycle"));
-            indexModified.replace(String(ENDSTOP_CSS), String(CSS_BLUE));
-            break;
+   case TOK_START:
+      return active ? "Running" : "Standby";
 
-         default:
-            break;
-         }
+   case TOK_START_CSS:
+      return active ? CSS_GREEN : CSS_RED;
 
-         indexModified.replace(String(DIRECTION_VAR), clockwise ? String("Away") : String("Towards"));
+   // video mode
+   case TOK_DISTANCE:
+      sprintf(buf, "%d", video.travelDistance);
+      return buf;
 
-         // common colors
-         if ( clockwise ) {
-            indexModified.replace(String(DIRECTION_CSS), String(CSS_BLUE));
-         } else {
-            indexModified.replace(String(DIRECTION_CSS), String(CSS_ORANGE));
-         }
-      }
+   case TOK_DISTANCE_CSS:
+      return colors.distance;
 
-      // mode-specific
-      if ( sliderMode == MOVE_VIDEO ) {
-         // variables
-         indexModified.replace(String(DISTANCE_VAR), String(video.travelDistance));
-         indexModified.replace(String(DURATION_VAR), String(video.travelDuration));
-         indexModified.replace(String(SPEED_VAR), String((float)(STEPS_TO_INCHES(targetSpeed)), 2));
-         indexModified.replace(String(START_VAR), running ? String("Running") : String("Standby"));
-         
-         // CSS colors
-         indexModified.replace(String(MODE_CSS), String(CSS_CYAN));
-         indexModified.replace(String(DISTANCE_CSS), distanceTextColor);
-         indexModified.replace(String(DURATION_CSS), durationTextColor);
-         indexModified.replace(String(START_CSS), running ? String(CSS_GREEN) : String(CSS_RED));
-         
-         // status section - stepsTaken will either have the running running total or the total from the last run (or 0 if never run, of course)
-         indexModified.replace(String(TRAVELED_VAR), String((float)(STEPS_TO_INCHES(stepsTaken)), 2));
-         if ( running ) {
-            // currently running
-            float t_duration = (float)((millis() - travelStart)/1000.0);
-            indexModified.replace(String(ELAPSED_VAR), String(t_duration, 2));
-            indexModified.replace(String(MEASURED_VAR), String((float)(STEPS_TO_INCHES(stepsTaken)/t_duration), 2));
-         } else if ( lastRunDuration ) {
-            // previous run
-            float t_duration = (float)(lastRunDuration/1000.0);
-            indexModified.replace(String(ELAPSED_VAR), String(t_duration, 2));
-            indexModified.replace(String(MEASURED_VAR), String((float)(STEPS_TO_INCHES(stepsTaken)/t_duration), 2));
-         } else {
-            indexModified.replace(String(ELAPSED_VAR), String(" "));
-            indexModified.replace(String(MEASURED_VAR), String(" "));
-         }
-      } else if ( sliderMode == MOVE_TIMELAPSE ) {
-         if ( timelapseParamsChanged && ((timelapse.totalDistance > 0) && (timelapse.totalDuration > 0) && (timelapse.totalImages > 0)) ) {
-            // pre-calculate & validate the sequence parameters for user display in status: the number of moves (images) and delay between images (moves)
-            timelapse.moveDistance = (int)floor(timelapse.totalDistance / (timelapse.totalImages - 1));
-            if ( timelapse.moveDistance <= 0 ) {
-               // must actually move the stepper for the state machine to function
-               timelapse.moveDistance = 1;
-               timelapse.totalDistance = timelapse.totalImages - 1;
-               totalDistanceTextColor = String("yellow");
-            }
-            
-            timelapse.moveInterval = (int)floor(timelapse.totalDuration / (timelapse.totalImages - 1));		
-            int minDelay = (int)ceil(INCHES_TO_STEPS(timelapse.moveDistance) / HS24_MAX_SPEED);			// inches per step / steps per second = seconds
-            minDelay += CARR_SETTLE_SEC;
-            if ( timelapse.moveInterval < minDelay ) {
-               // minimum interval is the carriage move time + stabilization delay
-               timelapse.moveInterval = minDelay;
-               timelapse.totalDuration = timelapse.moveInterval * (timelapse.totalImages - 1);
-               totalDurationTextColor = String("yellow");
-            }
-            timelapse.imageCount = 0;	
-#if DEBUG >= 2
-            Serial.println(String("Timelapse seq: ") + String(timelapse.totalImages) + String (" images moving ") + String(timelapse.moveDistance) + 
-              String (" in @ interval ") + String(timelapse.moveInterval));
-#endif				
-         }
-         
-         // variables
-         indexModified.replace(String(TL_DISTANCE_VAR), String(timelapse.totalDistance));
-         indexModified.replace(String(TL_DURATION_VAR), String(timelapse.totalDuration));
-         indexModified.replace(String(TL_IMAGES_VAR), String(timelapse.totalImages));
-         indexModified.replace(String(START_VAR), timelapse.enabled ? String("Running") : String("Standby"));
-         // colors
-         indexModified.replace(String(MODE_CSS), String(CSS_MAGENTA));
-         indexModified.replace(String(TL_DISTANCE_CSS), totalDistanceTextColor);
-         indexModified.replace(String(TL_DURATION_CSS), totalDurationTextColor);
-         indexModified.replace(String(TL_IMAGES_CSS), totalImagesTextColor);
-         indexModified.replace(String(START_CSS), timelapse.enabled ? String(CSS_GREEN) : String(CSS_RED));
-         
-         // status
-         indexModified.replace(String(TL_MOVEDIST), String(timelapse.moveDistance));
-         indexModified.replace(String(TL_INTERVAL), String(timelapse.moveInterval));
-         indexModified.replace(String(TL_COUNT), String(timelapse.imageCount));
-      } else {
-         // disabled
-         indexModified.replace(String(MODE_CSS), String(CSS_RED));
-      }
-      
+   case TOK_DURATION:
+      sprintf(buf, "%d", video.travelDuration);
+      return buf;
 
-#if DEBUG >= 3
-      Serial.println("\n**INDEX FILE MODIFIED**");
-      Serial.print(indexModified);
-#endif
-      // finally, send to the client
-      sendHTML(200, "text/html", indexModified);
-   }
-}
+   case TOK_DURATION_CSS:
+      return colors.duration;
 
-/*
+   case TOK_SPEED:
+      return dtostrf(mechStepsToInches(motion.targetSpeed), 1, 2, buf);
+
+   /*
+    status section - stepsTaken will either have the running running total or the total from the last run (or 0 if never run, of course)
+   */
+   case TOK_TRAVELED:
+      return dtostrf(mechStepsToInches(motion.stepsTaken), 1, 2, buf);
+
+   case TOK_ELAPSED:
+   case TOK_MEAS_SPEED:
+      if ( motion.running ) {
+         // currently running
+         t_duration = (float)((millis() - motion.travelStart)/1000.0);
+      } else if ( motion.lastRunDuration ) {
+         // previous run
+         t_duration = (float)(motion.lastRunDuration/1000.0);
+      }
+      if ( t_duration <= 0 ) {
+         return " ";
+      }
+      return dtostrf(token == TOK_ELAPSED ? t_duration : (float)(mechStepsToInches(motion.stepsTaken)/t_duration), 1, 2, buf);
+
+   // timelapse mode
+   case TOK_TL_DISTANCE:
+      sprintf(buf, "%d", timelapse.totalDistance);
+      return buf;
+
+   case TOK_TL_DISTANCE_CSS:
+      return colors.totalDistance;
+
+   case TOK_TL_DURATION:
+      sprintf(buf, "%d", timelapse.totalDuration);
+      return buf;
+
+   case TOK_TL_DURATION_CSS:
+      return colors.totalDuration;
+
+   case TOK_TL_IMAGES:
+      sprintf(buf, "%d", timelapse.totalImages);
+      return buf;
+
+   case TOK_TL_IMAGES_CSS:
+      return colors.totalImages;
+
+   case TOK_TL_MOVEDIST:
+      sprintf(buf, "%d", timelapse.moveDistance);
+      return buf;
+
+   case TOK_TL_INTERVAL:
+      sprintf(buf, "%d", timelapse.moveInterval);
+      return buf;
+
+   case TOK_TL_COUNT:
+      sprintf(buf, "%d", timelapse.imageCount);
+      return buf;
+
+   case TOK_SHUTTER:
+      switch ( timelapse.shutter.mode ) {
+      case SHUTTER_BURST:
+         return "Burst";
+
+      case SHUTTER_BRACKET:
+         return "Bracket";
+
+      case SHUTTER_BULB:
+         return "Bulb";
+
+      default:
+         return "Single";
+      }
+
+   case TOK_SHUTTER_CSS:
+      switch ( timelapse.shutter.mode ) {
+      case SHUTTER_BURST:
+         return CSS_BLUE;
+
+      case SHUTTER_BRACKET:
+         return CSS_PURPLE;
+
+      case SHUTTER_BULB:
+         return CSS_ORANGE;
+
+      default:
+         return CSS_GREY;
+      }
+
+   case TOK_TL_HOLD:
+      sprintf(buf, "%u", (unsigned int)timelapse.shutter.holdMsec);
+      return buf;
+
+   case TOK_TL_SHOTS:
+      sprintf(buf, "%u", (unsigned int)timelapse.shutter.shots);
+      return buf;
+
+   case TOK_TL_GAP:
+      sprintf(buf, "%u", (unsigned int)timelapse.shutter.gapMsec);
+      return buf;
+
+   case TOK_TL_STOPS:
+      sprintf(buf, "%u", (unsigned int)timelapse.shutter.stops);
+      return buf;
+
+   case TOK_TL_SHUTTER_CSS:
+      return colors.shutter;
+
+   case TOK_RESUME_CSS:
+      return (journalResumable() && !timelapse.enabled) ? "inline" : "none";
+
+   case TOK_RESUME_COUNT:
+      sprintf(buf, "%u", (unsigned int)journalState().frames);
+      return buf;
+
+   case TOK_MECH:
+      return mechanicsName(mechanics.profile);
+
+   default:
+      return "";
+   }
+}
+
+/*
+ stream a template with a single pass over its fragment table: copy each literal, then the value of the token that follows it
+*/
+void renderTemplate ( HTTPWriter &out, const HTML_Fragment *table, const Label_Colors &colors ) {
+   HTML_Fragment	fragment;
+   char				buf[TOKEN_VALUE_MAX];
+
+   do {
+      memcpy_P(&fragment, table++, sizeof(fragment));
+      out.write_P(fragment.literal, fragment.length);
+      if ( fragment.token != TOK_END ) {
+         out.print(tokenValue(fragment.token, colors, buf));
+      }
+   } while ( fragment.token != TOK_END );
+}
+
+/*
+ send the page for the current mode as HTML to the client: page header linking the stylesheet, then the body template
+*/
+void sendHTML ( const int code, const char *content_type, const HTML_Fragment *body, const Label_Colors &colors ) {
+   IPAddress ip = (WiFi.getMode() == WIFI_AP) ? WiFi.softAPIP() : WiFi.localIP();      // correct IP to add to page title
+
+   BLOG(BL_PAGE, code);
+   response.begin(*client, code, content_type);
+   response.print(F("<!DOCTYPE HTML> <HTML> <HEAD> <TITLE>WiFi CamSlider "));
+   response.print(ip);
+   response.print(F("</TITLE> <LINK rel=\"stylesheet\" type=\"text/css\" href=\"" STYLE_CSS_PATH "\"> "));
+   response.println(F("</HEAD>"));
+   renderTemplate(response, body, colors);
+   response.println(F("</HTML>"));
+   response.end();
+}
+
+/*
+ find the static asset for the request path, copied out of flash into asset
+*/
+bool findAsset ( Static_Asset &asset ) {
+   for ( uint8_t i = 0; i < STATIC_ASSET_COUNT; i++ ) {
+      memcpy_P(&asset, &static_assets[i], sizeof(asset));
+      if ( requestPathIs(*request, asset.path) ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+/*
+ send a static asset as stored (gzip) or 304 Not Modified if the client already has this version
+*/
+void sendAsset ( const Static_Asset &asset ) {
+   char	etag[ASSET_ETAG_MAX];
+   char	headers[ASSET_HEADERS_MAX];
+   int	length;
+
+   strncpy_P(etag, asset.etag, sizeof(etag));
+   etag[sizeof(etag) - 1] = '\0';
+   length = snprintf(headers, sizeof(headers), "ETag: %s\r\nCache-Control: " ASSET_CACHE_CONTROL "\r\n", etag);
+   if ( strstr(request->etag, etag) ) {
+      response.begin(*client, 304, NULL, headers);
+   } else {
+      snprintf(&headers[length], sizeof(headers) - length, "Content-Encoding: gzip\r\n");
+      response.begin(*client, 200, asset.type, headers, asset.length);
+      response.write_P((PGM_P)asset.data, asset.length);
+   }
+   response.end();
+}
+
+/*
+ motion control actions shared by the HTML and JSON interfaces
+*/
+
+/*
+ queue a command for the motion state machine
+*/
+bool sendCommand ( const MotionCommandType type ) {
+   Motion_Command command = { type };
+
+   if ( !motionCommand(command) ) {
+      ERROR(F("Motion queue full"), type);
+      return false;
+   }
+   return true;
+}
+
+/*
+ send the video move length and speed (speed depends on distance and duration)
+*/
+void sendVideoParams ( void ) {
+   Motion_Command params = { CMD_SET_PARAMS };
+
+   params.position = mechInchesToSteps(video.travelDistance);
+   if ( (params.position > 0) && video.travelDuration ) {
+      params.speed = constrain(plannerCruiseSpeed(params.position, video.travelDuration, mechAccel(), RAMP_SCURVE), 1.0, mechMaxSpeed());	// steps per second
+   } else {
+      params.speed = 0;
+   }
+   if ( !motionCommand(params) ) {
+      ERROR(F("Motion queue full"), CMD_SET_PARAMS);
+   }
+}
+
+/*
+ set the video move distance in inches and recalculate the stepper params
+ done at input time so the values can be displayed and so data can be entered in any order
+*/
+void setVideoDistance ( const long inches ) {
+   video.travelDistance = constrain(inches, 1, motionStatus().maxDistance);
+   sendVideoParams();
+#if DEBUG >= 2
+   Serial.println(String("Travel distance: ") + String(video.travelDistance) + String(" inches "));
+#endif
+}
+
+/*
+ set the video move duration in seconds and recalculate the speed
+*/
+void setVideoDuration ( const long seconds ) {
+   video.travelDuration = constrain(seconds, 1, MAX_TRAVEL_TIME);
+   sendVideoParams();
+#if DEBUG >= 2
+   Serial.println(String("Travel Duration: ") + String(video.travelDuration) + String(" sec "));
+#endif
+}
+
+/*
+ start a video move with the current parameters
+ returns false if the distance or duration has not been set
+*/
+bool startVideoMove ( void ) {
+   if ( (video.travelDistance <= 0) || (video.travelDuration <= 0) ) {
+      return false;
+   }
+   // travel position & speed were sent at input time, so just start the move
+   return sendCommand(CMD_START);
+}
+
+/*
+ set the direction of the next move
+*/
+void setDirection ( const bool away ) {
+   Motion_Command direction = { CMD_SET_DIRECTION };
+
+   direction.clockwise = away;
+   if ( !motionCommand(direction) ) {
+      ERROR(F("Motion queue full"), CMD_SET_DIRECTION);
+   }
+}
+
+/*
+ actions that act on the settings in the same request, so they are applied after all of them
+*/
+bool isCommand ( const T_Action action ) {
+   switch ( action ) {
+   case START_STATE:
+   case START_MOVE:
+   case HOME_CARRIAGE:
+   case CALIBRATE:
+   case RESUME:
+      return true;
+
+   default:
+      return false;
+   }
+}
+
+/*
+ check a setting value: a number, or 0/empty to leave the setting unchanged
+ setting is updated to the value it will have once the request is applied
+*/
+bool checkSetting ( const Action_Param &param, long &setting ) {
+   if ( (param.length && !param.numeric) || (param.value < 0) ) {
+      return false;
+   }
+   if ( param.value > 0 ) {
+      setting = param.value;
+   }
+   return true;
+}
+
+/*
+ the shutter sequence a request asks for: its count, gap, stops and exposure fields (0/empty: unchanged), then the next
+ mode if the shutter button was pressed, which fills in whatever that mode needs and was not set
+ returns false if a field is not a number
+*/
+bool requestShutter ( const Action_Param *params, const uint8_t count, Shutter_Sequence &sequence ) {
+   bool	next = false;
+   bool	valid = true;
+
+   sequence = timelapse.shutter;
+   for ( uint8_t i = 0; i < count; i++ ) {
+      long value = 0;
+
+      switch ( params[i].action ) {
+      case SET_TL_SHOTS:
+      case SET_TL_GAP:
+      case SET_TL_STOPS:
+      case SET_TL_HOLD:
+         if ( !checkSetting(params[i], value) || (value > (long)SHUTTER_MAX_MSEC) ) {
+            valid = false;
+         } else if ( value > 0 ) {
+            if ( params[i].action == SET_TL_SHOTS ) {
+               sequence.shots = (uint8_t)min(value, 255L);
+            } else if ( params[i].action == SET_TL_GAP ) {
+               sequence.gapMsec = (uint32_t)value;
+            } else if ( params[i].action == SET_TL_STOPS ) {
+               sequence.stops = (uint8_t)min(value, 255L);
+            } else {
+               sequence.holdMsec = (uint32_t)value;
+            }
+         }
+         break;
+
+      case SHUTTER_STATE:
+         next = true;
+         break;
+
+      default:
+         break;
+      }
+   }
+   if ( next ) {
+      shutterSetMode(sequence, (ShutterMode)((sequence.mode + 1) % (SHUTTER_BULB + 1)));
+   }
+   return valid;
+}
+
+/*
+ check a whole request before any of it is applied: settings must be numbers, DIR must be away or towards, and a move
+ started by the request must have everything it needs once the settings in the same request are included
+ the labels of the fields at fault are colored red; returns false if the request must be rejected
+*/
+bool validateRequest ( const Action_Param *params, const uint8_t count, Label_Colors &colors ) {
+   long	distance = video.travelDistance;
+   long	duration = video.travelDuration;
+   long	totalDistance = timelapse.totalDistance;
+   long	totalDuration = timelapse.totalDuration;
+   long	totalImages = timelapse.totalImages;
+   bool	starting = false;
+   bool	valid = true;
+   Shutter_Sequence	shutter;
+
+   // the shutter sequence is checked as a whole; it cannot change under a running sequence
+   if ( !requestShutter(params, count, shutter) || !shutterValid(shutter) ||
+      (timelapse.enabled && (memcmp(&shutter, &timelapse.shutter, sizeof(shutter)) != 0)) ) {
+      colors.shutter = "red";
+      valid = false;
+   }
+
+   for ( uint8_t i = 0; i < count; i++ ) {
+      switch ( params[i].action ) {
+      case SET_DISTANCE:
+         if ( !checkSetting(params[i], distance) ) {
+            colors.distance = "red";
+            valid = false;
+         }
+         break;
+
+      case SET_DURATION:
+         if ( !checkSetting(params[i], duration) ) {
+            colors.duration = "red";
+            valid = false;
+         }
+         break;
+
+      case SET_TL_DISTANCE:
+         if ( !checkSetting(params[i], totalDistance) ) {
+            colors.totalDistance = "red";
+            valid = false;
+         }
+         break;
+
+      case SET_TL_DURATION:
+         if ( !checkSetting(params[i], totalDuration) ) {
+            colors.totalDuration = "red";
+            valid = false;
+         }
+         break;
+
+      case SET_TL_IMAGES:
+         if ( !checkSetting(params[i], totalImages) ) {
+            colors.totalImages = "red";
+            valid = false;
+         }
+         break;
+
+      case DIRECTION:
+         if ( !dispatchValueIs(params[i], "away") && !dispatchValueIs(params[i], "towards") ) {
+            valid = false;
+         }
+         break;
+
+      case START_STATE:
+         // the same button stops a running move
+         starting = (sliderMode == MOVE_VIDEO) ? !motionStatus().running : !timelapse.enabled;
+         break;
+
+      case START_MOVE:
+         starting = true;
+         break;
+
+      default:
+         break;
+      }
+   }
+
+   if ( starting && (sliderMode == MOVE_VIDEO) && !motionStatus().running ) {
+      if ( distance <= 0 ) {
+         colors.distance = "red";
+         valid = false;
+      }
+      if ( duration <= 0 ) {
+         colors.duration = "red";
+         valid = false;
+      }
+   } else if ( starting && (sliderMode == MOVE_TIMELAPSE) && !timelapse.enabled ) {
+      if ( totalDistance <= 0 ) {
+         colors.totalDistance = "red";
+         valid = false;
+      }
+      if ( totalDuration <= 0 ) {
+         colors.totalDuration = "red";
+         valid = false;
+      }
+      if ( totalImages <= 0 ) {
+         colors.totalImages = "red";
+         valid = false;
+      }
+   }
+   return valid;
+}
+
+/*
+ make the state changes to the main sketch code for one action of a (validated) request
+ returns true if a timelapse parameter was changed
+*/
+bool applyAction ( const Action_Param &param, Label_Colors &colors ) {
+   bool	timelapseParamsChanged = false;					// determines if user movement parameters changed
+   long	value = param.value;
+
+   switch ( param.action ) {
+   /*
+    COMMON ACTIONS (implementation may be state-specific)
+   */
+   case SLIDER_STATE:
+       //toggles state to the next state in sequence
+      switch ( sliderMode ) {
+      case MOVE_DISABLED:
+         sliderMode = MOVE_VIDEO;
+         video.travelDistance = 0;
+         video.travelDuration = 0;
+         break;
+         
+      case MOVE_VIDEO:
+         sliderMode = MOVE_TIMELAPSE;
+         timelapse.totalDistance = 0;
+         timelapse.totalDuration = 0;
+         timelapse.totalImages = 0;
+         break;
+         
+      case MOVE_TIMELAPSE:
+         sliderMode = MOVE_DISABLED;
+         break;
+         
+      default:
+         break;
+      }
+      break;
+      
+   case ENDSTOP_STATE:
+      // toggle endstop state to next one in sequence
+      {
+         Motion_Command endstop = { CMD_SET_ENDSTOP };
+
+         switch ( motionStatus().endstop ) {
+         case STOP_HERE:
+            endstop.endstop = REVERSE;
+            break;
+            
+         case REVERSE:
+            endstop.endstop = ONE_CYCLE;
+            break;
+            
+         case ONE_CYCLE:
+         default:
+            endstop.endstop = STOP_HERE;
+            break;
+         }
+         if ( !motionCommand(endstop) ) {
+            ERROR(F("Motion queue full"), CMD_SET_ENDSTOP);
+         }
+      }
+      break;
+      
+   case SET_DIRECTION:
+      // toggle carriage direction
+      setDirection(!motionStatus().clockwise);
+      break;
+
+   case DIRECTION:
+      setDirection(dispatchValueIs(param, "away"));
+      break;
+
+   case START_MOVE:
+      // like the Run button, but never stops a move
+      if ( (sliderMode == MOVE_VIDEO) ? motionStatus().running : timelapse.enabled ) {
+         break;
+      }
+      // fall through
+   case START_STATE:
+      /*
+        stop or initiatiate movement
+        indicate errors to user if req data is missing
+      */
+      if ( sliderMode == MOVE_VIDEO ) {
+         if ( motionStatus().running ) {
+            sendCommand(CMD_STOP);								// state machine will clear running flag
+         } else if ( !startVideoMove() ) {
+            colors.duration = "red";
+         }
+      } else if ( sliderMode == MOVE_TIMELAPSE ) {
+         if ( timelapse.enabled ) {
+            sendCommand(CMD_STOP);
+         } else {
+            // the request was checked for the sequence params and the move plan was calculated from them
+#if DEBUG >= 2
+            Serial.println(String("Timelapse seq: ") + String(timelapse.totalImages) + String (" images moving ") + String(timelapse.moveDistance) + 
+              String (" in @ interval ") + String(timelapse.moveInterval));
+#endif
+            sendCommand(CMD_TIMELAPSE);
+         }
+      }
+      break;
+
+   case CALIBRATE:
+   case HOME_CARRIAGE:
+      sendCommand(param.action == CALIBRATE ? CMD_CALIBRATE : CMD_HOME);
+      break;
+   
+      
+   /*
+    VIDEO MODE
+    in this mode, move parameters are built as the commands are entered, then we check before initiatiating a move in START_STATE
+    calculate speed in each state so data can be entered in any order
+    so we can display on the interface, calculate stepper params now and not in START_STATE
+   */
+   case SET_DISTANCE:
+      // get distance to travel in inches (0 or empty: unchanged)
+      if ( value > 0 ) {
+         setVideoDistance(value);
+      }
+      break;
+      
+   case SET_DURATION:
+      //get travel duration
+      if ( value > 0 ) {
+         setVideoDuration(value);
+      }
+      break;
+   
+   /*
+    TIMELAPSE MODE
+    in this mode, individual moves are planned in timelapseMove(), not here, so just get the data we need
+   */
+   case SET_TL_DISTANCE:
+      // distance to move in total (0, empty or the current value: unchanged)
+      if ( (value <= 0) || (constrain(value, 1, motionStatus().maxDistance) == timelapse.totalDistance) ) {
+         break;
+      }
+      timelapse.totalDistance = constrain(value, 1, motionStatus().maxDistance);
+#if DEBUG >= 2
+      Serial.println(String("Total dist: ") + String(timelapse.totalDistance) + String(" inches "));
+#endif
+      timelapseParamsChanged = true;						// enable parameter checking below
+      break;
+      
+   case SET_TL_DURATION:
+      // total elapsed timrelapse seq time
+      // carriage needs time to stabalize after a move, so min time is 1 + this delay
+      if ( (value <= 0) || (constrain(value, CARR_SETTLE_SEC, MAX_TRAVEL_TIME) == timelapse.totalDuration) ) {
+         break;
+      }
+      timelapse.totalDuration = constrain(value, CARR_SETTLE_SEC, MAX_TRAVEL_TIME);
+#if DEBUG >= 2
+      Serial.println(String("Total duration: ") + String(timelapse.totalDuration) + String(" sec "));
+#endif
+      timelapseParamsChanged = true;
+      break;
+      
+   case SET_TL_IMAGES:
+      // number of total images to capture
+      if ( (value <= 0) || (constrain(value, 2, MAX_IMAGES) == timelapse.totalImages) ) {
+         break;
+      }
+      timelapse.totalImages = constrain(value, 2, MAX_IMAGES);
+#if DEBUG >= 2
+      Serial.println(String("Total images: ") + String(timelapse.totalImages));
+#endif
+      timelapseParamsChanged = true;
+      break;
+
+   case FORGET:
+      clearCredentials();
+      break;
+
+   case MECHANICS:
+      // next profile; the custom one is only offered once it has been set up through the API
+      if ( !motionStatus().running && !timelapse.enabled ) {
+         Mechanics_Profile next = mechanicsProfile();
+
+         do {
+            next.profile = (next.profile + 1) % MECH_COUNT;
+         } while ( (next.profile == MECH_CUSTOM) && !next.stepsPerMM );
+         mechanicsSelect(next);
+      }
+      break;
+
+   case RESUME:
+      // continue the sequence interrupted by a reset
+      if ( journalResumable() && !timelapse.enabled ) {
+         sliderMode = MOVE_TIMELAPSE;
+         sendCommand(CMD_RESUME);
+      }
+      break;
+      
+   case NULL_ACTION:
+   default:
+      break;
+   }
+   
+   return timelapseParamsChanged;
+}
+
+/*
+ pre-calculate & validate the sequence parameters for user display in status: the number of moves (images) and delay
+ between images (moves)
+*/
+void planTimelapse ( Label_Colors &colors ) {
+   int		moves = timelapse.totalImages - 1;
+
+   if ( mechInchesToSteps(timelapse.totalDistance) < moves ) {
+      // must actually move the stepper on every frame for the state machine to function
+      while ( mechInchesToSteps(timelapse.totalDistance) < moves ) {
+         ++timelapse.totalDistance;
+      }
+      colors.totalDistance = "yellow";
+   }
+   timelapse.moveDistance = timelapse.totalDistance / moves;
+
+   // the frame plan spreads the remainders, so the longest move is one step longer than the average and the shortest
+   // interval is the average rounded down to the msec
+   uint32_t maxSteps = ((uint32_t)mechInchesToSteps(timelapse.totalDistance) + moves - 1) / moves;
+   uint32_t minMsec = plannerMoveTime(maxSteps, mechMaxSpeed(), mechAccel(), RAMP_SCURVE) + (CARR_SETTLE_SEC * 1000UL) +
+      shutterDuration(timelapse.shutter);
+   if ( ((uint32_t)timelapse.totalDuration * 1000UL) / moves < minMsec ) {
+      // minimum interval is the carriage move time + stabilization delay + exposure sequence
+      timelapse.totalDuration = (int)(((minMsec * moves) + 999) / 1000);
+      colors.totalDuration = "yellow";
+   }
+   timelapse.moveInterval = timelapse.totalDuration / moves;
+   timelapse.imageCount = 0;	
+#if DEBUG >= 2
+   Serial.println(String("Timelapse seq: ") + String(timelapse.totalImages) + String (" images moving ") + String(timelapse.moveDistance) + 
+     String (" in @ interval ") + String(timelapse.moveInterval));
+#endif
+}
+
+/*
+ apply the actions of a request as one transaction, then render the HTML template for the current mode (video,
+ timelapse or disabled) and send it to the client
+ the request is checked as a whole first and nothing is changed if any part of it is invalid; settings are applied
+ before the commands (e.g. start) that use them, whatever their order in the request
+
+ Color coding:
+  * buttons change color when changing state (e.g. run -> standby)
+  * text labels will indicated errors in red, "cautions" in yellow (e.g. if parameters were reset to meet min/max limits)
+*/
+void sendResponse ( const Action_Param *params, const uint8_t count ) {
+   bool				timelapseParamsChanged = false;		// determines if user movement parameters changed
+   Label_Colors	colors = { "white", "white", "white", "white", "white", "white" };	// default colors
+
+   if ( (count == 1) && (params[0].action == IGNORE) ) {
+      // still answer, so a kept-alive connection is free for the next request
+      response.begin(*client, 404, "text/plain");
+      response.end();
+      return;
+   }
+   for ( uint8_t i = 0; i < count; i++ ) {
+      BLOG(BL_REQUEST, params[i].action, params[i].value, sliderMode);
+   }
+
+   //process user actions
+   if ( validateRequest(params, count, colors) ) {
+      Shutter_Sequence shutter;
+
+      for ( uint8_t i = 0; i < count; i++ ) {
+         if ( !isCommand(params[i].action) ) {
+            timelapseParamsChanged |= applyAction(params[i], colors);
+         }
+      }
+      requestShutter(params, count, shutter);
+      if ( memcmp(&shutter, &timelapse.shutter, sizeof(shutter)) != 0 ) {
+         // the minimum interval includes the exposures
+         timelapse.shutter = shutter;
+         timelapseParamsChanged = true;
+      }
+      if ( (sliderMode == MOVE_TIMELAPSE) && timelapseParamsChanged && ((timelapse.totalDistance > 0) && (timelapse.totalDuration > 0) && (timelapse.totalImages > 0)) ) {
+         planTimelapse(colors);
+      }
+      for ( uint8_t i = 0; i < count; i++ ) {
+         if ( isCommand(params[i].action) ) {
+            applyAction(params[i], colors);
+         }
+      }
+   }
+
+   // let the motion FSM take the queued commands so the page shows their effect
+   motionApply();
+
+   // choose the page for the current mode; the current data is substituted for the template tokens as it is sent
+   const HTML_Fragment	*body;
+
+   switch ( sliderMode ) {
+   case MOVE_VIDEO:
+      body = video_body_html;
+      break;
+
+   case MOVE_TIMELAPSE:
+      body = timelapse_body_html;
+      break;
+
+   case MOVE_DISABLED:
+   default:
+      body = disabled_body_html;
+      break;
+   }
+
+   METRIC_TIMER(renderStart);
+   sendHTML(200, "text/html", body, colors);
+   METRIC_OBSERVE(H_RENDER, micros() - renderStart);
+}
+
+/*
+ JSON interface for controllers that only need the state, not the page:
+   GET  /api/status     current slider state
+   POST /api/move       body {"distance":48,"duration":120,"direction":"away","action":"start"}; every field is optional
+                        and action is one of start, stop, home or resume (continue a timelapse sequence interrupted
+                        by a reset). The timelapse shutter sequence is set with any of {"shutter":"bracket","shots":3,
+                        "gap":1000,"stops":1,"hold":250}: mode single, burst, bracket or bulb, exposures per frame,
+                        msec between them, bracket spacing in EV and the pulse (bulb: exposure) in msec. Responds
+                        with the status after the changes.
+   POST /api/trace      (STEP_TRACE builds) capture step timing for the next move; responds with the status
+   GET  /api/trace      download the last capture (see Trace.h)
+   GET  /api/mechanics  the selected mechanics profile and the names of all profiles (see Mechanics.h)
+   POST /api/mechanics  body {"profile":1} selects a profile by number; any of {"steps_per_mm":6.25,"microsteps":8,
+                        "max_speed":600,"accel":800,"travel":72} (full steps, inches) changes the custom profile and
+                        selects it. Responds with the profile after the change.
+ Responses are generated directly from the globals through the response writer without building a String.
+*/
+#define API_STATUS				"/api/status"
+#define API_MOVE					"/api/move"
+#define API_TRACE					"/api/trace"
+#define API_MECHANICS			"/api/mechanics"
+
+/*
+ return a pointer to the value for key in a flat JSON object, or NULL if the key is not present
+*/
+const char *jsonValue ( const char *json, const char *key ) {
+   size_t length = strlen(key);
+
+   for ( const char *p = strchr(json, '"'); p != NULL; p = strchr(p + 1, '"') ) {
+      if ( (strncmp(p + 1, key, length) == 0) && (p[length + 1] == '"') ) {
+         p += length + 2;
+         while ( (*p == ' ') || (*p == ':') ) {
+            ++p;
+         }
+         return p;
+      }
+   }
+   return NULL;
+}
+
+/*
+ true if the JSON value at value is the string str
+*/
+bool jsonIs ( const char *value, const char *str ) {
+   size_t length = strlen(str);
+
+   return (value[0] == '"') && (strncmp(value + 1, str, length) == 0) && (value[length + 1] == '"');
+}
+
+void sendJSONError ( const int code, const __FlashStringHelper *message ) {
+   response.begin(*client, code, "application/json");
+   response.print(F("{\"error\":\""));
+   response.print(message);
+   response.print(F("\"}"));
+   response.end();
+}
+
+void sendStatus ( void ) {
+   static const char *modeNames[] = { "none", "disabled", "video", "timelapse" };
+   static const char *endstopNames[] = { "stop", "reverse", "cycle" };
+#ifdef STEP_TRACE
+   static const char *traceNames[] = { "idle", "armed", "active", "ready" };
+#endif
+   const Motion_Status	&motion = motionStatus();
+
+   response.begin(*client, 200, "application/json");
+   response.print(F("{\"mode\":\""));
+   response.print(modeNames[sliderMode]);
+   response.print(F("\",\"state\":\""));
+   response.print(carriageStateNames[motion.state]);
+   response.print(F("\",\"running\":"));
+   response.print(motion.running ? F("true") : F("false"));
+   response.print(F(",\"direction\":\""));
+   response.print(motion.clockwise ? F("away") : F("towards"));
+   response.print(F("\",\"endstop\":\""));
+   response.print(endstopNames[motion.endstop]);
+   response.print(F("\",\"mechanics\":\""));
+   response.print(mechanicsName(mechanics.profile));
+   response.print(F("\",\"distance\":"));
+   response.print(video.travelDistance);
+   response.print(F(",\"duration\":"));
+   response.print(video.travelDuration);
+   response.print(F(",\"target\":"));
+   response.print(motion.targetPosition);
+   response.print(F(",\"speed\":"));
+   response.print(motion.targetSpeed, 2);
+   response.print(F(",\"steps\":"));
+   response.print(motion.stepsTaken);
+   response.print(F(",\"elapsed\":"));
+   response.print(motion.running ? (millis() - motion.travelStart) : motion.lastRunDuration);
+   response.print(F(",\"timelapse\":{\"enabled\":"));
+   response.print(timelapse.enabled ? F("true") : F("false"));
+   response.print(F(",\"images\":"));
+   response.print(timelapse.totalImages);
+   response.print(F(",\"count\":"));
+   response.print(timelapse.imageCount);
+   response.print(F(",\"step\":"));
+   response.print(timelapse.moveDistance);
+   response.print(F(",\"interval\":"));
+   response.print(timelapse.moveInterval);
+   response.print(F(",\"late\":"));
+   response.print(timelapse.drift.late);
+   response.print(F(",\"drift\":"));
+   response.print(timelapse.drift.maxDrift);
+   response.print(F(",\"shutter\":{\"mode\":\""));
+   response.print(shutterModeName(timelapse.shutter.mode));
+   response.print(F("\",\"shots\":"));
+   response.print(timelapse.shutter.shots);
+   response.print(F(",\"gap\":"));
+   response.print(timelapse.shutter.gapMsec);
+   response.print(F(",\"stops\":"));
+   response.print(timelapse.shutter.stops);
+   response.print(F(",\"hold\":"));
+   response.print(timelapse.shutter.holdMsec);
+   response.print(F("},\"resume\":"));
+   if ( journalResumable() ) {
+      response.print(journalState().frames);
+   } else {
+      response.print(F("null"));
+   }
+   response.print(F("}"));
+#ifdef STEP_TRACE
+   response.print(F(",\"trace\":\""));
+   response.print(traceNames[traceState()]);
+   response.print(F("\""));
+#endif
+   response.print(F("}"));
+   response.end();
+}
+
+/*
+ apply a move request: all fields are validated before anything is changed
+*/
+void apiMove ( void ) {
+   const char	*distance = jsonValue(request->body, "distance");
+   const char	*duration = jsonValue(request->body, "duration");
+   const char	*direction = jsonValue(request->body, "direction");
+   const char	*action = jsonValue(request->body, "action");
+   const char	*shutterMode = jsonValue(request->body, "shutter");
+   const char	*shutterFields[] = { jsonValue(request->body, "shots"), jsonValue(request->body, "gap"),
+                                    jsonValue(request->body, "stops"), jsonValue(request->body, "hold") };
+   Shutter_Sequence	shutter = timelapse.shutter;
+   bool					shutterChange = (shutterMode != NULL);
+
+   if ( (distance && !isdigit(*distance)) || (duration && !isdigit(*duration)) ) {
+      sendJSONError(400, F("distance and duration must be numbers"));
+      return;
+   }
+   if ( direction && !jsonIs(direction, "away") && !jsonIs(direction, "towards") ) {
+      sendJSONError(400, F("direction must be away or towards"));
+      return;
+   }
+   if ( action && !jsonIs(action, "start") && !jsonIs(action, "stop") && !jsonIs(action, "home") && !jsonIs(action, "resume") ) {
+      sendJSONError(400, F("action must be start, stop, home or resume"));
+      return;
+   }
+
+   // shutter sequence: the fields, then the mode, which fills in whatever it needs and was not given
+   for ( uint8_t i = 0; i < sizeof(shutterFields) / sizeof(shutterFields[0]); i++ ) {
+      unsigned long value;
+
+      if ( !shutterFields[i] ) {
+         continue;
+      }
+      value = strtoul(shutterFields[i], NULL, 10);
+      if ( !isdigit(*shutterFields[i]) || (value > SHUTTER_MAX_MSEC) ) {
+         sendJSONError(400, F("shutter values must be numbers"));
+         return;
+      }
+      switch ( i ) {
+      case 0:
+         shutter.shots = (uint8_t)min(value, 255UL);
+         break;
+
+      case 1:
+         shutter.gapMsec = value;
+         break;
+
+      case 2:
+         shutter.stops = (uint8_t)min(value, 255UL);
+         break;
+
+      default:
+         shutter.holdMsec = value;
+         break;
+      }
+      shutterChange = true;
+   }
+   if ( shutterMode ) {
+      const char	*end = (*shutterMode == '"') ? strchr(shutterMode + 1, '"') : NULL;
+      ShutterMode	mode;
+
+      if ( !end || !shutterModeFind(shutterMode + 1, end - shutterMode - 1, mode) ) {
+         sendJSONError(400, F("shutter must be single, burst, bracket or bulb"));
+         return;
+      }
+      shutterSetMode(shutter, mode);
+   }
+   if ( !shutterValid(shutter) ) {
+      sendJSONError(400, F("shutter sequence out of range"));
+      return;
+   }
+
+   if ( (motionStatus().running || timelapse.enabled) && (distance || duration || direction || shutterChange ||
+      (action && !jsonIs(action, "stop"))) ) {
+      sendJSONError(409, F("carriage is moving"));
+      return;
+   }
+
+   if ( distance ) {
+      setVideoDistance(atol(distance));
+   }
+   if ( duration ) {
+      setVideoDuration(atol(duration));
+   }
+   if ( direction ) {
+      setDirection(jsonIs(direction, "away"));
+   }
+   if ( shutterChange ) {
+      timelapse.shutter = shutter;
+      if ( (timelapse.totalDistance > 0) && (timelapse.totalDuration > 0) && (timelapse.totalImages > 0) ) {
+         // the minimum interval includes the exposures
+         Label_Colors colors;
+
+         planTimelapse(colors);
+      }
+   }
+   if ( action ) {
+      if ( jsonIs(action, "start") ) {
+         sliderMode = MOVE_VIDEO;
+         if ( !startVideoMove() ) {
+            sendJSONError(400, F("distance and duration required"));
+            return;
+         }
+      } else if ( jsonIs(action, "stop") ) {
+         sendCommand(CMD_STOP);								// state machine will clear running flag
+      } else if ( jsonIs(action, "resume") ) {
+         if ( !journalResumable() ) {
+            sendJSONError(409, F("no interrupted sequence"));
+            return;
+         }
+         sliderMode = MOVE_TIMELAPSE;
+         sendCommand(CMD_RESUME);
+      } else {
+         sendCommand(CMD_HOME);
+      }
+   }
+   motionApply();
+   sendStatus();
+}
+
+void sendMechanics ( void ) {
+   const Mechanics_Profile	&selected = mechanicsProfile();
+   Mechanics_Profile			values = (selected.profile == MECH_CUSTOM) ? selected : mechanicsDefaults(selected.profile);
+
+   response.begin(*client, 200, "application/json");
+   response.print(F("{\"profile\":"));
+   response.print(selected.profile);
+   response.print(F(",\"name\":\""));
+   response.print(mechanicsName(selected.profile));
+   response.print(F("\",\"steps_per_mm\":"));
+   response.print((float)values.stepsPerMM / (1UL << MECH_FRAC_BITS), 4);
+   response.print(F(",\"microsteps\":"));
+   response.print(values.microsteps);
+   response.print(F(",\"max_speed\":"));
+   response.print(values.maxSpeed);
+   response.print(F(",\"accel\":"));
+   response.print(values.accel);
+   response.print(F(",\"travel\":"));
+   response.print(values.maxTravel);
+   response.print(F(",\"profiles\":["));
+   for ( uint8_t i = 0; i < MECH_COUNT; i++ ) {
+      response.print(i ? F(",\"") : F("\""));
+      response.print(mechanicsName(i));
+      response.print(F("\""));
+   }
+   response.print(F("]}"));
+   response.end();
+}
+
+/*
+ select a profile or change the custom one: all fields are validated before anything is changed
+*/
+void apiMechanics ( void ) {
+   if ( !requestMethodIs(*request, "POST") ) {
+      sendMechanics();
+      return;
+   }
+
+   const char			*profile = jsonValue(request->body, "profile");
+   const char			*fields[] = { jsonValue(request->body, "steps_per_mm"), jsonValue(request->body, "microsteps"),
+                                    jsonValue(request->body, "max_speed"), jsonValue(request->body, "accel"),
+                                    jsonValue(request->body, "travel") };
+   Mechanics_Profile	next = mechanicsProfile();
+   bool					custom = false;
+
+   if ( profile && (!isdigit(*profile) || (atol(profile) >= MECH_COUNT)) ) {
+      sendJSONError(400, F("unknown profile"));
+      return;
+   }
+   for ( uint8_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++ ) {
+      if ( fields[i] && !isdigit(*fields[i]) ) {
+         sendJSONError(400, F("profile values must be numbers"));
+         return;
+      }
+      custom = custom || fields[i];
+   }
+   if ( motionStatus().running || timelapse.enabled ) {
+      sendJSONError(409, F("carriage is moving"));
+      return;
+   }
+
+   if ( custom ) {
+      if ( !next.stepsPerMM ) {
+         // start the custom profile from the one in use
+         next = mechanicsDefaults(next.profile);
+      }
+      next.profile = MECH_CUSTOM;
+      if ( fields[0] ) {
+         next.stepsPerMM = (uint32_t)(atof(fields[0]) * (1UL << MECH_FRAC_BITS) + 0.5);
+      }
+      if ( fields[1] ) {
+         next.microsteps = (uint8_t)min(atol(fields[1]), 255L);			// out of range values stay unusable
+      }
+      if ( fields[2] ) {
+         next.maxSpeed = (uint16_t)min(atol(fields[2]), 65535L);
+      }
+      if ( fields[3] ) {
+         next.accel = (uint16_t)min(atol(fields[3]), 65535L);
+      }
+      if ( fields[4] ) {
+         next.maxTravel = (uint16_t)min(atol(fields[4]), 65535L);
+      }
+   } else if ( profile ) {
+      next.profile = (uint8_t)atol(profile);
+   }
+   if ( !mechanicsSelect(next) ) {
+      sendJSONError(400, F("unusable profile"));
+      return;
+   }
+   sendMechanics();
+}
+
+/*
+ handle a request for the JSON interface
+*/
+#ifdef STEP_TRACE
+/*
+ POST arms a capture of the next move, GET downloads the last completed capture
+*/
+void apiTrace ( void ) {
+   if ( requestMethodIs(*request, "POST") ) {
+      traceArm();
+      sendStatus();
+   } else if ( traceState() == TRACE_READY ) {
+      response.begin(*client, 200, "application/octet-stream");
+      traceSend(response);
+      response.end();
+   } else {
+      sendJSONError(409, F("no completed capture"));
+   }
+}
+#endif
+
+void apiService ( void ) {
+   if ( requestPathIs(*request, API_STATUS) ) {
+      sendStatus();
+   } else if ( requestPathIs(*request, API_MOVE) && requestMethodIs(*request, "POST") ) {
+      apiMove();
+   } else if ( requestPathIs(*request, API_MECHANICS) ) {
+      apiMechanics();
+#ifdef STEP_TRACE
+   } else if ( requestPathIs(*request, API_TRACE) ) {
+      apiTrace();
+#endif
+   } else {
+      sendJSONError(404, F("unknown request"));
+   }
+}
+
+/*
+ read and answer the request on the current connection, at most one request per call
+*/
+void serviceConnection ( void ) {
+   Static_Asset	asset;
+
+   // retrieve as much of the request as is available from the client stream
+   switch ( requestPoll(*request, *client, REQUEST_BUDGET_USEC) ) {
+   case REQ_READY:
+      METRIC_COUNT(C_REQUESTS);
+      break;
+
+   case REQ_ERROR:
+      ERROR(F("Bad request"), request->line);
+      client->stop();
+      return;
+
+   default:
+      if ( requestTimedOut(*request) ) {
+         if ( !requestIdle(*request) ) {
+            ERROR(F("Request timeout"), request->line);
+         }
+         client->stop();
+      }
+      return;
+   }
+
+#if DEBUG >= 2
+   uint32_t serviceStart = micros();
+   uint32_t heapStart = ESP.getFreeHeap();
+#endif
+   response.setKeepAlive(request->keepAlive);
+   response.setVersion(request->http11);
+   if ( requestPathIs(*request, EVENT_PATH) ) {
+      // the event stream takes over the connection
+      if ( eventSubscribe(*client) ) {
+         *client = WiFiClient();
+         return;
+      }
+      sendJSONError(503, F("too many subscribers"));
+   } else if ( requestPathIs(*request, API_STATUS) || requestPathIs(*request, API_MOVE) || requestPathIs(*request, API_TRACE) ||
+               requestPathIs(*request, API_MECHANICS) ) {
+      apiService();
+#ifdef METRICS
+   } else if ( requestPathIs(*request, METRICS_PATH) ) {
+      response.begin(*client, 200, "text/plain; version=0.0.4");
+      metricsRender(response);
+      response.end();
+#endif
+   } else if ( findAsset(asset) ) {
+      sendAsset(asset);
+   } else {
+      const char		*query = request->query ? &request->line[request->query] : NULL;
+      Action_Param	params[DISPATCH_PARAMS_MAX];
+
+      sendResponse(params, dispatchActions(&request->line[request->path], query, params, DISPATCH_PARAMS_MAX));
+   }
+#if DEBUG >= 2
+   BLOG(BL_SENT, response.sent(), micros() - serviceStart, heapStart - ESP.getFreeHeap());
+#endif
+   if ( response.persistent() && client->connected() ) {
+      requestBegin(*request);                                  // wait for the next request on this connection
+   } else {
+      client->stop();
+   }
+}
+
+/*
+ accept a waiting client into a free connection slot, or in place of the connection that has been idle longest
+ a connection in the middle of a request is never dropped: if all of them are, new clients wait in the listen backlog
+ returns true if a client was accepted
+*/
+bool acceptConnection ( void ) {
+   int8_t		slot = -1;
+   uint32_t		longest = 0;
+   WiFiClient	incoming;
+
+   for ( uint8_t i = 0; i < HTTP_CONNECTIONS; i++ ) {
+      if ( !connections[i].client.connected() ) {
+         slot = i;
+         break;
+      }
+      if ( requestIdle(connections[i].request) && ((millis() - connections[i].request.start) >= longest) ) {
+         longest = millis() - connections[i].request.start;
+         slot = i;
+      }
+   }
+   if ( slot < 0 ) {
+      return false;
+   }
+   incoming = server.available();
+   if ( !incoming || !incoming.connected() ) {
+      return false;
+   }
+   connections[slot].client.stop();                            // idle connection being replaced, if any
+   connections[slot].client = incoming;
+   requestBegin(connections[slot].request);
+   BLOG(BL_CLIENT, userConnected);
+   return true;
+}
+
+/*
   main WiFi service routine
+  accepts new clients, then gives each open connection one bounded slice in turn: its request is read a little at a
+  time on each call until it is complete, so that a slow client never blocks loop() or the other clients
 */
 void WiFiService ( void ) {
-   bool responseSent = false;
-   
-   client = server.available();
-   if ( client && client.connected() ) {
-      INFO(F("Client connected. Connected flag"), userConnected);
+   eventService();
+   if ( acceptConnection() && !userConnected ) {
       /*
        If this is the first time we are connected, disable AP mode broadcast of the IP address
        and enable OTA mode
        To be safe, we'll exit now and pick up the user commands on the next iteration
       */
-      if (!userConnected) {
-         userConnected = true;
-         STAMode();
-         sliderMode = MOVE_TIMELAPSE;                       // set initial default so LED status light will change
-         return;
-      }
-      // retrieve the URI request from the client stream
-      String uri = client.readStringUntil('\r');
-      INFO(F("Client URI"), uri);
-      client.flush();
-      
-      // scan the action table to get the action and send appropriate response
-      for ( uint8_t i = 0; i < ACTION_TABLE_SIZE; i++ ) {
-         if ( uri.indexOf(actionTable[i].action) != -1 ) {
-            // done once we found the first match (this is why null actions are the the bottom of the table)
-            sendResponse(actionTable[i].type, uri);
-            responseSent = true;
-            break;
-         }
-      }
-      if ( !responseSent ) {
-         // keep the connection alive
-         sendResponse(NULL_ACTION, uri);
+      userConnected = true;
+      STAMode();
+      sliderMode = MOVE_TIMELAPSE;                       // set initial default so LED status light will change
+      return;
+   }
+
+   for ( uint8_t n = 0; n < HTTP_CONNECTIONS; n++ ) {
+      uint8_t i = (nextConnection + n) % HTTP_CONNECTIONS;
+
+      if ( connections[i].client.connected() ) {
+         client = &connections[i].client;
+         request = &connections[i].request;
+         serviceConnection();
       }
-      client.stop();
    }
-}
\ No newline at end of file
+   nextConnection = (nextConnection + 1) % HTTP_CONNECTIONS;
+}
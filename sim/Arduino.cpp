@@ -0,0 +1,360 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: Arduino core classes, serial port, ESP, EEPROM, raw flash and heap
+   statistics
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <map>
+#include <vector>
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <ArduinoOTA.h>
+#include <umm_malloc/umm_malloc.h>
+extern "C" {
+#include <spi_flash.h>
+}
+#include "Sim.h"
+
+#define SIM_HEAP_FREE			40000						// free heap reported to the sketch (typical after boot)
+#define SIM_FLASH_SIZE			(4 * 1024 * 1024)		// 4M flash (1M SPIFFS) - see the link in the Makefile
+
+HardwareSerial		Serial;
+EspClass				ESP;
+EEPROMClass			EEPROM;
+ArduinoOTAClass	ArduinoOTA;
+UMM_HEAP_INFO		ummHeapInfo;
+
+static bool			serialEcho = true;
+static std::map<uint16_t, std::vector<uint8_t> >	flash;		// sectors touched so far; the rest are erased
+static uint32_t	randomState = 1;
+
+/*
+ String
+*/
+static std::string formatNumber ( unsigned long value, const unsigned char base ) {
+   char	buf[8 * sizeof(long) + 1];
+   char	*p = &buf[sizeof(buf) - 1];
+   int	radix = (base < 2) ? 10 : base;
+
+   *p = '\0';
+   do {
+      unsigned digit = value % radix;
+
+      *--p = (char)((digit < 10) ? ('0' + digit) : ('a' + digit - 10));
+      value /= radix;
+   } while ( value );
+   return std::string(p);
+}
+
+static std::string formatSigned ( const long value, const unsigned char base ) {
+   if ( (value < 0) && (base == 10) ) {
+      return "-" + formatNumber((unsigned long)-value, base);
+   }
+   return formatNumber((unsigned long)value, base);
+}
+
+String::String ( unsigned char value, unsigned char base ) : s(formatNumber(value, base)) {}
+String::String ( int value, unsigned char base ) : s(formatSigned(value, base)) {}
+String::String ( unsigned int value, unsigned char base ) : s(formatNumber(value, base)) {}
+String::String ( long value, unsigned char base ) : s(formatSigned(value, base)) {}
+String::String ( unsigned long value, unsigned char base ) : s(formatNumber(value, base)) {}
+
+String::String ( float value, unsigned char decimalPlaces ) {
+   char buf[40];
+
+   s = dtostrf(value, decimalPlaces + 2, decimalPlaces, buf);
+}
+
+String::String ( double value, unsigned char decimalPlaces ) {
+   char buf[40];
+
+   s = dtostrf(value, decimalPlaces + 2, decimalPlaces, buf);
+}
+
+int String::indexOf ( char ch, unsigned int from ) const {
+   size_t found = s.find(ch, from);
+
+   return (found == std::string::npos) ? -1 : (int)found;
+}
+
+int String::indexOf ( const char *str, unsigned int from ) const {
+   size_t found = s.find(str, from);
+
+   return (found == std::string::npos) ? -1 : (int)found;
+}
+
+int String::lastIndexOf ( char ch ) const {
+   size_t found = s.rfind(ch);
+
+   return (found == std::string::npos) ? -1 : (int)found;
+}
+
+String String::substring ( unsigned int left, unsigned int right ) const {
+   if ( left > right ) {
+      std::swap(left, right);
+   }
+   if ( left >= s.length() ) {
+      return String();
+   }
+   return String(s.substr(left, min((size_t)right, s.length()) - left).c_str());
+}
+
+void String::replace ( const String &find, const String &replace ) {
+   size_t at = 0;
+
+   if ( find.s.empty() ) {
+      return;
+   }
+   while ( (at = s.find(find.s, at)) != std::string::npos ) {
+      s.replace(at, find.s.length(), replace.s);
+      at += replace.s.length();
+   }
+}
+
+void String::toLowerCase ( void ) {
+   for ( char &c : s ) {
+      c = (char)tolower((unsigned char)c);
+   }
+}
+
+void String::toUpperCase ( void ) {
+   for ( char &c : s ) {
+      c = (char)toupper((unsigned char)c);
+   }
+}
+
+void String::trim ( void ) {
+   size_t first = s.find_first_not_of(" \t\r\n");
+   size_t last = s.find_last_not_of(" \t\r\n");
+
+   s = (first == std::string::npos) ? std::string() : s.substr(first, last - first + 1);
+}
+
+bool String::endsWith ( const String &suffix ) const {
+   return (s.length() >= suffix.s.length()) && (s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0);
+}
+
+/*
+ Print
+*/
+size_t Print::write ( const uint8_t *buffer, size_t size ) {
+   size_t n = 0;
+
+   while ( size-- ) {
+      n += write(*buffer++);
+   }
+   return n;
+}
+
+size_t Print::print ( long value, int base ) {
+   return write(formatSigned(value, base).c_str());
+}
+
+size_t Print::print ( unsigned long value, int base ) {
+   return write(formatNumber(value, base).c_str());
+}
+
+size_t Print::print ( double value, int digits ) {
+   char buf[40];
+
+   snprintf(buf, sizeof(buf), "%.*f", digits, value);
+   return write(buf);
+}
+
+size_t Print::printf ( const char *format, ... ) {
+   char		buf[256];
+   va_list	args;
+
+   va_start(args, format);
+   vsnprintf(buf, sizeof(buf), format, args);
+   va_end(args);
+   return write(buf);
+}
+
+/*
+ Stream - reads wait up to the timeout on the virtual clock, as they do on the target
+*/
+int Stream::timedRead ( void ) {
+   unsigned long start = millis();
+
+   do {
+      if ( available() ) {
+         return read();
+      }
+      yield();
+   } while ( (millis() - start) < timeout );
+   return -1;
+}
+
+size_t Stream::readBytes ( char *buffer, size_t length ) {
+   size_t n = 0;
+
+   while ( n < length ) {
+      int c = timedRead();
+
+      if ( c < 0 ) {
+         break;
+      }
+      buffer[n++] = (char)c;
+   }
+   return n;
+}
+
+String Stream::readString ( void ) {
+   String	result;
+   int		c;
+
+   while ( (c = timedRead()) >= 0 ) {
+      result += (char)c;
+   }
+   return result;
+}
+
+String Stream::readStringUntil ( char terminator ) {
+   String	result;
+   int		c;
+
+   while ( ((c = timedRead()) >= 0) && (c != terminator) ) {
+      result += (char)c;
+   }
+   return result;
+}
+
+long Stream::parseInt ( void ) {
+   long	value = 0;
+   bool	negative = false;
+   int	c;
+
+   // skip to the first digit or sign, then take digits
+   while ( ((c = peek()) >= 0) && !isdigit(c) && (c != '-') ) {
+      read();
+   }
+   if ( c == '-' ) {
+      negative = true;
+      read();
+   }
+   while ( ((c = peek()) >= 0) && isdigit(c) ) {
+      value = (value * 10) + (c - '0');
+      read();
+   }
+   return negative ? -value : value;
+}
+
+/*
+ serial port
+*/
+size_t HardwareSerial::write ( uint8_t c ) {
+   return write(&c, 1);
+}
+
+size_t HardwareSerial::write ( const uint8_t *buffer, size_t size ) {
+   if ( serialEcho ) {
+      fwrite(buffer, 1, size, stdout);
+   }
+   return size;
+}
+
+void simSerialEcho ( const bool echo ) {
+   fflush(stdout);
+   serialEcho = echo;
+}
+
+/*
+ ESP
+*/
+uint32_t EspClass::getFreeHeap ( void ) {
+   return SIM_HEAP_FREE;
+}
+
+void EspClass::restart ( void ) {
+   printf("ESP.restart()\n");
+   exit(0);
+}
+
+/*
+ raw flash
+*/
+static std::vector<uint8_t> &flashSector ( const uint16_t sector ) {
+   std::vector<uint8_t> &data = flash[sector];
+
+   if ( data.empty() ) {
+      data.assign(SPI_FLASH_SEC_SIZE, 0xFF);
+   }
+   return data;
+}
+
+static bool flashRange ( const uint32_t address, const uint32_t size ) {
+   return ((address % 4) == 0) && ((size % 4) == 0) && (address <= SIM_FLASH_SIZE) && (size <= (SIM_FLASH_SIZE - address));
+}
+
+extern "C" SpiFlashOpResult spi_flash_erase_sector ( uint16_t sector ) {
+   if ( ((uint32_t)sector * SPI_FLASH_SEC_SIZE) >= SIM_FLASH_SIZE ) {
+      return SPI_FLASH_RESULT_ERR;
+   }
+   flashSector(sector).assign(SPI_FLASH_SEC_SIZE, 0xFF);
+   return SPI_FLASH_RESULT_OK;
+}
+
+extern "C" SpiFlashOpResult spi_flash_write ( uint32_t address, uint32_t *source, uint32_t size ) {
+   const uint8_t *p = (const uint8_t *)source;
+
+   if ( !flashRange(address, size) ) {
+      return SPI_FLASH_RESULT_ERR;
+   }
+   for ( uint32_t i = 0; i < size; i++, address++ ) {
+      flashSector(address / SPI_FLASH_SEC_SIZE)[address % SPI_FLASH_SEC_SIZE] &= p[i];		// bits can only be cleared
+   }
+   return SPI_FLASH_RESULT_OK;
+}
+
+extern "C" SpiFlashOpResult spi_flash_read ( uint32_t address, uint32_t *destination, uint32_t size ) {
+   uint8_t *p = (uint8_t *)destination;
+
+   if ( !flashRange(address, size) ) {
+      return SPI_FLASH_RESULT_ERR;
+   }
+   for ( uint32_t i = 0; i < size; i++, address++ ) {
+      p[i] = flashSector(address / SPI_FLASH_SEC_SIZE)[address % SPI_FLASH_SEC_SIZE];
+   }
+   return SPI_FLASH_RESULT_OK;
+}
+
+extern "C" void *umm_info ( void *ptr, int force ) {
+   (void)ptr;
+   (void)force;
+   ummHeapInfo.totalBlocks = 6000;
+   ummHeapInfo.freeBlocks = SIM_HEAP_FREE / 8;
+   ummHeapInfo.usedBlocks = ummHeapInfo.totalBlocks - ummHeapInfo.freeBlocks;
+   ummHeapInfo.maxFreeContiguousBlocks = ummHeapInfo.freeBlocks;
+   return NULL;
+}
+
+/*
+ miscellaneous
+*/
+long random ( long howbig ) {
+   if ( howbig <= 0 ) {
+      return 0;
+   }
+   randomState = (randomState * 1103515245UL) + 12345UL;					// repeatable between runs
+   return (long)((randomState >> 8) % (uint32_t)howbig);
+}
+
+long random ( long howsmall, long howbig ) {
+   return (howsmall >= howbig) ? howsmall : (howsmall + random(howbig - howsmall));
+}
+
+void randomSeed ( unsigned long seed ) {
+   randomState = (uint32_t)seed;
+}
+
+char *dtostrf ( double value, signed char width, unsigned char precision, char *buf ) {
+   sprintf(buf, "%*.*f", width, precision, value);
+   return buf;
+}
@@ -0,0 +1,192 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: WiFi, TCP connections and the SDK station config
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <deque>
+#include <ESP8266WiFi.h>
+extern "C" {
+#include <user_interface.h>
+}
+#include "Sim.h"
+
+ESP8266WiFiClass						WiFi;
+
+static std::deque<Sim_Connection>	backlog;						// connections not yet accepted by a WiFiServer
+static struct station_config			station;
+
+/*
+ client side
+*/
+Sim_Connection simConnect ( const uint16_t port ) {
+   Sim_Connection connection = std::make_shared<Sim_Socket>();
+
+   connection->port = port;
+   connection->serverRead = 0;
+   connection->window = SIM_SEND_WINDOW;
+   connection->unacked = 0;
+   connection->autoAck = true;
+   connection->clientOpen = true;
+   connection->serverOpen = true;
+   backlog.push_back(connection);
+   return connection;
+}
+
+void simSend ( Sim_Connection &connection, const std::string &data ) {
+   connection->toServer += data;
+}
+
+void simAck ( Sim_Connection &connection, const size_t bytes ) {
+   connection->unacked -= min(bytes, connection->unacked);
+}
+
+void simClose ( Sim_Connection &connection ) {
+   connection->clientOpen = false;
+}
+
+/*
+ server side
+*/
+WiFiClient WiFiServer::available ( void ) {
+   for ( std::deque<Sim_Connection>::iterator c = backlog.begin(); listening && (c != backlog.end()); ++c ) {
+      if ( (*c)->port == port ) {
+         WiFiClient client(*c);
+
+         backlog.erase(c);
+         return client;
+      }
+   }
+   return WiFiClient();
+}
+
+size_t WiFiClient::write ( const uint8_t *buffer, size_t size ) {
+   if ( !connected() ) {
+      return 0;
+   }
+   socket->toClient.append((const char *)buffer, size);
+   if ( !socket->autoAck ) {
+      socket->unacked += size;
+   }
+   return size;
+}
+
+int WiFiClient::available ( void ) {
+   return (socket && socket->serverOpen) ? (int)(socket->toServer.size() - socket->serverRead) : 0;
+}
+
+int WiFiClient::read ( void ) {
+   return available() ? (uint8_t)socket->toServer[socket->serverRead++] : -1;
+}
+
+int WiFiClient::read ( uint8_t *buffer, size_t size ) {
+   size_t n = min(size, (size_t)available());
+
+   if ( n ) {
+      memcpy(buffer, &socket->toServer[socket->serverRead], n);
+      socket->serverRead += n;
+   }
+   return (int)n;
+}
+
+int WiFiClient::peek ( void ) {
+   return available() ? (uint8_t)socket->toServer[socket->serverRead] : -1;
+}
+
+/*
+ still connected while the client has not closed, or has closed but left data to read - as on the target
+*/
+uint8_t WiFiClient::connected ( void ) {
+   return socket && socket->serverOpen && (socket->clientOpen || available());
+}
+
+void WiFiClient::stop ( void ) {
+   if ( socket ) {
+      socket->serverOpen = false;
+      socket.reset();
+   }
+}
+
+size_t WiFiClient::availableForWrite ( void ) {
+   if ( !connected() ) {
+      return 0;
+   }
+   return (socket->unacked < socket->window) ? (socket->window - socket->unacked) : 0;
+}
+
+/*
+ IPAddress
+*/
+String IPAddress::toString ( void ) const {
+   char buf[16];
+
+   sprintf(buf, "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+   return String(buf);
+}
+
+/*
+ WiFi
+*/
+uint8_t *ESP8266WiFiClass::softAPmacAddress ( uint8_t *mac ) {
+   static const uint8_t simMac[WL_MAC_ADDR_LENGTH] = { 0x5E, 0xCF, 0x7F, 0x01, 0x02, 0x03 };
+
+   memcpy(mac, simMac, WL_MAC_ADDR_LENGTH);
+   return mac;
+}
+
+String ESP8266WiFiClass::softAPmacAddress ( void ) {
+   uint8_t	mac[WL_MAC_ADDR_LENGTH];
+   char		buf[18];
+
+   softAPmacAddress(mac);
+   sprintf(buf, "%02X:%02X:%02X:%02X:%02X:%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+   return String(buf);
+}
+
+wl_status_t ESP8266WiFiClass::begin ( const char *ssid, const char *passphrase, int32_t channel, const uint8_t *bssid,
+                                      bool connect ) {
+   (void)ssid;
+   (void)passphrase;
+   (void)channel;
+   (void)bssid;
+   (void)connect;
+   return WL_NO_SSID_AVAIL;
+}
+
+bool ESP8266WiFiClass::softAP ( const char *ssid, const char *passphrase, int channel, int hidden ) {
+   (void)ssid;
+   (void)passphrase;
+   (void)channel;
+   (void)hidden;
+   return true;
+}
+
+bool ESP8266WiFiClass::config ( IPAddress ip, IPAddress gateway, IPAddress mask, IPAddress dns ) {
+   (void)ip;
+   (void)gateway;
+   (void)mask;
+   (void)dns;
+   return true;
+}
+
+void ESP8266WiFiClass::printDiag ( Print &p ) {
+   p.print(F("Mode: "));
+   p.println((int)wifiMode);
+   p.print(F("AP IP: "));
+   p.println(apIP);
+}
+
+extern "C" bool wifi_station_get_config ( struct station_config *config ) {
+   *config = station;
+   return true;
+}
+
+extern "C" bool wifi_station_set_config ( struct station_config *config ) {
+   station = *config;
+   return true;
+}
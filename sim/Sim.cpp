@@ -0,0 +1,566 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: virtual clock, interrupts, timer1, GPIO and Tickers
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <time.h>
+#include <algorithm>
+#include <vector>
+#include <Arduino.h>
+#include <Ticker.h>
+#include "Sim.h"
+
+#define NSEC_PER_CYCLE			12.5						// 80 MHz
+#define TIMER1_NSEC_DIV1		12.5
+#define TIMER1_NSEC_DIV16		200.0
+#define TIMER1_NSEC_DIV256		3200.0
+#define HOST_STALL_NSEC			100000					// longer between two clock reads: the host descheduled us
+
+// the sketch
+void setup(void);
+void loop(void);
+
+// clock
+static double		scale = 1.0;									// virtual nsec per host nsec
+static double		virtualNow = 0.0;							// virtual nsec at hostAnchor
+static uint64_t	hostAnchor = 0;
+
+// interrupt context: the handler's clock starts at the time the interrupt fell due
+static bool			masked = false;
+static bool			inInterrupt = false;
+static double		interruptDue = 0.0;
+static double		interruptEntry = 0.0;						// main clock when the handler was entered
+static double		interruptNanos = 0.0;						// time spent in handlers so far
+static double		maskedAt = 0.0;								// main clock when the sketch last disabled interrupts
+static double		unmaskedAt = 0.0;								// and when it enabled them again
+static double		handlerEnd = 0.0;								// the last handler's clock when it returned
+static uint32_t	interruptCount = 0;
+
+// timer1
+static struct {
+   void		(*handler)(void);
+   double	tickNsec;
+   bool		reload;
+   bool		enabled;
+   bool		armed;
+   double	due;
+   double	period;
+} timer1 = { nullptr, TIMER1_NSEC_DIV16, false, false, false, 0.0, 0.0 };
+
+// pins
+typedef struct {
+   uint8_t	mode;
+   uint8_t	latch;														// output register
+   uint8_t	external;													// level driven from outside (pullups, switches)
+   uint8_t	level;														// what the pin reads
+   uint32_t	risingEdges;
+   double	lastRise;													// time of the last rising edge
+   void		(*handler)(void);
+   int		edge;															// RISING, FALLING or CHANGE
+   bool		pending;
+   double	pendingAt;
+} Sim_Pin;
+
+// a simPinDriveAt() change still to come
+typedef struct {
+   double	at;
+   uint8_t	pin;
+   uint8_t	level;
+} Sim_Drive;
+
+static Sim_Pin					pins[SIM_PINS];
+static std::vector<Ticker *>	tickers;							// armed tickers
+static std::vector<Sim_Drive>	drives;							// in time order
+
+static uint64_t hostNanos ( void ) {
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/*
+ the main clock: virtual time so far plus the host time since the last read, scaled
+ no code in the sketch runs this long between clock reads, so a longer gap is the host's doing and is not charged
+*/
+static double mainClock ( void ) {
+   uint64_t host = hostNanos();
+
+   if ( hostAnchor == 0 ) {
+      hostAnchor = host;
+   }
+   virtualNow += (double)min(host - hostAnchor, (uint64_t)HOST_STALL_NSEC) * scale;
+   hostAnchor = host;
+   if ( scale == 0.0 ) {
+      virtualNow += NSEC_PER_CYCLE;									// busy waits must still end
+   }
+   return virtualNow;
+}
+
+/*
+ the clock seen by the code running now
+*/
+static double clockNow ( void ) {
+   double now = mainClock();
+
+   return inInterrupt ? (interruptDue + (now - interruptEntry)) : now;
+}
+
+/*
+ the earliest interrupt that can be taken, or a negative time if there is none
+*/
+static double nextInterrupt ( int8_t &pin ) {
+   double due = -1.0;
+
+   pin = -1;
+   if ( timer1.enabled && timer1.armed && timer1.handler ) {
+      due = timer1.due;
+   }
+   for ( uint8_t i = 0; i < SIM_PINS; i++ ) {
+      if ( pins[i].pending && ((due < 0.0) || (pins[i].pendingAt < due)) ) {
+         due = pins[i].pendingAt;
+         pin = i;
+      }
+   }
+   return due;
+}
+
+/*
+ the handler is entered when the interrupt falls due, unless the sketch had interrupts disabled then or another
+ handler was running: then it is entered when they were enabled again or that handler returned
+*/
+static void runInterrupt ( const double due, const int8_t pin ) {
+   void		(*handler)(void);
+   double	entry = due;
+
+   if ( pin >= 0 ) {
+      pins[pin].pending = false;
+      handler = pins[pin].handler;
+   } else {
+      handler = timer1.handler;
+      if ( timer1.reload ) {
+         timer1.due += timer1.period;
+      } else {
+         timer1.armed = false;
+      }
+   }
+   if ( (due >= maskedAt) && (due < unmaskedAt) ) {
+      entry = unmaskedAt;
+   }
+   entry = max(entry, handlerEnd);
+   inInterrupt = true;
+   masked = true;
+   interruptDue = entry;
+   interruptEntry = mainClock();
+   if ( handler ) {
+      handler();
+   }
+   handlerEnd = entry + (mainClock() - interruptEntry);
+   interruptNanos += mainClock() - interruptEntry;
+   ++interruptCount;
+   masked = false;
+   inInterrupt = false;
+}
+
+static void updatePin(const uint8_t pin, const double at);
+
+/*
+ apply the simPinDriveAt() changes due by the main clock time until - the pin changes whether or not its interrupt
+ can be taken yet
+*/
+static void drivePins ( const double until ) {
+   while ( !drives.empty() && (drives.front().at <= until) ) {
+      Sim_Drive drive = drives.front();
+
+      drives.erase(drives.begin());
+      pins[drive.pin].external = drive.level;
+      updatePin(drive.pin, drive.at);
+   }
+}
+
+/*
+ take every interrupt that has fallen due by the main clock time until, in order
+*/
+static void takeInterrupts ( const double until ) {
+   int8_t	pin;
+   double	due;
+
+   drivePins(until);
+   if ( masked || inInterrupt ) {
+      return;
+   }
+   while ( ((due = nextInterrupt(pin)) >= 0.0) && (due <= until) ) {
+      runInterrupt(due, pin);
+   }
+}
+
+/*
+ run the tickers that have fallen due, in order (system context)
+*/
+static void runTickers ( const double until ) {
+   while ( !inInterrupt ) {
+      Ticker *next = nullptr;
+
+      for ( Ticker *t : tickers ) {
+         if ( (double)t->due <= until && ((next == nullptr) || (t->due < next->due)) ) {
+            next = t;
+         }
+      }
+      if ( next == nullptr ) {
+         break;
+      }
+      next->fire();
+      if ( !next->active() ) {
+         next->detach();
+      }
+   }
+}
+
+/*
+ move the clock forward by nsec, taking the interrupts (and, in system context, the tickers) as they fall due
+*/
+static void advance ( const double nsec, const bool system ) {
+   double target = mainClock() + nsec;
+
+   drivePins(target);
+   while ( true ) {
+      int8_t	pin;
+      double	due = masked ? -1.0 : nextInterrupt(pin);
+      double	tick = -1.0;
+
+      if ( system ) {
+         for ( Ticker *t : tickers ) {
+            if ( (tick < 0.0) || ((double)t->due < tick) ) {
+               tick = (double)t->due;
+            }
+         }
+      }
+      if ( (due >= 0.0) && (due <= target) && ((tick < 0.0) || (due <= tick)) ) {
+         virtualNow = max(virtualNow, due);
+         runInterrupt(due, pin);
+      } else if ( (tick >= 0.0) && (tick <= target) ) {
+         virtualNow = max(virtualNow, tick);
+         runTickers(tick);
+      } else {
+         break;
+      }
+   }
+   virtualNow = max(virtualNow, target);
+}
+
+static double now ( void ) {
+   double t = clockNow();
+
+   takeInterrupts(mainClock());
+   return t;
+}
+
+uint64_t simNanos ( void ) {
+   return (uint64_t)clockNow();
+}
+
+void simAdvance ( const uint64_t usec ) {
+   advance((double)usec * 1000.0, true);
+}
+
+void simSetScale ( const double cpuScale ) {
+   mainClock();
+   scale = cpuScale;
+}
+
+double simScale ( void ) {
+   return scale;
+}
+
+uint64_t simInterruptNanos ( void ) {
+   return (uint64_t)interruptNanos;
+}
+
+uint32_t simInterrupts ( void ) {
+   return interruptCount;
+}
+
+void simSetup ( void ) {
+   for ( uint8_t i = 0; i < SIM_PINS; i++ ) {
+      pins[i].external = HIGH;											// the endstop switches have pullups
+      pins[i].level = HIGH;
+   }
+   setup();
+}
+
+/*
+ one pass of the core's main loop: loop(), then whatever the SDK has due
+*/
+void simLoop ( void ) {
+   loop();
+   yield();
+}
+
+/*
+ Arduino time functions
+*/
+unsigned long millis ( void ) {
+   return (unsigned long)(now() / 1000000.0);
+}
+
+unsigned long micros ( void ) {
+   return (unsigned long)(now() / 1000.0);
+}
+
+uint32_t EspClass::getCycleCount ( void ) {
+   return (uint32_t)(uint64_t)(now() / NSEC_PER_CYCLE);
+}
+
+void delay ( unsigned long msec ) {
+   advance((double)msec * 1000000.0, !inInterrupt);
+}
+
+void delayMicroseconds ( unsigned int usec ) {
+   advance((double)usec * 1000.0, false);
+}
+
+void yield ( void ) {
+   double t = mainClock();
+
+   takeInterrupts(t);
+   runTickers(t);
+}
+
+/*
+ interrupt masking
+*/
+static void maskInterrupts ( void ) {
+   if ( !masked ) {
+      maskedAt = mainClock();
+      takeInterrupts(maskedAt);										// those already due come first
+      masked = true;
+   }
+}
+
+static void unmaskInterrupts ( void ) {
+   if ( masked ) {
+      unmaskedAt = mainClock();
+      masked = false;
+   }
+   takeInterrupts(mainClock());
+}
+
+void noInterrupts ( void ) {
+   maskInterrupts();
+}
+
+void interrupts ( void ) {
+   if ( !inInterrupt ) {
+      unmaskInterrupts();
+   }
+}
+
+uint32_t xt_rsil ( const uint8_t level ) {
+   uint32_t ps = masked ? 15 : 0;
+
+   if ( level ) {
+      maskInterrupts();
+   }
+   return ps;
+}
+
+void xt_wsr_ps ( const uint32_t ps ) {
+   if ( inInterrupt ) {
+      return;
+   }
+   if ( ps ) {
+      maskInterrupts();
+   } else {
+      unmaskInterrupts();
+   }
+}
+
+/*
+ timer1
+*/
+void timer1_isr_init ( void ) {
+}
+
+void timer1_enable ( uint8_t divider, uint8_t intType, uint8_t reload ) {
+   (void)intType;
+   timer1.tickNsec = (divider == TIM_DIV1) ? TIMER1_NSEC_DIV1 : ((divider == TIM_DIV256) ? TIMER1_NSEC_DIV256 : TIMER1_NSEC_DIV16);
+   timer1.reload = (reload == TIM_LOOP);
+   timer1.enabled = true;
+}
+
+void timer1_disable ( void ) {
+   timer1.enabled = false;
+   timer1.armed = false;
+}
+
+void timer1_attachInterrupt ( void (*handler)(void) ) {
+   timer1.handler = handler;
+}
+
+void timer1_detachInterrupt ( void ) {
+   timer1.handler = nullptr;
+   timer1_disable();
+}
+
+void timer1_write ( uint32_t ticks ) {
+   timer1.period = ticks * timer1.tickNsec;
+   timer1.due = clockNow() + timer1.period;
+   timer1.armed = true;
+}
+
+/*
+ pins
+*/
+static void updatePin ( const uint8_t pin, const double at ) {
+   Sim_Pin	&p = pins[pin];
+   uint8_t	level = (p.mode == OUTPUT) ? p.latch : p.external;
+
+   if ( level == p.level ) {
+      return;
+   }
+   p.level = level;
+   if ( level == HIGH ) {
+      ++p.risingEdges;
+      p.lastRise = at;
+   }
+   if ( p.handler && ((p.edge == CHANGE) || ((p.edge == RISING) && (level == HIGH)) || ((p.edge == FALLING) && (level == LOW))) ) {
+      p.pending = true;
+      p.pendingAt = at;
+      takeInterrupts(mainClock());
+   }
+}
+
+void pinMode ( uint8_t pin, uint8_t mode ) {
+   if ( pin < SIM_PINS ) {
+      pins[pin].mode = (mode == OUTPUT) ? OUTPUT : INPUT;
+      updatePin(pin, clockNow());
+   }
+}
+
+void digitalWrite ( uint8_t pin, uint8_t value ) {
+   if ( pin < SIM_PINS ) {
+      pins[pin].latch = value ? HIGH : LOW;
+      updatePin(pin, clockNow());
+   }
+}
+
+int digitalRead ( uint8_t pin ) {
+   return (pin < SIM_PINS) ? pins[pin].level : LOW;
+}
+
+void attachInterrupt ( uint8_t pin, void (*handler)(void), int mode ) {
+   if ( pin < SIM_PINS ) {
+      pins[pin].handler = handler;
+      pins[pin].edge = mode;
+      pins[pin].pending = false;
+   }
+}
+
+void detachInterrupt ( uint8_t pin ) {
+   if ( pin < SIM_PINS ) {
+      pins[pin].handler = nullptr;
+      pins[pin].pending = false;
+   }
+}
+
+void simPinDrive ( const uint8_t pin, const uint8_t level ) {
+   if ( pin < SIM_PINS ) {
+      pins[pin].external = level ? HIGH : LOW;
+      updatePin(pin, clockNow());
+   }
+}
+
+void simPinDriveAt ( const uint8_t pin, const uint8_t level, const uint64_t at ) {
+   Sim_Drive drive = { (double)at, pin, (uint8_t)(level ? HIGH : LOW) };
+
+   if ( pin < SIM_PINS ) {
+      std::vector<Sim_Drive>::iterator i = drives.begin();
+
+      while ( (i != drives.end()) && (i->at <= drive.at) ) {
+         ++i;
+      }
+      drives.insert(i, drive);
+   }
+}
+
+uint8_t simPinLevel ( const uint8_t pin ) {
+   return (pin < SIM_PINS) ? pins[pin].level : LOW;
+}
+
+uint32_t simPinRisingEdges ( const uint8_t pin ) {
+   return (pin < SIM_PINS) ? pins[pin].risingEdges : 0;
+}
+
+uint64_t simPinLastRise ( const uint8_t pin ) {
+   return (pin < SIM_PINS) ? (uint64_t)pins[pin].lastRise : 0;
+}
+
+Sim_GPIO_Set	GPOS;
+Sim_GPIO_Clear	GPOC;
+Sim_GPIO16		GP16O;
+
+void Sim_GPIO_Set::operator= ( const uint32_t mask ) {
+   for ( uint8_t i = 0; i < 16; i++ ) {
+      if ( mask & (1UL << i) ) {
+         digitalWrite(i, HIGH);
+      }
+   }
+}
+
+void Sim_GPIO_Clear::operator= ( const uint32_t mask ) {
+   for ( uint8_t i = 0; i < 16; i++ ) {
+      if ( mask & (1UL << i) ) {
+         digitalWrite(i, LOW);
+      }
+   }
+}
+
+Sim_GPIO16::operator uint32_t() const {
+   return pins[16].latch;
+}
+
+Sim_GPIO16 &Sim_GPIO16::operator= ( const uint32_t value ) {
+   digitalWrite(16, value & 1);
+   return *this;
+}
+
+/*
+ Ticker
+*/
+void Ticker::arm ( const uint32_t msec, const uint32_t period, callback_t callback ) {
+   detach();
+   function = callback;
+   periodMsec = period;
+   due = (uint64_t)clockNow() + (uint64_t)msec * 1000000ULL;
+   armed = true;
+   tickers.push_back(this);
+}
+
+void Ticker::detach ( void ) {
+   std::vector<Ticker *>::iterator t = std::find(tickers.begin(), tickers.end(), this);
+
+   if ( t != tickers.end() ) {
+      tickers.erase(t);
+   }
+   armed = false;
+}
+
+/*
+ run the callback; a one-shot ticker is disarmed first, so the callback may arm it again
+*/
+void Ticker::fire ( void ) {
+   callback_t callback = function;
+
+   if ( periodMsec ) {
+      due += (uint64_t)periodMsec * 1000000ULL;
+   } else {
+      armed = false;
+   }
+   callback();
+}
@@ -0,0 +1,87 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation
+
+   The sketch runs unchanged on a Linux host against the shims in sim/shims. This is the control side used by the
+   benchmark and the tests: the virtual clock, the pins seen from outside the board and simulated HTTP clients.
+
+   Virtual clock
+      Virtual time advances as the sketch runs - host execution time multiplied by the CPU scale (1.0 == host speed;
+      raise it to approximate the 80 MHz L106, see bench.cpp) - and jumps forward with simAdvance() and delay().
+      With a scale of 0 it only moves on simAdvance() and delay() (plus one CPU cycle per clock read, so busy waits
+      still end), which makes a run repeatable.
+
+   Interrupts
+      timer1 and the GPIO edge interrupts are taken at the next clock read (micros(), millis(), ESP.getCycleCount()),
+      interrupts(), xt_wsr_ps(), yield() or delay() after they fall due, unless masked. The handler runs on a clock
+      that starts at the time the interrupt fell due, so timer1 keeps hardware timing however late the host takes it:
+      a step interrupt re-arms from its own due time, as the hardware timer does. An interrupt that falls due while the
+      sketch has interrupts disabled, or while another handler runs, is entered when they are enabled again or that
+      handler returns, so that latency shows in the step timing as it would on the target. simPinDriveAt() changes a
+      pin at a set time, so that its edge lands wherever the sketch happens to be (in the middle of an HTTP request,
+      say).
+
+   Tickers (SDK software timers) run in system context: from yield(), delay() and between loop() passes.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define SIM_PINS					17							// GPIO0-16
+#define SIM_SEND_WINDOW			2920						// lwIP TCP_SND_BUF (2 * MSS): free send space of an idle connection
+
+// virtual clock
+uint64_t		simNanos(void);
+void			simAdvance(const uint64_t usec);
+void			simSetScale(const double scale);
+double		simScale(void);
+uint64_t		simInterruptNanos(void);				// time spent in interrupt handlers so far
+uint32_t		simInterrupts(void);						// handlers run so far
+
+// the core's main loop: setup() once, then one loop() pass followed by the system tasks
+void			simSetup(void);
+void			simLoop(void);
+
+// pins as seen from outside the board
+void			simPinDrive(const uint8_t pin, const uint8_t level);	// level on an input pin (switch, pullup)
+void			simPinDriveAt(const uint8_t pin, const uint8_t level, const uint64_t at);	// the same at simNanos() time at
+uint8_t		simPinLevel(const uint8_t pin);
+uint32_t		simPinRisingEdges(const uint8_t pin);
+uint64_t		simPinLastRise(const uint8_t pin);								// simNanos() time of the last rising edge
+
+// serial output (on by default); the benchmark turns it off so the firmware's log does not mix with its report
+void			simSerialEcho(const bool echo);
+
+/*
+ one simulated TCP connection, shared by the client side (the test) and the WiFiClient copies in the sketch
+*/
+typedef struct {
+   uint16_t		port;
+   std::string	toServer;										// bytes sent by the client
+   size_t		serverRead;										// of which the sketch has read this many
+   std::string	toClient;										// bytes written by the sketch
+   size_t		window;											// free send space while nothing is unacknowledged
+   size_t		unacked;											// written by the sketch, not yet taken by the client
+   bool			autoAck;											// client takes everything at once (unacked stays 0)
+   bool			clientOpen;										// client has not closed its side
+   bool			serverOpen;										// sketch has not called stop()
+} Sim_Socket;
+
+typedef std::shared_ptr<Sim_Socket>	Sim_Connection;
+
+Sim_Connection	simConnect(const uint16_t port);							// queued for WiFiServer::available()
+void				simSend(Sim_Connection &connection, const std::string &data);
+void				simAck(Sim_Connection &connection, const size_t bytes);	// a slow reader takes some of its data
+void				simClose(Sim_Connection &connection);
+
+#endif
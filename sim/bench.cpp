@@ -0,0 +1,432 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: loop() and motion planner benchmark
+
+   Runs the sketch through a set of scenarios - parked and idle, video moves started through the web API at a slow and
+   at the full speed, a move while web pages are being served and a move that runs onto the far endstop - and reports
+   for each carriage state:
+      - the time per loop() iteration (average and worst case)
+      - the worst-case gap between motion FSM services while travelling
+      - the achieved step rate, counted from rising edges on the STEP pin, against targetSpeed; "peak" is the best
+        rate over a PEAK_WINDOW_MSEC window, which is what reaches targetSpeed once the ramp is done
+      - the step engine's step interval jitter (stepEngineJitter(), as the device's loop profile reports it), taken
+        over each PEAK_WINDOW_MSEC window of travel: the step interrupt keeps its timing however long loop() takes, so
+        only interrupts held off by the sketch or by another handler show here. The median window shows what the
+        sketch does on every pass; the worst also has the host preempting the sketch while interrupts are disabled
+
+   then the motion planner on its own: the time to build the plan for a set of moves (plannerBenchmark()'s, on the
+   device) and the step interrupt's average cost per step when the plan is run, for each ramp type - RAMP_CONSTANT is
+   the fixed interval stepping that runSpeed() polled for from loop() before the step engine; the interrupt's clock
+   reads go through the shims, so compare the ramp types rather than take the figure as the device's
+
+   The sketch is built with LOOP_PROFILE defined and this file supplies the profile hooks (Profile.cpp is not part of
+   the host build). Times are virtual (see Sim.h), so they depend on the CPU scale:
+
+      bench [-s scale]     virtual nsec per host nsec (default BENCH_SCALE, roughly the 80 MHz L106 on a desktop CPU)
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Mechanics.h"
+#include "Planner.h"
+#include "Profile.h"
+#include "StepEngine.h"
+#include "Sim.h"
+
+#define BENCH_SCALE				20.0						// default CPU scale
+#define BENCH_STATES				4							// one entry per CarriageMode value
+#define PEAK_WINDOW_MSEC		100						// step rate sampling window while travelling
+#define IDLE_MSEC					2000						// parked scenario length
+#define MOVE_TIMEOUT_MSEC		120000					// give up on a move that never parks
+#define HTTP_TIMEOUT_MSEC		2000
+#define ENDSTOP_HIT_MSEC		1500						// into the endstop scenario's move
+#define ENDSTOP_HOLD_MSEC		20							// switch held closed
+#define ENDSTOP_PIN			D4							// LIMIT_END in CamSlider.ino: the endstop away from the motor
+#define PLAN_RUNS					1000						// plans built per move, for the average
+#define LOAD_REQUEST_MSEC		50							// web load scenario: a page and a status request this often
+
+extern volatile CarriageMode	carriageState;
+extern float						targetSpeed;
+
+// statistics for a single carriage state over one scenario
+typedef struct {
+   uint32_t	iterations;
+   uint64_t	totalNanos;								// time spent in loop()
+   uint64_t	maxNanos;								// longest single iteration
+   uint64_t	maxPollGap;								// longest gap between consecutive motion FSM services
+   uint64_t	stateNanos;								// time in this state, loop() or not
+   uint32_t	edges;									// STEP pin rising edges
+   uint32_t	engineSteps;							// steps reported by the step engine (PROFILE_STEPS)
+   float		peakRate;								// best windowed step rate
+   float		targetSpeed;							// last requested speed (steps/sec)
+} Bench_Stats;
+
+static Bench_Stats	stats[BENCH_STATES];
+static uint64_t		loopStart = 0;						// simNanos() at the top of the current iteration
+static uint64_t		lastPoll = 0;						// simNanos() at the last FSM service (0 == none yet)
+static uint64_t		pollGap = 0;						// largest poll gap seen during the current iteration
+static uint32_t		stepCount = 0;
+static uint64_t		lastEnd = 0;						// simNanos() at the end of the previous iteration (0 == none yet)
+static uint32_t		lastEdges = 0;						// STEP pin edges at the end of the previous iteration
+static uint8_t			lastState = BENCH_STATES;
+static uint64_t		windowStart = 0;					// peak rate window
+static uint32_t		windowEdges = 0;
+static std::vector<uint32_t>	jitter;					// stepEngineJitter() for each travel window
+
+static const char *stateName ( const uint8_t state ) {
+   switch ( state ) {
+   case CARRIAGE_STOP:
+      return "STOP";
+
+   case CARRIAGE_TRAVEL:
+      return "TRAVEL";
+
+   case CARRIAGE_TRAVEL_REVERSE:
+      return "REVERSE";
+
+   case CARRIAGE_PARKED:
+      return "PARKED";
+
+   default:
+      return "?";
+   }
+}
+
+/*
+ profile hooks (see Profile.h)
+*/
+void profileLoopStart ( void ) {
+   loopStart = simNanos();
+   pollGap = 0;
+   stepCount = 0;
+}
+
+void profilePoll ( void ) {
+   uint64_t now = simNanos();
+
+   if ( lastPoll && ((now - lastPoll) > pollGap) ) {
+      pollGap = now - lastPoll;
+   }
+   lastPoll = now;
+}
+
+void profileSteps ( const int steps ) {
+   if ( steps > 0 ) {
+      stepCount += steps;
+   }
+}
+
+void profileLoopEnd ( const CarriageMode state, const float speed ) {
+   uint64_t	now = simNanos();
+   uint32_t	edges = simPinRisingEdges(STEP_PIN);
+
+   if ( state < BENCH_STATES ) {
+      Bench_Stats *s = &stats[state];
+      uint64_t elapsed = now - loopStart;
+
+      ++s->iterations;
+      s->totalNanos += elapsed;
+      s->maxNanos = max(s->maxNanos, elapsed);
+      s->maxPollGap = max(s->maxPollGap, pollGap);
+      s->stateNanos += lastEnd ? (now - lastEnd) : elapsed;	// includes the system tasks between passes
+      s->edges += edges - lastEdges;
+      s->engineSteps += stepCount;
+      s->targetSpeed = speed;
+      if ( state == CARRIAGE_TRAVEL ) {
+         if ( state != lastState ) {
+            windowStart = now;
+            windowEdges = edges;
+            stepEngineJitter(true);
+         } else if ( (now - windowStart) >= (PEAK_WINDOW_MSEC * 1000000ULL) ) {
+            s->peakRate = max(s->peakRate, (float)((edges - windowEdges) * 1e9 / (double)(now - windowStart)));
+            jitter.push_back(stepEngineJitter(true));
+            windowStart = now;
+            windowEdges = edges;
+         }
+      }
+   }
+   if ( state != CARRIAGE_TRAVEL ) {
+      // gap measurement only makes sense between polls of the same move
+      lastPoll = 0;
+   }
+   lastState = state;
+   lastEnd = now;
+   lastEdges = edges;
+}
+
+static void report ( const char *scenario ) {
+   printf("\n%s\n", scenario);
+   printf("  %-8s %9s %9s %9s %11s %9s %9s %9s %9s\n", "state", "loops", "avg us", "max us", "poll gap us", "steps",
+      "rate", "peak", "target");
+   for ( uint8_t i = 0; i < BENCH_STATES; i++ ) {
+      Bench_Stats *s = &stats[i];
+
+      if ( s->iterations == 0 ) {
+         continue;
+      }
+      printf("  %-8s %9u %9.2f %9.2f", stateName(i), (unsigned int)s->iterations, s->totalNanos / 1000.0 / s->iterations,
+         s->maxNanos / 1000.0);
+      if ( (i == CARRIAGE_TRAVEL) || (i == CARRIAGE_TRAVEL_REVERSE) ) {
+         // a pass that ends a move is charged to the state it ends in, so the step figures are only for travel
+         printf(" %11.2f %9u %9.1f %9.1f %9.1f", s->maxPollGap / 1000.0, (unsigned int)s->edges,
+            s->stateNanos ? (s->edges * 1e9 / (double)s->stateNanos) : 0.0, s->peakRate, s->targetSpeed);
+         if ( s->edges != s->engineSteps ) {
+            printf("  (step engine counted %u)", (unsigned int)s->engineSteps);
+         }
+      }
+      printf("\n");
+   }
+   if ( !jitter.empty() ) {
+      std::sort(jitter.begin(), jitter.end());
+      printf("  step interval jitter over %u windows: median %u us, worst %u us\n", (unsigned int)jitter.size(),
+         (unsigned int)jitter[jitter.size() / 2], (unsigned int)jitter.back());
+   }
+   memset(stats, 0, sizeof(stats));
+   jitter.clear();
+}
+
+/*
+ start a scenario: discard what came before it
+*/
+static void resetStats ( void ) {
+   memset(stats, 0, sizeof(stats));
+   jitter.clear();
+}
+
+/*
+ run loop() passes for msec of virtual time, or until done() returns true
+*/
+static bool runFor ( const uint32_t msec, bool (*done)(void) ) {
+   uint64_t end = simNanos() + (uint64_t)msec * 1000000ULL;
+
+   while ( simNanos() < end ) {
+      simLoop();
+      if ( done && done() ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+static Sim_Connection	http;
+
+static bool httpDone ( void ) {
+   return !http->serverOpen;
+}
+
+/*
+ one HTTP exchange; returns the status code, or 0 if there was no complete response
+*/
+static int httpRequest ( const char *method, const char *path, const char *body ) {
+   char request[512];
+
+   snprintf(request, sizeof(request), "%s %s HTTP/1.1\r\nHost: slider\r\nConnection: close\r\nContent-Type: application/json\r\n"
+      "Content-Length: %u\r\n\r\n%s", method, path, (unsigned int)strlen(body), body);
+   http = simConnect(80);
+   simSend(http, request);
+   if ( !runFor(HTTP_TIMEOUT_MSEC, httpDone) || (http->toClient.compare(0, 9, "HTTP/1.1 ") != 0) ) {
+      return 0;
+   }
+   return atoi(http->toClient.c_str() + 9);
+}
+
+static bool parked ( void ) {
+   return carriageState == CARRIAGE_PARKED;
+}
+
+static bool startMove ( const unsigned int inches, const unsigned int seconds, const char *direction ) {
+   char	body[128];
+   int	status;
+
+   snprintf(body, sizeof(body), "{\"distance\":%u,\"duration\":%u,\"direction\":\"%s\",\"action\":\"start\"}", inches, seconds,
+      direction);
+   status = httpRequest("POST", "/api/move", body);
+   if ( status != 200 ) {
+      printf("POST /api/move %s: %d\n%s\n", body, status, http ? http->toClient.c_str() : "");
+      return false;
+   }
+   return true;
+}
+
+static bool moveScenario ( const char *name, const unsigned int inches, const unsigned int seconds ) {
+   resetStats();														// discard the HTTP exchanges before the move
+   if ( !startMove(inches, seconds, "away") ) {
+      return false;
+   }
+   if ( !runFor(MOVE_TIMEOUT_MSEC, parked) ) {
+      printf("%s: carriage did not park\n", name);
+      return false;
+   }
+   runFor(100, nullptr);											// a few parked passes after the move
+   report(name);
+   return true;
+}
+
+/*
+ a move while a browser keeps asking for the page and the status, each on a connection of its own
+*/
+static bool loadScenario ( const char *name, const unsigned int inches, const unsigned int seconds ) {
+   std::vector<Sim_Connection>	clients;
+   uint64_t							next = 0;
+   int									answered = 0;
+
+   resetStats();
+   if ( !startMove(inches, seconds, "away") ) {
+      return false;
+   }
+   while ( !parked() ) {
+      if ( simNanos() >= next ) {
+         const char *requests[] = { "GET / HTTP/1.1\r\nHost: slider\r\nConnection: close\r\n\r\n",
+            "GET /api/status HTTP/1.1\r\nHost: slider\r\nConnection: close\r\n\r\n" };
+
+         for ( const char *request : requests ) {
+            clients.push_back(simConnect(80));
+            simSend(clients.back(), request);
+         }
+         next = simNanos() + (LOAD_REQUEST_MSEC * 1000000ULL);
+      }
+      simLoop();
+      if ( clients.size() > (2 * MOVE_TIMEOUT_MSEC / LOAD_REQUEST_MSEC) ) {
+         printf("%s: carriage did not park\n", name);
+         return false;
+      }
+   }
+   runFor(HTTP_TIMEOUT_MSEC, nullptr);							// the last requests
+   for ( Sim_Connection &c : clients ) {
+      answered += (c->toClient.compare(0, 12, "HTTP/1.1 200") == 0);
+   }
+   report(name);
+   printf("  %d of %u requests answered\n", answered, (unsigned int)clients.size());
+   return true;
+}
+
+static bool endstopScenario ( const char *name ) {
+   resetStats();
+   if ( !startMove(24, 10, "away") ) {
+      return false;
+   }
+   runFor(ENDSTOP_HIT_MSEC, nullptr);
+   simPinDrive(ENDSTOP_PIN, LOW);
+   runFor(ENDSTOP_HOLD_MSEC, nullptr);
+   simPinDrive(ENDSTOP_PIN, HIGH);
+   if ( !runFor(MOVE_TIMEOUT_MSEC, parked) ) {
+      printf("%s: carriage did not park\n", name);
+      return false;
+   }
+   runFor(100, nullptr);
+   report(name);
+   return true;
+}
+
+static const char *rampName ( const RampType type ) {
+   switch ( type ) {
+   case RAMP_CONSTANT:
+      return "constant";
+
+   case RAMP_TRAPEZOID:
+      return "trapezoid";
+
+   case RAMP_SCURVE:
+      return "S-curve";
+
+   default:
+      return "?";
+   }
+}
+
+/*
+ planning cost per move and step interrupt cost per step
+ runs the step engine directly, so the carriage must be parked
+*/
+static void plannerScenario ( void ) {
+   static Motion_Plan	plan;
+   const struct {
+      const char	*name;
+      uint32_t		steps;
+      float			speed;
+      RampType		type;
+   } moves[] = {
+      { "12 in, full speed", (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_CONSTANT },
+      { "12 in, full speed", (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_TRAPEZOID },
+      { "12 in, full speed", (uint32_t)mechInchesToSteps(12), mechMaxSpeed(), RAMP_SCURVE },
+      { "1 in timelapse move", (uint32_t)mechInchesToSteps(1), mechMaxSpeed(), RAMP_SCURVE },
+      { "full length, 0.5 in/sec", (uint32_t)mechInchesToSteps(mechMaxTravel()), mechInchesToSteps(1) / 2.0f, RAMP_SCURVE },
+   };
+
+   printf("\nmotion planner\n");
+   printf("  %-24s %-9s %9s %9s %9s %9s %9s\n", "move", "ramp", "steps", "plan us", "entries", "move ms", "step us");
+   for ( uint8_t i = 0; i < sizeof(moves) / sizeof(moves[0]); i++ ) {
+      uint64_t	planNanos = 0;
+      uint64_t	isrNanos;
+      uint32_t	isrCount;
+      uint32_t	steps;
+
+      // each build timed on its own: the virtual clock only charges so much host time between two reads
+      for ( int n = 0; n < PLAN_RUNS; n++ ) {
+         uint64_t start = simNanos();
+
+         plannerBuild(plan, moves[i].steps, moves[i].speed, mechAccel(), moves[i].type);
+         planNanos += simNanos() - start;
+      }
+
+      // only the step interrupt runs while the move does
+      isrNanos = simInterruptNanos();
+      isrCount = simInterrupts();
+      stepEngineStart(plan, true);
+      while ( stepEngineRunning() ) {
+         delay(1);
+      }
+      stepEngineDone();
+      steps = stepEngineSteps();
+      isrNanos = simInterruptNanos() - isrNanos;
+      isrCount = simInterrupts() - isrCount;
+
+      printf("  %-24s %-9s %9u %9.2f %9u %9u %9.2f", moves[i].name, rampName(moves[i].type), (unsigned int)moves[i].steps,
+         planNanos / 1000.0 / PLAN_RUNS, (unsigned int)plan.entries, (unsigned int)plan.durationMsec,
+         isrCount ? (isrNanos / 1000.0 / isrCount) : 0.0);
+      if ( (steps != moves[i].steps) || (isrCount != steps) ) {
+         printf("  (%u steps, %u interrupts)", (unsigned int)steps, (unsigned int)isrCount);
+      }
+      printf("\n");
+   }
+}
+
+int main ( int argc, char *argv[] ) {
+   double	cpuScale = BENCH_SCALE;
+   bool		ok = true;
+   int		opt;
+
+   while ( (opt = getopt(argc, argv, "s:")) != -1 ) {
+      if ( opt == 's' ) {
+         cpuScale = atof(optarg);
+      }
+   }
+   if ( cpuScale <= 0.0 ) {
+      fprintf(stderr, "usage: %s [-s scale]   (scale > 0: virtual nsec per host nsec)\n", argv[0]);
+      return 2;
+   }
+   simSetScale(cpuScale);
+   simSerialEcho(false);
+   simSetup();
+
+   printf("loop() benchmark, CPU scale %.1f (times are virtual)\n", cpuScale);
+   runFor(IDLE_MSEC, nullptr);
+   report("parked, idle");
+   ok = ok && moveScenario("video move: 6 in over 20 sec", 6, 20);
+   ok = ok && moveScenario("video move: 12 in at full speed", 12, 1);
+   ok = ok && loadScenario("video move: 6 in over 10 sec, serving the page and status every 50 ms", 6, 10);
+   ok = ok && endstopScenario("video move onto the far endstop");
+   if ( ok ) {
+      plannerScenario();
+   }
+   return ok ? 0 : 1;
+}
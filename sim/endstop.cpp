@@ -0,0 +1,218 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: endstop under HTTP load test
+
+   The endstop interrupt stops step generation itself, so a switch that closes while loop() is busy with a request
+   must not let the carriage keep stepping until the motion FSM gets back to it. Each run starts a move through the
+   web API, floods the server with requests and closes the far endstop part way through:
+      - no step may follow the edge by more than ENDSTOP_HALT_USEC
+      - every flood request must still get its response and the carriage must stop
+
+   The edge is placed at a different point of the flood on each run; at least half of the runs must have it land
+   inside a loop() pass rather than between two. Times are virtual (see Sim.h); the CPU scale is
+   the benchmark's:
+
+      endstop [-s scale]
+
+   Exits non-zero if any check fails.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <unistd.h>
+#include <vector>
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Profile.h"
+#include "Sim.h"
+
+#define TEST_SCALE				20.0						// default CPU scale (as the benchmark)
+#define ENDSTOP_PIN			D4							// LIMIT_END in CamSlider.ino: the endstop away from the motor
+#define ENDSTOP_HALT_USEC		20							// switch edge to the last step (the endstop ISR entry)
+#define ENDSTOP_HOLD_MSEC		20							// switch held closed
+#define ENDSTOP_RUNS				6
+#define FLOOD_CLIENTS			4							// connections opened at once
+#define FLOOD_HEADERS			100						// header lines in each flood request
+#define TRAVEL_MSEC				500						// into the move before the flood
+#define DEBOUNCE_MSEC			400						// longer than the sketch's BOUNCE_DELAY
+#define RUN_TIMEOUT_MSEC		5000
+#define HTTP_TIMEOUT_MSEC		2000
+
+extern volatile CarriageMode	carriageState;
+
+static int			failures = 0;
+static int			inPass = 0;									// runs with the edge inside a loop() pass
+static uint64_t	passStart = 0;								// simNanos() at the top of the current loop() pass
+static uint64_t	edgeAt = 0;									// simNanos() time the switch closes (0 == not this run)
+static uint64_t	edgePass = 0;								// length of the pass the edge fell in (0 == between passes)
+
+/*
+ profile hooks (see Profile.h): only the pass boundaries are needed
+*/
+void profileLoopStart ( void ) {
+   passStart = simNanos();
+}
+
+void profileLoopEnd ( const CarriageMode state, const float speed ) {
+   uint64_t now = simNanos();
+
+   (void)state;
+   (void)speed;
+   if ( edgeAt && (edgeAt >= passStart) && (edgeAt <= now) ) {
+      edgePass = now - passStart;
+   }
+}
+
+void profilePoll ( void ) {}
+void profileSteps ( const int steps ) { (void)steps; }
+
+static void check ( const bool ok, const char *what ) {
+   printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+   if ( !ok ) {
+      ++failures;
+   }
+}
+
+/*
+ run loop() passes for msec of virtual time, or until done() returns true
+*/
+static bool runFor ( const uint32_t msec, bool (*done)(void) ) {
+   uint64_t end = simNanos() + (uint64_t)msec * 1000000ULL;
+
+   while ( simNanos() < end ) {
+      simLoop();
+      if ( done && done() ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+static std::vector<Sim_Connection>	clients;
+
+/*
+ true once the server has closed every client connection
+*/
+static bool served ( void ) {
+   for ( Sim_Connection &c : clients ) {
+      if ( c->serverOpen ) {
+         return false;
+      }
+   }
+   return true;
+}
+
+static bool stopped ( void ) {
+   return served() && (carriageState != CARRIAGE_TRAVEL);
+}
+
+static bool parked ( void ) {
+   return carriageState == CARRIAGE_PARKED;
+}
+
+static bool startMove ( void ) {
+   const char		*body = "{\"distance\":24,\"duration\":10,\"direction\":\"away\",\"action\":\"start\"}";
+   char				request[512];
+   Sim_Connection	http;
+
+   snprintf(request, sizeof(request), "POST /api/move HTTP/1.1\r\nHost: slider\r\nConnection: close\r\n"
+      "Content-Type: application/json\r\nContent-Length: %u\r\n\r\n%s", (unsigned int)strlen(body), body);
+   http = simConnect(80);
+   simSend(http, request);
+   clients.assign(1, http);
+   return runFor(HTTP_TIMEOUT_MSEC, served) && (http->toClient.compare(0, 12, "HTTP/1.1 200") == 0);
+}
+
+/*
+ FLOOD_CLIENTS requests with FLOOD_HEADERS header lines each, all available at once
+*/
+static void flood ( void ) {
+   std::string text = "GET /api/status HTTP/1.1\r\nHost: slider\r\nConnection: close\r\n";
+
+   for ( int i = 0; i < FLOOD_HEADERS; i++ ) {
+      text += "X-Padding: 0123456789abcdef0123456789abcdef\r\n";
+   }
+   text += "\r\n";
+   clients.clear();
+   for ( int i = 0; i < FLOOD_CLIENTS; i++ ) {
+      Sim_Connection connection = simConnect(80);
+
+      simSend(connection, text);
+      clients.push_back(connection);
+   }
+}
+
+/*
+ one move onto the far endstop, the switch closing offset usec into the flood
+*/
+static void endstopRun ( const uint32_t offset ) {
+   uint32_t	steps;
+   bool		travelling;
+   uint64_t	lastStep;
+   int		answered = 0;
+   char		what[96];
+
+   edgeAt = 0;
+   edgePass = 0;
+   if ( !startMove() ) {
+      check(false, "move started through the web API");
+      return;
+   }
+   steps = simPinRisingEdges(STEP_PIN);
+   runFor(TRAVEL_MSEC, nullptr);
+   travelling = (carriageState == CARRIAGE_TRAVEL) && (simPinRisingEdges(STEP_PIN) > steps);
+
+   flood();
+   edgeAt = simNanos() + (uint64_t)offset * 1000ULL;
+   simPinDriveAt(ENDSTOP_PIN, LOW, edgeAt);
+   simPinDriveAt(ENDSTOP_PIN, HIGH, edgeAt + ENDSTOP_HOLD_MSEC * 1000000ULL);
+   runFor(RUN_TIMEOUT_MSEC, stopped);
+   lastStep = simPinLastRise(STEP_PIN);
+   for ( Sim_Connection &c : clients ) {
+      answered += (c->toClient.compare(0, 12, "HTTP/1.1 200") == 0);
+   }
+
+   printf("edge %u us into the flood: pass %.2f us, last step %.2f us %s the edge\n", (unsigned int)offset,
+      edgePass / 1000.0, ((lastStep > edgeAt) ? (lastStep - edgeAt) : (edgeAt - lastStep)) / 1000.0,
+      (lastStep > edgeAt) ? "after" : "before");
+   check(travelling, "carriage stepping when the flood started");
+   snprintf(what, sizeof(what), "no step more than %u us after the switch closed", ENDSTOP_HALT_USEC);
+   check(lastStep <= (edgeAt + ENDSTOP_HALT_USEC * 1000ULL), what);
+   check((answered == FLOOD_CLIENTS) && (carriageState != CARRIAGE_TRAVEL), "flood answered and carriage stopped");
+   inPass += (edgePass > 0);
+
+   // back off the switch for the next run
+   runFor(RUN_TIMEOUT_MSEC, parked);
+   runFor(DEBOUNCE_MSEC, nullptr);
+   edgeAt = 0;
+}
+
+int main ( int argc, char *argv[] ) {
+   double	cpuScale = TEST_SCALE;
+   int		opt;
+
+   while ( (opt = getopt(argc, argv, "s:")) != -1 ) {
+      if ( opt == 's' ) {
+         cpuScale = atof(optarg);
+      }
+   }
+   if ( cpuScale <= 0.0 ) {
+      fprintf(stderr, "usage: %s [-s scale]   (scale > 0: virtual nsec per host nsec)\n", argv[0]);
+      return 2;
+   }
+   simSetScale(cpuScale);
+   simSerialEcho(false);
+   simSetup();
+
+   // spread the edge over the flood, off any multiple of the step period
+   for ( uint32_t i = 0; i < ENDSTOP_RUNS; i++ ) {
+      endstopRun(137 + (i * 1931));
+   }
+   check(inPass >= (ENDSTOP_RUNS / 2), "edge inside a loop() pass on half the runs or more");
+   printf("%s (%d failed)\n", failures ? "FAILED" : "OK", failures);
+   return failures ? 1 : 0;
+}
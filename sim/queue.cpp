@@ -0,0 +1,192 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: command queue test
+
+   The host version of motionQueueTest() in CamSlider.ino (DEBUG >= 4 on the device):
+      - a 20 kHz timer1 interrupt pushes a numbered sequence into an SPSCQueue while a loop() style consumer pops it,
+        sometimes fast enough to keep up and sometimes not, so the ring wraps and overflows many times; every number
+        that was accepted must come out exactly once and in order, and dropped must count every refused push
+      - the consumer's item copies take up to two producer periods of virtual time half way through, so the interrupt
+        is taken in the middle of pop() (between reading the slot and releasing it) as well as between pops; a slot
+        overwritten while it is read shows up as a torn item
+      - through the motion interface: with the FSM not running, the web command queue takes MOTION_QUEUE_SIZE - 1
+        commands, refuses and counts the next one, and motionApply() applies the accepted ones in order
+
+   Times are virtual (see Sim.h); the CPU scale is the benchmark's:
+
+      queue [-s scale]
+
+   Exits non-zero if any check fails.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <unistd.h>
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Motion.h"
+#include "Profile.h"
+#include "SPSCQueue.h"
+#include "StepEngine.h"
+#include "Sim.h"
+
+#define TEST_SCALE				20.0						// default CPU scale (as the benchmark)
+#define PRODUCER_HZ				20000						// timer1 interrupt rate (as motionQueueTest())
+#define CONSUMER_DELAY_USEC	500						// consumer pauses up to this long between drains
+#define COPY_DELAY_USEC			(2000000 / PRODUCER_HZ)	// a consumer item copy takes up to this long
+#define QUEUE_TEST_MSEC			1000
+
+extern SPSCQueue<Motion_Command, MOTION_QUEUE_SIZE>	webCommands;
+
+static int failures = 0;
+
+// the host build has LOOP_PROFILE defined for the benchmark; nothing is profiled here
+void profileLoopStart ( void ) {}
+void profileLoopEnd ( const CarriageMode state, const float speed ) { (void)state; (void)speed; }
+void profilePoll ( void ) {}
+void profileSteps ( const int steps ) { (void)steps; }
+
+static void check ( const bool ok, const char *what ) {
+   printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+   if ( !ok ) {
+      ++failures;
+   }
+}
+
+static volatile bool producing = false;							// in the interrupt handler
+
+/*
+ a queue item that, copied by the consumer, takes the interrupts that fall due half way through the copy
+*/
+struct Queue_Item {
+   uint32_t	sequence;
+   uint32_t	inverse;													// ~sequence: a torn copy does not match
+
+   Queue_Item &operator= ( const Queue_Item &item ) {
+      sequence = item.sequence;
+      if ( !producing ) {
+         delayMicroseconds(random(0, COPY_DELAY_USEC));
+      }
+      inverse = item.inverse;
+      return *this;
+   }
+};
+
+static SPSCQueue<Queue_Item, MOTION_QUEUE_SIZE>	queue;
+static volatile uint32_t								sent = 0;			// accepted pushes
+static volatile uint32_t								attempts = 0;
+
+static void producer ( void ) {
+   Queue_Item item;
+
+   producing = true;
+   item.sequence = sent;
+   item.inverse = ~sent;
+   ++attempts;
+   if ( queue.push(item) ) {
+      ++sent;
+   }
+   producing = false;
+}
+
+/*
+ pop everything queued, checking the order and that no item was torn
+*/
+static void drain ( uint32_t &expected, uint32_t &received, uint32_t &outOfOrder, uint32_t &torn ) {
+   Queue_Item item;
+
+   while ( queue.pop(item) ) {
+      if ( item.inverse != ~item.sequence ) {
+         ++torn;
+      }
+      if ( item.sequence != expected ) {
+         ++outOfOrder;
+      }
+      expected = item.sequence + 1;
+      ++received;
+   }
+}
+
+static void testQueue ( void ) {
+   uint32_t			expected = 0;
+   uint32_t			received = 0;
+   uint32_t			outOfOrder = 0;
+   uint32_t			torn = 0;
+   unsigned long	start = millis();
+
+   timer1_isr_init();
+   timer1_attachInterrupt(producer);
+   timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+   timer1_write(STEP_TIMER_HZ / PRODUCER_HZ);
+   while ( (millis() - start) < QUEUE_TEST_MSEC ) {
+      drain(expected, received, outOfOrder, torn);
+      delayMicroseconds(random(0, CONSUMER_DELAY_USEC));		// sometimes fast enough to keep up, sometimes not
+   }
+   timer1_disable();
+   timer1_detachInterrupt();
+   drain(expected, received, outOfOrder, torn);
+
+   printf("queue: %u pushed, %u accepted, %u received, %u refused, %u out of order, %u torn\n", (unsigned int)attempts,
+      (unsigned int)sent, (unsigned int)received, (unsigned int)queue.lost(), (unsigned int)outOfOrder, (unsigned int)torn);
+   check((received == sent) && (outOfOrder == 0), "every accepted item received once, in order");
+   check(torn == 0, "no slot overwritten while it was read");
+   check(queue.lost() == (attempts - sent), "dropped counts every refused push");
+   check((queue.lost() > 0) && (received > (100 * MOTION_QUEUE_SIZE)), "queue wrapped and overflowed");
+}
+
+/*
+ through the motion interface: fill the web queue while the FSM is not running, then apply it
+*/
+static void testMotion ( void ) {
+   Motion_Command	command = { CMD_SET_PARAMS };
+   uint16_t			lost;
+   bool				accepted = true;
+
+   simSetup();
+   motionApply();
+   lost = webCommands.lost();
+   for ( long i = 1; i < MOTION_QUEUE_SIZE; i++ ) {
+      command.position = i;
+      command.speed = (float)i;
+      accepted = accepted && motionCommand(command);
+   }
+   command.position = MOTION_QUEUE_SIZE;
+   check(accepted && !motionCommand(command), "web queue takes MOTION_QUEUE_SIZE - 1 commands and refuses the next");
+   check(webCommands.lost() == (uint16_t)(lost + 1), "refused command counted");
+
+   motionApply();
+   check(webCommands.empty() && (motionStatus().targetPosition == (MOTION_QUEUE_SIZE - 1)) &&
+      (motionStatus().targetSpeed == (float)(MOTION_QUEUE_SIZE - 1)), "accepted commands applied in order");
+   command.type = CMD_SET_DIRECTION;
+   command.clockwise = !motionStatus().clockwise;
+   check(motionCommand(command), "web queue accepts again once applied");
+   motionApply();
+   check(motionStatus().clockwise == command.clockwise, "command applied after the overflow");
+}
+
+int main ( int argc, char *argv[] ) {
+   double	cpuScale = TEST_SCALE;
+   int		opt;
+
+   while ( (opt = getopt(argc, argv, "s:")) != -1 ) {
+      if ( opt == 's' ) {
+         cpuScale = atof(optarg);
+      }
+   }
+   if ( cpuScale <= 0.0 ) {
+      fprintf(stderr, "usage: %s [-s scale]   (scale > 0: virtual nsec per host nsec)\n", argv[0]);
+      return 2;
+   }
+   simSetScale(cpuScale);
+   simSerialEcho(false);
+
+   // timer1 is the step engine's once the sketch is set up, so the queue test goes first
+   testQueue();
+   testMotion();
+   printf("%s (%d failed)\n", failures ? "FAILED" : "OK", failures);
+   return failures ? 1 : 0;
+}
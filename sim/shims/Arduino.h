@@ -0,0 +1,293 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: Arduino core
+
+   Just enough of the ESP8266 Arduino core (2.3) for the sketch to build and run on a Linux host. Time comes from
+   the virtual clock in Sim.h, which also emulates the interrupts, timer1 and the GPIO registers.
+
+   Differences from the target that matter when reading results:
+      long is 64 bits here, so millis() and micros() do not wrap in a simulation run
+      PROGMEM is ordinary memory and the _P functions are the plain ones
+      interrupts are taken at the next clock read, yield() or interrupts() after they fall due (see Sim.h)
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <math.h>
+#include <ctype.h>
+#include <algorithm>
+#include <string>
+
+typedef uint8_t	byte;
+typedef bool		boolean;
+
+#define HIGH						1
+#define LOW							0
+#define INPUT						0
+#define OUTPUT						1
+#define INPUT_PULLUP				2
+#define RISING						1
+#define FALLING					2
+#define CHANGE						3
+
+// WeMos D1 mini pin names
+#define D0							16
+#define D1							5
+#define D2							4
+#define D3							0
+#define D4							2
+#define D5							14
+#define D6							12
+#define D7							13
+#define D8							15
+
+#define F_CPU						80000000L
+
+// flash strings are ordinary strings on the host
+#define PROGMEM
+#define ICACHE_RAM_ATTR
+#define PGM_P						const char *
+#define PSTR(s)					(s)
+class __FlashStringHelper;
+#define F(s)						(reinterpret_cast<const __FlashStringHelper *>(s))
+#define FPSTR(s)					(reinterpret_cast<const __FlashStringHelper *>(s))
+#define pgm_read_byte(p)		(*(const uint8_t *)(p))
+#define pgm_read_word(p)		(*(const uint16_t *)(p))
+#define pgm_read_dword(p)		(*(const uint32_t *)(p))
+#define pgm_read_ptr(p)			(*(void * const *)(p))
+#define strlen_P					strlen
+#define strncpy_P					strncpy
+#define strcmp_P					strcmp
+#define strncmp_P					strncmp
+#define strcasecmp_P				strcasecmp
+#define strncasecmp_P			strncasecmp
+#define memcpy_P					memcpy
+#define sprintf_P					sprintf
+#define snprintf_P				snprintf
+#define vsnprintf_P				vsnprintf
+
+#define constrain(amt, low, high)	((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define digitalPinToInterrupt(p)		(p)
+#define ETS_UART_INTR_DISABLE()
+#define ETS_UART_INTR_ENABLE()
+
+using std::min;
+using std::max;
+
+// time (virtual clock) and interrupts
+unsigned long	millis(void);
+unsigned long	micros(void);
+void				delay(unsigned long msec);
+void				delayMicroseconds(unsigned int usec);
+void				yield(void);
+void				noInterrupts(void);
+void				interrupts(void);
+uint32_t			xt_rsil(const uint8_t level);
+void				xt_wsr_ps(const uint32_t ps);
+
+// pins
+void				pinMode(uint8_t pin, uint8_t mode);
+void				digitalWrite(uint8_t pin, uint8_t value);
+int				digitalRead(uint8_t pin);
+void				attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+void				detachInterrupt(uint8_t pin);
+
+long				random(long howbig);
+long				random(long howsmall, long howbig);
+void				randomSeed(unsigned long seed);
+char				*dtostrf(double value, signed char width, unsigned char precision, char *buf);
+
+// GPIO registers: a store to GPOS/GPOC sets/clears the output latch of each pin in the mask, GP16O is GPIO16
+struct Sim_GPIO_Set {
+   void operator= ( const uint32_t mask );
+};
+
+struct Sim_GPIO_Clear {
+   void operator= ( const uint32_t mask );
+};
+
+struct Sim_GPIO16 {
+   operator uint32_t() const;
+   Sim_GPIO16 &operator= ( const uint32_t value );
+   Sim_GPIO16 &operator|= ( const uint32_t value ) { return *this = (uint32_t)*this | value; }
+   Sim_GPIO16 &operator&= ( const uint32_t value ) { return *this = (uint32_t)*this & value; }
+};
+
+extern Sim_GPIO_Set		GPOS;
+extern Sim_GPIO_Clear	GPOC;
+extern Sim_GPIO16			GP16O;
+
+// timer1
+#define TIM_DIV1					0							// 80 MHz
+#define TIM_DIV16					1							// 5 MHz
+#define TIM_DIV256				3							// 312.5 kHz
+#define TIM_EDGE					0
+#define TIM_LEVEL					1
+#define TIM_SINGLE				0
+#define TIM_LOOP					1
+
+extern "C" {
+void				timer1_isr_init(void);
+void				timer1_enable(uint8_t divider, uint8_t intType, uint8_t reload);
+void				timer1_disable(void);
+void				timer1_attachInterrupt(void (*handler)(void));
+void				timer1_detachInterrupt(void);
+void				timer1_write(uint32_t ticks);
+}
+
+class Print;
+
+class Printable {
+public:
+   virtual ~Printable() {}
+   virtual size_t printTo(Print &p) const = 0;
+};
+
+class String {
+public:
+   String(const char *cstr = "") : s(cstr ? cstr : "") {}
+   String(const String &str) : s(str.s) {}
+   String(const __FlashStringHelper *str) : s(reinterpret_cast<const char *>(str)) {}
+   explicit String(char c) : s(1, c) {}
+   explicit String(unsigned char value, unsigned char base = 10);
+   explicit String(int value, unsigned char base = 10);
+   explicit String(unsigned int value, unsigned char base = 10);
+   explicit String(long value, unsigned char base = 10);
+   explicit String(unsigned long value, unsigned char base = 10);
+   explicit String(float value, unsigned char decimalPlaces = 2);
+   explicit String(double value, unsigned char decimalPlaces = 2);
+
+   String			&operator=(const String &rhs) { s = rhs.s; return *this; }
+   String			&operator=(const char *cstr) { s = cstr ? cstr : ""; return *this; }
+   unsigned char	reserve(unsigned int size) { s.reserve(size); return 1; }
+   unsigned int	length(void) const { return s.length(); }
+   const char		*c_str(void) const { return s.c_str(); }
+   char				charAt(unsigned int index) const { return (index < s.length()) ? s[index] : 0; }
+   char				operator[](unsigned int index) const { return charAt(index); }
+   char				&operator[](unsigned int index) { return s[index]; }
+
+   int				indexOf(char ch, unsigned int from = 0) const;
+   int				indexOf(const char *str, unsigned int from = 0) const;
+   int				indexOf(const String &str, unsigned int from = 0) const { return indexOf(str.c_str(), from); }
+   int				lastIndexOf(char ch) const;
+   String			substring(unsigned int left) const { return substring(left, s.length()); }
+   String			substring(unsigned int left, unsigned int right) const;
+   long				toInt(void) const { return atol(s.c_str()); }
+   float				toFloat(void) const { return (float)atof(s.c_str()); }
+   void				replace(const String &find, const String &replace);
+   void				toLowerCase(void);
+   void				toUpperCase(void);
+   void				trim(void);
+   bool				startsWith(const String &prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+   bool				endsWith(const String &suffix) const;
+   bool				equals(const String &str) const { return s == str.s; }
+   bool				equalsIgnoreCase(const String &str) const { return strcasecmp(s.c_str(), str.c_str()) == 0; }
+   bool				operator==(const String &rhs) const { return s == rhs.s; }
+   bool				operator==(const char *rhs) const { return s == rhs; }
+   bool				operator!=(const String &rhs) const { return s != rhs.s; }
+   bool				operator!=(const char *rhs) const { return s != rhs; }
+   explicit			operator bool() const { return true; }
+
+   String			&concat(const String &str) { s += str.s; return *this; }
+   String			&operator+=(const String &rhs) { s += rhs.s; return *this; }
+   String			&operator+=(const char *rhs) { s += rhs; return *this; }
+   String			&operator+=(const __FlashStringHelper *rhs) { s += reinterpret_cast<const char *>(rhs); return *this; }
+   String			&operator+=(char rhs) { s += rhs; return *this; }
+
+   friend String	operator+(const String &lhs, const String &rhs) { String r(lhs); r.s += rhs.s; return r; }
+   friend String	operator+(const String &lhs, const char *rhs) { String r(lhs); r.s += rhs; return r; }
+   friend String	operator+(const char *lhs, const String &rhs) { String r(lhs); r.s += rhs.s; return r; }
+   friend String	operator+(const String &lhs, char rhs) { String r(lhs); r.s += rhs; return r; }
+
+private:
+   std::string		s;
+};
+
+class Print {
+public:
+   virtual ~Print() {}
+   virtual size_t	write(uint8_t c) = 0;
+   virtual size_t	write(const uint8_t *buffer, size_t size);
+   size_t			write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+   size_t			write(const char *buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+   size_t			print(const __FlashStringHelper *str) { return write(reinterpret_cast<const char *>(str)); }
+   size_t			print(const String &str) { return write(str.c_str()); }
+   size_t			print(const char *str) { return write(str); }
+   size_t			print(char c) { return write((uint8_t)c); }
+   size_t			print(unsigned char value, int base = 10) { return print((unsigned long)value, base); }
+   size_t			print(int value, int base = 10) { return print((long)value, base); }
+   size_t			print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+   size_t			print(long value, int base = 10);
+   size_t			print(unsigned long value, int base = 10);
+   size_t			print(double value, int digits = 2);
+   size_t			print(const Printable &value) { return value.printTo(*this); }
+
+   template <typename T> size_t println ( const T &value ) { size_t n = print(value); return n + println(); }
+   template <typename T> size_t println ( const T &value, int format ) { size_t n = print(value, format); return n + println(); }
+   size_t			println(void) { return write("\r\n"); }
+   size_t			printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+public:
+   virtual int		available(void) = 0;
+   virtual int		read(void) = 0;
+   virtual int		peek(void) = 0;
+   virtual void	flush(void) = 0;
+
+   void				setTimeout(unsigned long msec) { timeout = msec; }
+   size_t			readBytes(char *buffer, size_t length);
+   String			readString(void);
+   String			readStringUntil(char terminator);
+   long				parseInt(void);
+
+protected:
+   int				timedRead(void);
+
+   unsigned long	timeout = 1000;
+};
+
+// the serial port goes to stdout; writes never wait (the UART FIFO is always reported empty)
+class HardwareSerial : public Stream {
+public:
+   void				begin(unsigned long baud) { (void)baud; }
+   size_t			write(uint8_t c) override;
+   size_t			write(const uint8_t *buffer, size_t size) override;
+   using Print::write;
+   int				available(void) override { return 0; }
+   int				read(void) override { return -1; }
+   int				peek(void) override { return -1; }
+   void				flush(void) override {}
+   int				availableForWrite(void) { return 128; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+   uint32_t			getCycleCount(void);
+   uint32_t			getFreeHeap(void);
+   uint32_t			getChipId(void) { return 0x00C0FFEE; }
+   uint32_t			getCpuFreqMHz(void) { return F_CPU / 1000000L; }
+   void				restart(void);
+   void				wdtFeed(void) {}
+};
+
+extern EspClass ESP;
+
+#endif
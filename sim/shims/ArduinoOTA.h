@@ -0,0 +1,35 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: OTA updates (never started)
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_ARDUINOOTA_H
+#define SIM_ARDUINOOTA_H
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR } ota_error_t;
+
+class ArduinoOTAClass {
+public:
+   void	setPort(const uint16_t port) { (void)port; }
+   void	setHostname(const char *name) { (void)name; }
+   void	setPassword(const char *password) { (void)password; }
+   void	onStart(std::function<void(void)> fn) { (void)fn; }
+   void	onEnd(std::function<void(void)> fn) { (void)fn; }
+   void	onProgress(std::function<void(unsigned int, unsigned int)> fn) { (void)fn; }
+   void	onError(std::function<void(ota_error_t)> fn) { (void)fn; }
+   void	begin(void) {}
+   void	handle(void) {}
+};
+
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif
@@ -0,0 +1,51 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: EEPROM emulation (in memory, not kept between runs)
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_EEPROM_H
+#define SIM_EEPROM_H
+
+#include <Arduino.h>
+
+#define SIM_EEPROM_MAX			4096						// the core's limit (one flash sector)
+
+class EEPROMClass {
+public:
+   void			begin(const size_t size) { used = (size < SIM_EEPROM_MAX) ? size : SIM_EEPROM_MAX; }
+   uint8_t		read(const int address) { return ((size_t)address < used) ? data[address] : 0; }
+   void			write(const int address, const uint8_t value) { if ( (size_t)address < used ) data[address] = value; }
+   bool			commit(void) { ++commits; return true; }
+   uint8_t		*getDataPtr(void) { return data; }
+   size_t		length(void) const { return used; }
+   uint32_t		commitCount(void) const { return commits; }
+
+   template <typename T> T &get ( const int address, T &value ) {
+      if ( (address + sizeof(T)) <= used ) {
+         memcpy((void *)&value, &data[address], sizeof(T));
+      }
+      return value;
+   }
+
+   template <typename T> const T &put ( const int address, const T &value ) {
+      if ( (address + sizeof(T)) <= used ) {
+         memcpy(&data[address], (const void *)&value, sizeof(T));
+      }
+      return value;
+   }
+
+private:
+   uint8_t		data[SIM_EEPROM_MAX] = { 0 };
+   size_t		used = 0;
+   uint32_t		commits = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,130 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: ESP8266WiFi
+
+   The radio never finds a network, so the sketch comes up in AP mode. WiFiServer hands out the connections made
+   with simConnect() (see Sim.h); a WiFiClient and its copies share one Sim_Socket, as they share one TCP context on
+   the target.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_ESP8266WIFI_H
+#define SIM_ESP8266WIFI_H
+
+#include <Arduino.h>
+#include <memory>
+#include "Sim.h"
+
+#define WL_MAC_ADDR_LENGTH		6
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } WiFiMode_t;
+typedef enum { WL_IDLE_STATUS, WL_NO_SSID_AVAIL, WL_SCAN_COMPLETED, WL_CONNECTED, WL_CONNECT_FAILED, WL_CONNECTION_LOST,
+               WL_DISCONNECTED } wl_status_t;
+
+class IPAddress : public Printable {
+public:
+   IPAddress() : address(0) {}
+   IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+   IPAddress(uint32_t value) : address(value) {}
+   uint8_t		&operator[](int index) { return ((uint8_t *)&address)[index]; }
+   uint8_t		operator[](int index) const { return ((const uint8_t *)&address)[index]; }
+   operator		uint32_t() const { return address; }
+   String		toString(void) const;
+   size_t		printTo(Print &p) const override { return p.print(toString()); }
+
+private:
+   uint32_t		address;
+};
+
+class Client : public Stream {
+public:
+   virtual uint8_t	connected(void) = 0;
+   virtual void		stop(void) = 0;
+};
+
+class WiFiClient : public Client {
+public:
+   WiFiClient() {}
+   explicit WiFiClient(const Sim_Connection &connection) : socket(connection) {}
+
+   size_t		write(uint8_t c) override { return write(&c, 1); }
+   size_t		write(const uint8_t *buffer, size_t size) override;
+   size_t		write_P(PGM_P buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+   using Print::write;
+   int			available(void) override;
+   int			read(void) override;
+   int			read(uint8_t *buffer, size_t size);
+   int			peek(void) override;
+   void			flush(void) override {}
+   uint8_t		connected(void) override;
+   void			stop(void) override;
+   uint8_t		status(void) { return connected() ? 4 : 0; }		// ESTABLISHED : CLOSED
+   size_t		availableForWrite(void);
+   void			setNoDelay(const bool noDelay) { (void)noDelay; }
+   IPAddress	remoteIP(void) { return IPAddress(10, 0, 0, 2); }
+   uint16_t		remotePort(void) { return 49152; }
+   operator		bool() { return (bool)socket; }
+   bool			operator==(const WiFiClient &rhs) const { return socket == rhs.socket; }
+
+private:
+   Sim_Connection	socket;
+};
+
+class WiFiServer {
+public:
+   WiFiServer(const uint16_t listenPort) : port(listenPort) {}
+   void			begin(void) { listening = true; }
+   WiFiClient	available(void);
+   void			setNoDelay(const bool noDelay) { (void)noDelay; }
+
+private:
+   uint16_t		port;
+   bool			listening = false;
+};
+
+class ESP8266WiFiClass {
+public:
+   uint8_t		*softAPmacAddress(uint8_t *mac);
+   String		softAPmacAddress(void);
+   WiFiMode_t	getMode(void) { return wifiMode; }
+   bool			mode(const WiFiMode_t m) { wifiMode = m; return true; }
+   wl_status_t	begin(void) { return WL_DISCONNECTED; }
+   wl_status_t	begin(const char *ssid, const char *passphrase = nullptr, int32_t channel = 0, const uint8_t *bssid = nullptr,
+                    bool connect = true);
+   bool			reconnect(void) { return false; }
+   int8_t		scanNetworks(void) { return 0; }
+   bool			softAPConfig(IPAddress ip, IPAddress gateway, IPAddress mask) { apIP = ip; (void)gateway; (void)mask; return true; }
+   bool			softAP(const char *ssid, const char *passphrase = nullptr, int channel = 1, int hidden = 0);
+   bool			setAutoConnect(const bool autoConnect) { (void)autoConnect; return true; }
+   bool			setAutoReconnect(const bool autoReconnect) { (void)autoReconnect; return true; }
+   bool			persistent(const bool persistent) { (void)persistent; return true; }
+   bool			disconnect(const bool wifiOff = false) { (void)wifiOff; return true; }
+   bool			config(IPAddress ip, IPAddress gateway, IPAddress mask, IPAddress dns = IPAddress());
+   wl_status_t	status(void) { return WL_DISCONNECTED; }
+   int8_t		waitForConnectResult(void) { return WL_DISCONNECTED; }
+   IPAddress	localIP(void) { return IPAddress(); }
+   IPAddress	softAPIP(void) { return apIP; }
+   IPAddress	gatewayIP(void) { return IPAddress(); }
+   IPAddress	subnetMask(void) { return IPAddress(); }
+   IPAddress	dnsIP(uint8_t index = 0) { (void)index; return IPAddress(); }
+   uint8_t		*BSSID(void) { return bssid; }
+   int32_t		channel(void) { return 0; }
+   int32_t		RSSI(void) { return 0; }
+   String		SSID(void) { return String(); }
+   String		psk(void) { return String(); }
+   void			printDiag(Print &p);
+
+private:
+   WiFiMode_t	wifiMode = WIFI_STA;
+   IPAddress	apIP;
+   uint8_t		bssid[WL_MAC_ADDR_LENGTH] = { 0 };
+};
+
+extern ESP8266WiFiClass WiFi;
+
+#endif
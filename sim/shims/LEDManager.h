@@ -0,0 +1,36 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: RGB LED (LEDManager)
+
+   Only the requested color and state are kept.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_LEDMANAGER_H
+#define SIM_LEDMANAGER_H
+
+#include <Arduino.h>
+
+enum class LEDColor { NONE, RED, GREEN, BLUE, WHITE, YELLOW, CYAN, MAGENTA, PURPLE, ORANGE };
+enum class LEDState { OFF, ON, BLINK_ON, BLINK_OFF, ALTERNATE };
+
+class RGBLED {
+public:
+   RGBLED(const uint8_t red, const uint8_t green, const uint8_t blue) { (void)red; (void)green; (void)blue; }
+   void			setColor(const LEDColor first, const LEDColor second = LEDColor::NONE) { color = first; altColor = second; }
+   void			setState(const LEDState newState, const uint32_t msec = 500) { state = newState; (void)msec; }
+   LEDState		getState(void) const { return state; }
+   LEDColor		getColor(void) const { return color; }
+
+private:
+   LEDColor		color = LEDColor::NONE;
+   LEDColor		altColor = LEDColor::NONE;
+   LEDState		state = LEDState::OFF;
+};
+
+#endif
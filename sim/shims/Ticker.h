@@ -0,0 +1,41 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: Ticker (SDK software timer)
+
+   Callbacks run in system context on the virtual clock (see Sim.h).
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_TICKER_H
+#define SIM_TICKER_H
+
+#include <Arduino.h>
+
+class Ticker {
+public:
+   typedef void (*callback_t)(void);
+
+   ~Ticker() { detach(); }
+   void			once_ms(const uint32_t msec, callback_t callback) { arm(msec, 0, callback); }
+   void			attach_ms(const uint32_t msec, callback_t callback) { arm(msec, msec, callback); }
+   void			detach(void);
+   bool			active(void) const { return armed; }
+
+   // run by the simulation when due
+   uint64_t		due = 0;											// virtual nsec
+   void			fire(void);
+
+private:
+   void			arm(const uint32_t msec, const uint32_t period, callback_t callback);
+
+   callback_t	function = nullptr;
+   uint32_t		periodMsec = 0;
+   bool			armed = false;
+};
+
+#endif
@@ -0,0 +1,30 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: WiFiManager (RD7 fork) - the portal never connects
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_WIFIMANAGER_H
+#define SIM_WIFIMANAGER_H
+
+#include <ESP8266WiFi.h>
+
+#define EEPROM_KEY				0x5A						// [Local mod] marks credentials saved in EEPROM
+
+class WiFiManager {
+public:
+   void	setDebugOutput(const bool debug) { (void)debug; }
+   void	setBreakAfterConfig(const bool shouldBreak) { (void)shouldBreak; }
+   void	setSaveCredentialsInEEPROM(const bool save, const int address) { (void)save; (void)address; }
+   void	setExitButtonLabel(const char *label) { (void)label; }
+   void	setConfigPortalTimeout(const unsigned long seconds) { (void)seconds; }
+   void	setAPStaticIPConfig(IPAddress ip, IPAddress gateway, IPAddress mask) { (void)ip; (void)gateway; (void)mask; }
+   bool	autoConnect(const char *ssid, const char *password) { (void)ssid; (void)password; return false; }
+};
+
+#endif
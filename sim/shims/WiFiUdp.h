@@ -0,0 +1,2 @@
+// host simulation: everything is in ESP8266WiFi.h
+#include <ESP8266WiFi.h>
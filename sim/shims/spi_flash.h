@@ -0,0 +1,32 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: ESP8266 SDK raw flash access (included inside extern "C")
+
+   Flash is NOR: an erase sets a whole sector to 0xFF and a write can only clear bits. Addresses and lengths must be
+   multiples of 4, as on the target.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_SPI_FLASH_H
+#define SIM_SPI_FLASH_H
+
+#include <stdint.h>
+
+#define SPI_FLASH_SEC_SIZE		4096
+
+typedef enum {
+   SPI_FLASH_RESULT_OK,
+   SPI_FLASH_RESULT_ERR,
+   SPI_FLASH_RESULT_TIMEOUT
+} SpiFlashOpResult;
+
+SpiFlashOpResult spi_flash_erase_sector(uint16_t sector);
+SpiFlashOpResult spi_flash_write(uint32_t address, uint32_t *source, uint32_t size);
+SpiFlashOpResult spi_flash_read(uint32_t address, uint32_t *destination, uint32_t size);
+
+#endif
@@ -0,0 +1,30 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: umm_malloc heap statistics (fixed figures)
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_UMM_MALLOC_H
+#define SIM_UMM_MALLOC_H
+
+typedef struct {
+   unsigned short int	totalEntries;
+   unsigned short int	usedEntries;
+   unsigned short int	freeEntries;
+   unsigned short int	totalBlocks;
+   unsigned short int	usedBlocks;
+   unsigned short int	freeBlocks;
+   unsigned short int	maxFreeContiguousBlocks;
+} UMM_HEAP_INFO;
+
+extern "C" {
+extern UMM_HEAP_INFO	ummHeapInfo;
+void						*umm_info(void *ptr, int force);
+}
+
+#endif
@@ -0,0 +1,28 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: ESP8266 SDK station config (included inside extern "C")
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#ifndef SIM_USER_INTERFACE_H
+#define SIM_USER_INTERFACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct station_config {
+   uint8_t		ssid[32];
+   uint8_t		password[64];
+   uint8_t		bssid_set;
+   uint8_t		bssid[6];
+};
+
+bool wifi_station_get_config(struct station_config *config);
+bool wifi_station_set_config(struct station_config *config);
+
+#endif
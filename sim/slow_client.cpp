@@ -0,0 +1,355 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: slow client test
+
+   A client that trickles its request in one byte at a time must not hold up loop(), and neither must one that sends a
+   lot at once:
+      - the parser is fed one byte per requestPoll() pass; every pass must stay under REQUEST_BUDGET_USEC and the
+        request must come out whole, including a keep-alive request that follows a stray CRLF
+      - a request with ~16 KB of headers available at once must be read over several passes, none of them longer than
+        REQUEST_BUDGET_USEC plus the one character that is read after the budget check
+      - end to end, a byte-at-a-time client gets its response through loop() and keeps its connection for a second
+        request
+      - KEEPALIVE_REQUESTS requests on one connection with empty lines between them, then an HTTP/1.0 request, are all
+        answered on it and the last closes it; no loop() pass is longer than LOOP_PASS_USEC, and the same requests
+        sent all at once are answered one per pass
+
+   Times are virtual (see Sim.h); the CPU scale is the benchmark's. Each timed pass is bounded by its best time over
+   TIMING_RUNS runs, so that the host preempting it does not fail the test:
+
+      slow_client [-s scale]
+
+   Exits non-zero if any check fails.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <climits>
+#include <unistd.h>
+#include <vector>
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "CamSlider.h"
+#include "HTTPRequest.h"
+#include "Profile.h"
+#include "Sim.h"
+
+#define TEST_SCALE				20.0						// default CPU scale (as the benchmark)
+#define OVERRUN_NSEC				50000						// one character read after the budget check
+#define FLOOD_HEADERS			400						// header lines in the flood request
+#define TIMING_RUNS				3							// each timed pass is bounded by its best time over this many runs
+#define LOOP_PASSES_MAX			20000						// end to end: give up waiting for a response
+#define KEEPALIVE_REQUESTS		4							// requests on one connection before the HTTP/1.0 one
+#define LOOP_PASS_USEC			2000						// keep-alive: longest loop() pass, reading and answering one request
+
+static int failures = 0;
+
+// the host build has LOOP_PROFILE defined for the benchmark; nothing is profiled here
+void profileLoopStart ( void ) {}
+void profileLoopEnd ( const CarriageMode state, const float speed ) { (void)state; (void)speed; }
+void profilePoll ( void ) {}
+void profileSteps ( const int steps ) { (void)steps; }
+
+static void check ( const bool ok, const char *what ) {
+   printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+   if ( !ok ) {
+      ++failures;
+   }
+}
+
+/*
+ the host preempting a pass stretches it by its time scaled up to virtual time, so each pass is timed over
+ TIMING_RUNS runs and bounded by its shortest time: an overrun has to be there every time to fail a test
+*/
+static void keepBest ( std::vector<uint64_t> &best, const size_t pass, const uint64_t elapsed ) {
+   if ( pass < best.size() ) {
+      best[pass] = min(best[pass], elapsed);
+   } else {
+      best.push_back(elapsed);
+   }
+}
+
+/*
+ the longest of the first passes best times - the passes every run had
+*/
+static uint64_t longestBest ( const std::vector<uint64_t> &best, const size_t passes ) {
+   uint64_t longest = 0;
+
+   for ( size_t i = 0; (i < passes) && (i < best.size()); i++ ) {
+      longest = max(longest, best[i]);
+   }
+   return longest;
+}
+
+/*
+ a connection the parser reads from directly, not queued for the sketch's server
+*/
+static Sim_Connection directConnection ( void ) {
+   Sim_Connection connection = std::make_shared<Sim_Socket>();
+
+   connection->port = 0;
+   connection->serverRead = 0;
+   connection->window = SIM_SEND_WINDOW;
+   connection->unacked = 0;
+   connection->autoAck = true;
+   connection->clientOpen = true;
+   connection->serverOpen = true;
+   return connection;
+}
+
+/*
+ feed text one byte per requestPoll() pass, keeping the best time of each pass
+ ready is set if the request completed on the last byte and not before
+*/
+static void trickle ( HTTP_Request &request, WiFiClient &client, Sim_Connection &connection, const char *text,
+                      std::vector<uint64_t> &best, bool &ready ) {
+   size_t length = strlen(text);
+
+   ready = false;
+   for ( size_t i = 0; i < length; i++ ) {
+      RequestState	state;
+      uint64_t			start;
+
+      simSend(connection, std::string(1, text[i]));
+      start = simNanos();
+      state = requestPoll(request, client, REQUEST_BUDGET_USEC);
+      keepBest(best, i, simNanos() - start);
+      if ( state == REQ_ERROR ) {
+         return;
+      }
+      if ( state == REQ_READY ) {
+         ready = (i == (length - 1));
+         return;
+      }
+   }
+}
+
+static void testTrickle ( void ) {
+   const char					*first = "GET /api/status HTTP/1.1\r\nHost: slider\r\nIf-None-Match: \"1a2b\"\r\n\r\n";
+   const char					*second = "\r\nPOST /api/move HTTP/1.0\r\nContent-Length: 17\r\n\r\n{\"action\":\"stop\"}";
+   std::vector<uint64_t>	firstBest;
+   std::vector<uint64_t>	secondBest;
+   bool							firstOk = true;
+   bool							keptAlive = true;
+   bool							secondOk = true;
+   bool							closed = true;
+   uint64_t						longest;
+
+   for ( int run = 0; run < TIMING_RUNS; run++ ) {
+      Sim_Connection	connection = directConnection();
+      WiFiClient		client(connection);
+      HTTP_Request	request;
+      bool				ready;
+
+      requestBegin(request);
+      trickle(request, client, connection, first, firstBest, ready);
+      firstOk = firstOk && ready && requestMethodIs(request, "GET") && requestPathIs(request, "/api/status");
+      keptAlive = keptAlive && request.http11 && request.keepAlive && (strstr(request.etag, "\"1a2b\"") != NULL);
+
+      // the next request on the kept-alive connection, after a stray CRLF
+      requestBegin(request);
+      trickle(request, client, connection, second, secondBest, ready);
+      secondOk = secondOk && ready && requestMethodIs(request, "POST") && requestPathIs(request, "/api/move") &&
+         (strcmp(request.body, "{\"action\":\"stop\"}") == 0);
+      closed = closed && !request.http11 && !request.keepAlive;
+   }
+   longest = longestBest(firstBest, strlen(first));
+   printf("one byte per pass: longest pass %.2f us\n", longest / 1000.0);
+   check(longest < (REQUEST_BUDGET_USEC * 1000ULL), "one byte per pass stays under REQUEST_BUDGET_USEC");
+   check(firstOk, "request complete on its last byte");
+   check(keptAlive, "version, keep-alive and etag");
+   check(longestBest(secondBest, strlen(second)) < (REQUEST_BUDGET_USEC * 1000ULL), "second request stays under REQUEST_BUDGET_USEC");
+   check(secondOk, "stray CRLF skipped, POST body complete");
+   check(closed, "HTTP/1.0 request is not kept alive");
+}
+
+/*
+ one request with FLOOD_HEADERS header lines, all available at once, keeping the best time of each pass
+*/
+static void flood ( std::vector<uint64_t> &best, int &passes, RequestState &state ) {
+   Sim_Connection	connection = directConnection();
+   WiFiClient		client(connection);
+   HTTP_Request	request;
+   std::string		text = "GET / HTTP/1.1\r\n";
+   uint64_t			longest = 0;
+
+   for ( int i = 0; i < FLOOD_HEADERS; i++ ) {
+      text += "X-Padding: 0123456789abcdef0123456789abcdef\r\n";
+   }
+   text += "\r\n";
+   requestBegin(request);
+   simSend(connection, text);
+   passes = 0;
+   state = REQ_METHOD;
+   while ( (state != REQ_READY) && (state != REQ_ERROR) && client.available() ) {
+      uint64_t start = simNanos();
+      uint64_t elapsed;
+
+      state = requestPoll(request, client, REQUEST_BUDGET_USEC);
+      elapsed = simNanos() - start;
+      longest = max(longest, elapsed);
+      keepBest(best, passes, elapsed);
+      ++passes;
+   }
+   printf("%u bytes at once: %d passes, longest %.2f us\n", (unsigned int)text.size(), passes, longest / 1000.0);
+}
+
+/*
+ the number of passes depends on the time each takes, so only those that every run had are bounded
+*/
+static void testFlood ( void ) {
+   std::vector<uint64_t>	best;
+   int							fewest = INT_MAX;
+   bool							complete = true;
+   bool							split = true;
+   uint64_t						longest;
+
+   for ( int i = 0; i < TIMING_RUNS; i++ ) {
+      int				passes;
+      RequestState	state;
+
+      flood(best, passes, state);
+      fewest = min(fewest, passes);
+      complete = complete && (state == REQ_READY);
+      split = split && (passes > 1);
+   }
+   longest = longestBest(best, fewest);
+   printf("longest pass, best of %d runs: %.2f us\n", TIMING_RUNS, longest / 1000.0);
+   check(complete, "flooded request complete");
+   check(split, "flooded request read over several passes");
+   check(longest < ((REQUEST_BUDGET_USEC * 1000ULL) + OVERRUN_NSEC), "flooded passes bounded by REQUEST_BUDGET_USEC");
+}
+
+/*
+ count the responses with the given status line received on a connection
+*/
+static int responses ( const Sim_Connection &connection, const char *status = "HTTP/1.1 200" ) {
+   int		count = 0;
+   size_t	at = 0;
+
+   while ( (at = connection->toClient.find(status, at)) != std::string::npos ) {
+      ++count;
+      ++at;
+   }
+   return count;
+}
+
+/*
+ through loop(): one byte per pass, then wait for the response
+*/
+static bool trickleLoop ( Sim_Connection &connection, const char *text, const int expected ) {
+   for ( const char *p = text; *p; p++ ) {
+      simSend(connection, std::string(1, *p));
+      simLoop();
+   }
+   for ( int i = 0; (i < LOOP_PASSES_MAX) && (responses(connection) < expected); i++ ) {
+      simLoop();
+   }
+   return responses(connection) == expected;
+}
+
+static void testEndToEnd ( void ) {
+   Sim_Connection connection;
+
+   simSetup();
+   connection = simConnect(80);
+   check(trickleLoop(connection, "GET /api/status HTTP/1.1\r\nHost: slider\r\n\r\n", 1), "loop(): response to a slow client");
+   check(connection->serverOpen, "loop(): connection kept alive");
+   check(trickleLoop(connection, "\r\nGET /api/status HTTP/1.1\r\nHost: slider\r\n\r\n", 2),
+      "loop(): second request after a stray CRLF");
+   check(connection->serverOpen, "loop(): connection still open");
+   simClose(connection);
+}
+
+/*
+ run loop() passes until the connection has count responses or is closed, keeping the longest pass
+*/
+static bool served ( const Sim_Connection &connection, const char *status, const int count, uint64_t &longest ) {
+   for ( int i = 0; (i < LOOP_PASSES_MAX) && (responses(connection, status) < count) && connection->serverOpen; i++ ) {
+      uint64_t start = simNanos();
+
+      simLoop();
+      longest = max(longest, simNanos() - start);
+   }
+   return responses(connection, status) == count;
+}
+
+/*
+ one client, several requests on its connection with empty lines between them, then an HTTP/1.0 request that
+ closes it; the longest loop() pass is bounded by its best time over TIMING_RUNS runs
+ the same requests sent all at once must be answered one per loop() pass, as the other connections get their turn
+*/
+static void testKeepAlive ( void ) {
+   const char	*next = "\r\n\r\nGET /api/status HTTP/1.1\r\nHost: slider\r\n\r\n";
+   const char	*last = "\r\nGET /api/status HTTP/1.0\r\n\r\n";
+   uint64_t		best = UINT64_MAX;
+   bool			answered = true;
+   bool			kept = true;
+   bool			closed = true;
+   bool			onePerPass = true;
+
+   for ( int run = 0; run < TIMING_RUNS; run++ ) {
+      Sim_Connection	connection = simConnect(80);
+      uint64_t			longest = 0;
+      std::string		pipelined;
+
+      for ( int i = 1; i <= KEEPALIVE_REQUESTS; i++ ) {
+         simSend(connection, (i > 1) ? next : (next + 4));
+         answered = answered && served(connection, "HTTP/1.1 200", i, longest);
+         kept = kept && connection->serverOpen;
+      }
+      simSend(connection, last);
+      answered = answered && served(connection, "HTTP/1.0 200", 1, longest);
+      closed = closed && (connection->toClient.find("Connection: close") != std::string::npos) && !connection->serverOpen;
+      best = min(best, longest);
+      simClose(connection);
+
+      connection = simConnect(80);
+      for ( int i = 1; i <= KEEPALIVE_REQUESTS; i++ ) {
+         pipelined += (i > 1) ? next : (next + 4);
+      }
+      simSend(connection, pipelined);
+      served(connection, "HTTP/1.1 200", 1, longest);
+      for ( int i = 2; i <= KEEPALIVE_REQUESTS; i++ ) {
+         simLoop();
+         onePerPass = onePerPass && (responses(connection, "HTTP/1.1 200") <= i);
+      }
+      onePerPass = onePerPass && served(connection, "HTTP/1.1 200", KEEPALIVE_REQUESTS, longest);
+      simClose(connection);
+   }
+   printf("%d keep-alive requests, then HTTP/1.0: longest loop() pass, best of %d runs: %.2f us\n", KEEPALIVE_REQUESTS,
+      TIMING_RUNS, best / 1000.0);
+   check(answered, "keep-alive: every request answered on the one connection");
+   check(kept, "keep-alive: connection kept open between requests");
+   check(closed, "keep-alive: HTTP/1.0 request answered with Connection: close, then closed");
+   check(onePerPass, "keep-alive: requests sent at once answered one per loop() pass");
+   check(best < (LOOP_PASS_USEC * 1000ULL), "keep-alive: loop() passes stay under LOOP_PASS_USEC");
+}
+
+int main ( int argc, char *argv[] ) {
+   double	cpuScale = TEST_SCALE;
+   int		opt;
+
+   while ( (opt = getopt(argc, argv, "s:")) != -1 ) {
+      if ( opt == 's' ) {
+         cpuScale = atof(optarg);
+      }
+   }
+   if ( cpuScale <= 0.0 ) {
+      fprintf(stderr, "usage: %s [-s scale]   (scale > 0: virtual nsec per host nsec)\n", argv[0]);
+      return 2;
+   }
+   simSetScale(cpuScale);
+   simSerialEcho(false);
+
+   testTrickle();
+   testFlood();
+   testEndToEnd();
+   testKeepAlive();
+   printf("%s (%d failed)\n", failures ? "FAILED" : "OK", failures);
+   return failures ? 1 : 0;
+}
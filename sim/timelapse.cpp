@@ -0,0 +1,149 @@
+/*
+   TABS=3
+
+   WiFi Camera Slider Controller host simulation: timelapse drift test
+
+   A MAX_IMAGES timelapse set up and started through the web page, run to the end on the virtual clock. Every frame is
+   scheduled against its deadline from the sequence start (frame k at t0 + k * interval, see timelapsePlan()), so the
+   time loop() takes to get round to a due timer delays that frame only and must not build up over the sequence:
+      - no frame fires more than DRIFT_BOUND_MSEC after its deadline, and none is late for its move
+      - the last frame fires within DRIFT_BOUND_MSEC of t0 + totalDuration
+
+   Each loop() pass is followed by up to PASS_LOAD_USEC of other work (simAdvance()), as a busy web server would add,
+   which also keeps the two hours of virtual time short on the host. The per-frame drift distribution is the
+   sequence's own (TL_Drift, reported by the sketch at the end of a sequence and in /api/status). Times are virtual
+   (see Sim.h); the CPU scale is the benchmark's:
+
+      timelapse [-s scale]
+
+   Exits non-zero if any check fails.
+
+   Copyright 2017 Rob Redford
+   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+
+*/
+
+#include <unistd.h>
+#include <Arduino.h>
+#include "CamSlider.h"
+#include "Profile.h"
+#include "Sim.h"
+
+#define TEST_SCALE				20.0						// default CPU scale (as the benchmark)
+#define PASS_LOAD_USEC			8000						// other work after each loop() pass: up to this long
+#define DRIFT_BOUND_MSEC		(PASS_LOAD_USEC / 1000 + 5)	// one loaded pass, plus the pass the timer runs in
+#define HTTP_TIMEOUT_MSEC		2000
+#define RUN_MARGIN_SEC			60							// past the planned end: give up
+
+extern TL_Data		timelapse;
+extern MoveMode	sliderMode;
+
+static int failures = 0;
+
+// the host build has LOOP_PROFILE defined for the benchmark; nothing is profiled here
+void profileLoopStart ( void ) {}
+void profileLoopEnd ( const CarriageMode state, const float speed ) { (void)state; (void)speed; }
+void profilePoll ( void ) {}
+void profileSteps ( const int steps ) { (void)steps; }
+
+static void check ( const bool ok, const char *what ) {
+   printf("%s: %s\n", ok ? "PASS" : "FAIL", what);
+   if ( !ok ) {
+      ++failures;
+   }
+}
+
+/*
+ one form submission; returns true if the page came back
+*/
+static bool submit ( const char *query ) {
+   char				request[256];
+   Sim_Connection	http;
+   uint64_t			end = simNanos() + (HTTP_TIMEOUT_MSEC * 1000000ULL);
+
+   snprintf(request, sizeof(request), "GET /?%s HTTP/1.1\r\nHost: slider\r\nConnection: close\r\n\r\n", query);
+   http = simConnect(80);
+   simSend(http, request);
+   while ( http->serverOpen && (simNanos() < end) ) {
+      simLoop();
+   }
+   return http->toClient.compare(0, 12, "HTTP/1.1 200") == 0;
+}
+
+/*
+ set up the sequence the way a user does: timelapse mode, then the inputs; too short a duration is raised to the
+ minimum interval and too short a distance to a step per move
+*/
+static bool setup ( void ) {
+   char query[128];
+
+   for ( int i = 0; (i < 3) && (sliderMode != MOVE_TIMELAPSE); i++ ) {
+      submit("MODE_BTN=Mode");
+   }
+   snprintf(query, sizeof(query), "TL_DIST=12&TL_DURN=1&TL_IMAGES=%d", MAX_IMAGES);
+   return (sliderMode == MOVE_TIMELAPSE) && submit(query) && (timelapse.totalImages == MAX_IMAGES) &&
+      submit("START_BTN=Start") && timelapse.enabled;
+}
+
+int main ( int argc, char *argv[] ) {
+   double		cpuScale = TEST_SCALE;
+   int			opt;
+   uint32_t		start;
+   uint32_t		end;
+   uint32_t		lastFrame = 0;
+   uint16_t		frames = 0;
+   int32_t		finish;
+   char			what[96];
+   TL_Drift		*d = &timelapse.drift;
+
+   while ( (opt = getopt(argc, argv, "s:")) != -1 ) {
+      if ( opt == 's' ) {
+         cpuScale = atof(optarg);
+      }
+   }
+   if ( cpuScale <= 0.0 ) {
+      fprintf(stderr, "usage: %s [-s scale]   (scale > 0: virtual nsec per host nsec)\n", argv[0]);
+      return 2;
+   }
+   simSetScale(cpuScale);
+   simSerialEcho(false);
+   simSetup();
+
+   if ( !setup() ) {
+      check(false, "timelapse set up and started through the web page");
+      printf("FAILED (%d failed)\n", failures);
+      return 1;
+   }
+   printf("%d images, %d in over %d sec: %u steps per move + %u/%u, %u msec per frame + %u/%u\n", timelapse.totalImages,
+      timelapse.totalDistance, timelapse.totalDuration, (unsigned int)timelapse.plan.stepBase,
+      (unsigned int)timelapse.plan.stepRem, (unsigned int)timelapse.plan.moves, (unsigned int)timelapse.plan.timeBase,
+      (unsigned int)timelapse.plan.timeRem, (unsigned int)timelapse.plan.moves);
+
+   // run to the end, noting when the last frame fires
+   start = millis();
+   end = start + ((timelapse.totalDuration + RUN_MARGIN_SEC) * 1000UL);
+   while ( timelapse.enabled && ((int32_t)(millis() - end) < 0) ) {
+      simLoop();
+      if ( d->frames != frames ) {
+         frames = d->frames;
+         lastFrame = millis();
+      }
+      simAdvance(random(0, PASS_LOAD_USEC));
+   }
+   finish = (int32_t)(lastFrame - timelapse.sequenceStart) - (timelapse.totalDuration * 1000);
+
+   printf("%u frames, %u late, drift max %d msec, mean %u msec, last frame %+d msec from the planned end\n",
+      (unsigned int)d->frames, (unsigned int)d->late, (int)d->maxDrift,
+      (unsigned int)(d->frames ? (d->totalDrift / d->frames) : 0), (int)finish);
+   printf("drift <10: %u  <50: %u  <100: %u  <500: %u  >=500: %u msec\n", (unsigned int)d->histogram[0],
+      (unsigned int)d->histogram[1], (unsigned int)d->histogram[2], (unsigned int)d->histogram[3],
+      (unsigned int)d->histogram[4]);
+   check(!timelapse.enabled && (d->frames == MAX_IMAGES), "every frame taken");
+   snprintf(what, sizeof(what), "no frame more than %u msec after its deadline, none late", DRIFT_BOUND_MSEC);
+   check((d->maxDrift <= DRIFT_BOUND_MSEC) && (d->late == 0), what);
+   snprintf(what, sizeof(what), "last frame within %u msec of the planned end", DRIFT_BOUND_MSEC);
+   check((finish >= 0) && (finish <= DRIFT_BOUND_MSEC), what);
+   printf("%s (%d failed)\n", failures ? "FAILED" : "OK", failures);
+   return failures ? 1 : 0;
+}
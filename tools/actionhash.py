@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+#
+#   Find a seed for the WiFi CamSlider request dispatcher perfect hash
+#
+#   Reads the parameter names from the ACTION_CASE() entries in CamSlider/Dispatch.cpp and prints the first seed for
+#   which FNV-1a modulo ACTION_HASH_SIZE gives every name its own slot. Put the result in ACTION_HASH_SEED.
+#
+#      python3 tools/actionhash.py [table size]
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import os
+import re
+import sys
+
+SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'CamSlider', 'Dispatch.cpp')
+FNV_PRIME = 16777619
+
+
+def fnv1a(name, seed):
+   h = seed
+   for c in name.encode('ascii'):
+      h = ((h ^ c) * FNV_PRIME) & 0xffffffff
+   return h
+
+
+def main():
+   with open(SOURCE, 'r') as f:
+      source = f.read()
+   names = re.findall(r'^\s*ACTION_CASE\("([^"]+)"', source, re.MULTILINE)
+   size = int(sys.argv[1]) if len(sys.argv) > 1 else int(re.search(r'#define\s+ACTION_HASH_SIZE\s+(\d+)', source).group(1))
+
+   for seed in range(1, 1000000):
+      slots = set(fnv1a(name, seed) % size for name in names)
+      if len(slots) == len(names):
+         print('%d names, table size %d: ACTION_HASH_SEED %dUL' % (len(names), size, seed))
+         return 0
+   print('no seed found for table size %d - try a larger size' % size)
+   return 1
+
+
+if __name__ == '__main__':
+   sys.exit(main())
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+#
+#   Decode the WiFi CamSlider deferred binary log
+#
+#   Reads a raw capture of the serial port, prints the ordinary text output as is and turns each framed binary
+#   record back into a line of text using the message table in CamSlider/BinLog.h. Sequence number gaps (records
+#   dropped on the device because the ring was full) are reported.
+#
+#      python3 tools/binlog_decode.py [capture file]
+#
+#   Reads standard input when no file is given, e.g. after "stty -F /dev/ttyUSB0 115200 raw":
+#      cat /dev/ttyUSB0 | python3 tools/binlog_decode.py
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import os
+import re
+import struct
+import sys
+
+SOURCE = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'CamSlider', 'BinLog.h')
+SYNC = b'\xa5\x5a'
+RECORD = struct.Struct('<IHBB3I')                   # BinLog_Record: time, seq, id, reserved, arg[3]
+CONVERSION = re.compile(r'%[-+ #0]*\d*[dux]')
+
+
+def load_formats():
+   with open(SOURCE) as f:
+      return [m.group(2) for m in re.finditer(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', f.read())]
+
+
+def render(fmt, args):
+   # %d arguments were stored as uint32_t
+   values = []
+   for conv, arg in zip(CONVERSION.findall(fmt), args):
+      values.append(arg - (1 << 32) if conv.endswith('d') and arg & 0x80000000 else arg)
+   return fmt % tuple(values)
+
+
+def decode(stream, out):
+   formats = load_formats()
+   data = stream.read()
+   expected = None
+   pos = 0
+   while True:
+      start = data.find(SYNC, pos)
+      end = start if start >= 0 else len(data)
+      out.write(data[pos:end].decode('ascii', 'replace'))
+      if start < 0 or start + len(SYNC) + RECORD.size > len(data):
+         if start >= 0:
+            out.write('\n[truncated record]\n')
+         return
+      time, seq, ident, _, a, b, c = RECORD.unpack_from(data, start + len(SYNC))
+      if expected is not None and seq != expected:
+         out.write('[%u records dropped]\n' % ((seq - expected) & 0xffff))
+      expected = (seq + 1) & 0xffff
+      if ident < len(formats):
+         text = render(formats[ident], (a, b, c))
+      else:
+         text = 'unknown message %u (%u %u %u)' % (ident, a, b, c)
+      out.write('%10.3f ms> %s\n' % (time / 1000.0, text))
+      pos = start + len(SYNC) + RECORD.size
+
+
+def main():
+   if len(sys.argv) > 1:
+      with open(sys.argv[1], 'rb') as f:
+         decode(f, sys.stdout)
+   else:
+      decode(sys.stdin.buffer, sys.stdout)
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
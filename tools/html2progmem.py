@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+#
+#   Compile the WiFi CamSlider HTML templates into PROGMEM fragment tables
+#
+#   Each template in CamSlider/data is split at its %TOKEN% placeholders into literal fragments. The output
+#   header holds one PROGMEM string per fragment and a table of {literal, length, token} entries, where the
+#   token is the placeholder that follows the literal (TOK_END after the last one). The firmware renders a
+#   page with a single pass over the table instead of repeated String::replace() calls.
+#
+#   Static assets (the stylesheet) are gzip compressed here and stored as PROGMEM byte arrays with a strong ETag
+#   derived from their content, so the firmware serves them as-is with Content-Encoding: gzip and can answer a
+#   revalidation with 304 Not Modified. The page templates link to them instead of inlining them.
+#
+#   Run from anywhere after editing any of the HTML files:
+#      python3 tools/html2progmem.py
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'CamSlider')
+DATA_DIR = os.path.join(ROOT, 'data')
+OUTPUT = os.path.join(ROOT, 'HTMLTemplates.h')
+
+# template file -> table name (order is the order of the output)
+TEMPLATES = [
+   ('video_body.html', 'video_body_html'),
+   ('timelapse_body.html', 'timelapse_body_html'),
+   ('disabled_body.html', 'disabled_body_html'),
+]
+
+# static asset file -> (table name, URL path, content type)
+ASSETS = [
+   ('style.css', 'style_css', '/style.css', 'text/css'),
+]
+
+TOKEN_RE = re.compile(r'%([A-Z][A-Z0-9_]*)%')
+
+
+def c_string(text):
+   """ return text as one or more adjacent C string literals, split after each newline """
+   lines = text.splitlines(True) or ['']
+   out = []
+   for line in lines:
+      escaped = line.replace('\\', '\\\\').replace('"', '\\"').replace('\t', '\\t').replace('\r', '\\r').replace('\n', '\\n')
+      out.append('"%s"' % escaped)
+   return ('\n' + ' ' * 3).join(out)
+
+
+def split_template(text):
+   """ returns a list of (literal, token) pairs; the last token is None """
+   fragments = []
+   pos = 0
+   for match in TOKEN_RE.finditer(text):
+      fragments.append((text[pos:match.start()], match.group(1)))
+      pos = match.end()
+   fragments.append((text[pos:], None))
+   return fragments
+
+
+def c_bytes(data):
+   """ return data as the lines of a C byte array initializer """
+   return [', '.join('0x%02X' % b for b in data[i:i + 16]) + ',' for i in range(0, len(data), 16)]
+
+
+def compress(data):
+   """ gzip with a fixed timestamp so the output (and the ETag) only changes when the content does """
+   return gzip.compress(data, compresslevel=9, mtime=0)
+
+
+def main():
+   tables = []
+   tokens = set()
+   for filename, name in TEMPLATES:
+      with open(os.path.join(DATA_DIR, filename), 'r') as f:
+         fragments = split_template(f.read())
+      tokens.update(token for _, token in fragments if token)
+      tables.append((filename, name, fragments))
+
+   assets = []
+   for filename, name, path, content_type in ASSETS:
+      with open(os.path.join(DATA_DIR, filename), 'rb') as f:
+         raw = f.read()
+      data = compress(raw)
+      etag = '"%s"' % hashlib.sha1(data).hexdigest()[:16]
+      assets.append((filename, name, path, content_type, data, etag, len(raw)))
+
+   tokens = sorted(tokens)
+   out = []
+   out.append('/*')
+   out.append('   TABS=3')
+   out.append('')
+   out.append('   WiFi Camera Slider Controller HTML templates')
+   out.append('')
+   out.append('   GENERATED by tools/html2progmem.py from the .html files in CamSlider/data - DO NOT EDIT')
+   out.append('')
+   out.append('   Each table is a list of literal fragments, each followed by the token whose value is substituted there.')
+   out.append('   The last entry of every table has the token TOK_END.')
+   out.append('   static_assets holds the gzip compressed static files, served by URL path.')
+   out.append('')
+   out.append('*/')
+   out.append('')
+   out.append('#ifndef HTMLTEMPLATES_H')
+   out.append('#define HTMLTEMPLATES_H')
+   out.append('')
+   out.append('typedef enum:uint8_t {')
+   for token in tokens:
+      out.append('   TOK_%s,' % token)
+   out.append('   TOK_END')
+   out.append('} T_Token;')
+   out.append('')
+   out.append('typedef struct {')
+   out.append('   PGM_P       literal;                            // fragment text (NUL terminated, in flash)')
+   out.append('   uint16_t    length;                             // strlen(literal)')
+   out.append('   T_Token     token;                              // substitution following the literal')
+   out.append('} HTML_Fragment;')
+   for filename, name, fragments in tables:
+      out.append('')
+      out.append('// %s' % filename)
+      for i, (literal, _) in enumerate(fragments):
+         out.append('static const char %s_%d[] PROGMEM =' % (name, i))
+         out.append('   %s;' % c_string(literal))
+      out.append('static const HTML_Fragment %s[] PROGMEM = {' % name)
+      for i, (literal, token) in enumerate(fragments):
+         out.append('   { %s_%d, %d, TOK_%s },' % (name, i, len(literal.encode('utf-8')), token or 'END'))
+      out.append('};')
+
+   out.append('')
+   out.append('typedef struct {')
+   out.append('   const char      *path;                         // URL path')
+   out.append('   const char      *type;                         // Content-Type')
+   out.append('   PGM_P           etag;                          // strong ETag, quoted')
+   out.append('   const uint8_t   *data;                         // gzip compressed content (in flash)')
+   out.append('   uint16_t        length;                        // bytes in data')
+   out.append('} Static_Asset;')
+   out.append('')
+   out.append('#define STATIC_ASSET_COUNT %d' % len(assets))
+   out.append('#define ASSET_ETAG_MAX 19                          // longest ETag including the quotes and NUL')
+   for filename, name, path, content_type, data, etag, raw_length in assets:
+      out.append('')
+      out.append('// %s: %d bytes, %d compressed' % (filename, raw_length, len(data)))
+      out.append('#define %s_PATH "%s"' % (name.upper(), path))
+      out.append('static const char %s_etag[] PROGMEM = %s;' % (name, c_string(etag)))
+      out.append('static const uint8_t %s_gz[] PROGMEM = {' % name)
+      out.extend('   ' + line for line in c_bytes(data))
+      out.append('};')
+   out.append('')
+   out.append('static const Static_Asset static_assets[] PROGMEM = {')
+   for filename, name, path, content_type, data, etag, raw_length in assets:
+      out.append('   { %s_PATH, "%s", %s_etag, %s_gz, %d },' % (name.upper(), content_type, name, name, len(data)))
+   out.append('};')
+   out.append('')
+   out.append('#endif')
+   out.append('')
+
+   with open(OUTPUT, 'w') as f:
+      f.write('\n'.join(out))
+   print('%s: %d templates, %d tokens' % (os.path.relpath(OUTPUT), len(tables), len(tokens)))
+   for filename, name, path, content_type, data, etag, raw_length in assets:
+      print('%s: %d bytes, %d compressed, ETag %s' % (filename, raw_length, len(data), etag))
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
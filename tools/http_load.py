@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+#
+#   Keep the WiFi CamSlider web server busy
+#
+#   Each simulated client fetches the main page, the stylesheet and the status API back to back and the request rate
+#   and latency percentiles are printed at the end. With --keep-alive every client reuses one persistent connection
+#   (as a browser does); without it every request opens a new connection.
+#
+#   Used with a DEBUG >= 4 build, which simulates an endstop hit a few seconds into every move and prints the
+#   endstop halt/reaction times on the serial port: start moves from a browser while this is running to see the
+#   worst case under HTTP load.
+#
+#   With a STEP_TRACE build, --move distance,duration arms a step trace and starts a video move before the load is
+#   applied; the trace is downloaded when the move has ended and the step interval jitter under load is printed
+#   (see tools/trace_analyze.py). The move must finish within the test time.
+#
+#      python3 tools/http_load.py <slider address> [seconds] [clients] [--keep-alive] [--move inches,seconds]
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import http.client
+import json
+import sys
+import threading
+import time
+
+import trace_analyze
+
+PATHS = ['/', '/style.css', '/api/status']
+TIMEOUT = 5
+TRACE_WAIT = 10                     # seconds to wait for the traced move to end after the load
+
+
+def worker(host, keep_alive, stop, results):
+   latencies = []
+   errors = 0
+   connection = None
+   i = 0
+   while not stop.is_set():
+      start = time.time()
+      try:
+         if connection is None:
+            connection = http.client.HTTPConnection(host, timeout=TIMEOUT)
+         headers = {} if keep_alive else {'Connection': 'close'}
+         connection.request('GET', PATHS[i % len(PATHS)], headers=headers)
+         response = connection.getresponse()
+         response.read()
+         latencies.append(time.time() - start)
+         if not keep_alive or response.will_close:
+            connection.close()
+            connection = None
+      except (OSError, http.client.HTTPException):
+         errors += 1
+         if connection:
+            connection.close()
+         connection = None
+      i += 1
+   if connection:
+      connection.close()
+   results.append((latencies, errors))
+
+
+def api(host, method, path, body=None):
+   connection = http.client.HTTPConnection(host, timeout=TIMEOUT)
+   try:
+      connection.request(method, path, body=json.dumps(body) if body else None,
+         headers={'Content-Type': 'application/json', 'Connection': 'close'})
+      response = connection.getresponse()
+      return response.status, response.read()
+   finally:
+      connection.close()
+
+
+def start_traced_move(host, move):
+   distance, duration = (int(v) for v in move.split(','))
+   status, _ = api(host, 'POST', '/api/trace')
+   if status != 200:
+      raise RuntimeError('arming the trace failed (%d) - is this a STEP_TRACE build?' % status)
+   status, body = api(host, 'POST', '/api/move', {'distance': distance, 'duration': duration, 'action': 'start'})
+   if status != 200:
+      raise RuntimeError('starting the move failed (%d): %s' % (status, body.decode(errors='replace')))
+
+
+def report_trace(host):
+   deadline = time.time() + TRACE_WAIT
+   while True:
+      status, data = api(host, 'GET', '/api/trace')
+      if status == 200:
+         break
+      if time.time() > deadline:
+         print('no step trace: the move did not end in time')
+         return
+      time.sleep(0.5)
+   _, _, entries = trace_analyze.parse(data)
+   intervals = [value for kind, value in entries if kind == 0]
+   if len(intervals) < 2:
+      print('no steps recorded')
+      return
+   deviations, gaps = trace_analyze.jitter(intervals)
+   print('step jitter (usec): ' + '  '.join('p%g %.1f' % (p, trace_analyze.percentile(deviations, p))
+      for p in trace_analyze.PERCENTILES) + '  max %u, %d gaps over %u steps' % (max(deviations), len(gaps),
+      len(intervals)))
+
+
+def main():
+   args = sys.argv[1:]
+   keep_alive = '--keep-alive' in args
+   if keep_alive:
+      args.remove('--keep-alive')
+   move = None
+   if '--move' in args:
+      i = args.index('--move')
+      move = args[i + 1]
+      del args[i:i + 2]
+   if len(args) < 1:
+      print('usage: http_load.py <slider address> [seconds] [clients] [--keep-alive] [--move inches,seconds]')
+      return 1
+   host = args[0]
+   seconds = float(args[1]) if len(args) > 1 else 60.0
+   clients = int(args[2]) if len(args) > 2 else 2
+
+   if move:
+      start_traced_move(host, move)
+   stop = threading.Event()
+   results = []
+   workers = [threading.Thread(target=worker, args=(host, keep_alive, stop, results)) for _ in range(clients)]
+   for w in workers:
+      w.start()
+   time.sleep(seconds)
+   stop.set()
+   for w in workers:
+      w.join()
+
+   latencies = [l * 1000.0 for r in results for l in r[0]]
+   errors = sum(r[1] for r in results)
+   print('%d clients, %s: %d requests in %.0f sec (%.1f/sec), %d errors' % (clients,
+      'keep-alive' if keep_alive else 'connection per request', len(latencies), seconds, len(latencies) / seconds, errors))
+   if latencies:
+      print('latency (msec): ' + '  '.join('p%g %.1f' % (p, trace_analyze.percentile(latencies, p))
+         for p in [50, 90, 99]) + '  max %.1f' % max(latencies))
+   if move:
+      report_trace(host)
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+#   Measure what one WiFi CamSlider page interaction costs on the wire
+#
+#   Loads a page the way a browser with a cache does: the page itself, then each stylesheet it links, revalidated
+#   with If-None-Match once an ETag has been seen. Prints the bytes received (status line, headers and body as sent)
+#   and the time to the first byte and to the end of each response, for a cold load and then the repeat loads.
+#   Run it against the old and new firmware to compare.
+#
+#      python3 tools/page_cost.py <slider address[:port]> [path] [repeats]
+#
+#   path defaults to / and may include a query string (e.g. "/?DIRECTION_BTN=" to press a button).
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import re
+import socket
+import statistics
+import sys
+import time
+
+PORT = 80
+TIMEOUT = 5
+LINK_RE = re.compile(rb'<link[^>]*href="([^"]+)"', re.IGNORECASE)
+ETAG_RE = re.compile(rb'^etag:\s*(.+?)\r$', re.IGNORECASE | re.MULTILINE)
+
+
+def fetch(host, path, etag=None):
+   """ returns (status, raw response, first byte sec, total sec, etag) - the server closes each connection """
+   request = 'GET %s HTTP/1.1\r\nHost: %s\r\nAccept-Encoding: gzip\r\n' % (path, host)
+   if etag:
+      request += 'If-None-Match: %s\r\n' % etag
+   request += 'Connection: close\r\n\r\n'
+
+   start = time.time()
+   first = None
+   data = b''
+   name, _, port = host.partition(':')
+   with socket.create_connection((name, int(port or PORT)), timeout=TIMEOUT) as s:
+      s.sendall(request.encode('ascii'))
+      while True:
+         block = s.recv(4096)
+         if not block:
+            break
+         if first is None:
+            first = time.time() - start
+         data += block
+   total = time.time() - start
+   status = int(data.split(b' ', 2)[1]) if data else 0
+   match = ETAG_RE.search(data.split(b'\r\n\r\n', 1)[0] + b'\r\n')
+   return status, data, first or total, total, match.group(1).decode('ascii') if match else None
+
+
+def interaction(host, path, cache):
+   """ one page load: returns a list of (path, status, bytes, first byte sec, total sec) """
+   rows = []
+   status, data, first, total, _ = fetch(host, path)
+   rows.append((path, status, len(data), first, total))
+   for link in LINK_RE.findall(data):
+      link = link.decode('ascii')
+      status, data, first, total, etag = fetch(host, link, cache.get(link))
+      if etag:
+         cache[link] = etag
+      rows.append((link, status, len(data), first, total))
+   return rows
+
+
+def show(title, rows):
+   print(title)
+   for path, status, size, first, total in rows:
+      print('   %-24s %3d %6d bytes  first byte %6.1f ms  done %6.1f ms' % (path, status, size, first * 1000, total * 1000))
+   print('   %-24s     %6d bytes  %27s %6.1f ms' % ('total', sum(r[2] for r in rows), '', sum(r[4] for r in rows) * 1000))
+
+
+def main():
+   if len(sys.argv) < 2:
+      print('usage: page_cost.py <slider address> [path] [repeats]')
+      return 1
+   host = sys.argv[1]
+   path = sys.argv[2] if len(sys.argv) > 2 else '/'
+   repeats = int(sys.argv[3]) if len(sys.argv) > 3 else 10
+
+   cache = {}
+   show('cold load', interaction(host, path, cache))
+   loads = [interaction(host, path, cache) for _ in range(repeats)]
+   show('last repeat load', loads[-1])
+   sizes = [sum(r[2] for r in rows) for rows in loads]
+   times = [sum(r[4] for r in rows) * 1000 for rows in loads]
+   print('%d repeat loads: %.0f bytes and %.1f ms per interaction (median), slowest %.1f ms' % (repeats,
+      statistics.median(sizes), statistics.median(times), max(times)))
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())
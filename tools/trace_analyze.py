@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+#
+#   Analyze a WiFi CamSlider step timing capture
+#
+#   Capture a move with a STEP_TRACE build:
+#      curl -X POST http://<slider>/api/trace            (arm, then start the move)
+#      curl -o move.trace http://<slider>/api/trace      (download once the move has ended)
+#
+#   and run
+#      python3 tools/trace_analyze.py move.trace [--csv profile.csv]
+#
+#   Prints the markers, the achieved speed profile, the step interval jitter percentiles and any gaps that look like
+#   missed steps. Jitter is measured against the median of the surrounding intervals, so it is valid on the ramps as
+#   well as at cruise speed. The blob layout is described in CamSlider/Trace.h.
+#
+#   Copyright 2017 Rob Redford
+#   This work is licensed under the Creative Commons Attribution-NonCommercial-ShareAlike 4.0 International License.
+#   To view a copy of this license, visit http://creativecommons.org/licenses/by-nc-sa/4.0/.
+#
+
+import statistics
+import struct
+import sys
+
+TRACE_MAGIC = 0x52545343
+HEADER = struct.Struct('<IHHII')
+TYPE_SHIFT = 30
+VALUE_MASK = (1 << TYPE_SHIFT) - 1
+TYPES = ['step', 'start', 'stop', 'endstop']
+
+WINDOW = 9                          # intervals in the rolling median
+GAP_FACTOR = 1.5                    # an interval this much longer than the median is reported as a gap
+PROFILE_MSEC = 100                  # speed profile bin width
+PERCENTILES = [50, 90, 99, 99.9]
+
+
+def parse(data):
+   """ returns (version, entries recorded, [(type, value)]) from a downloaded blob """
+   magic, version, size, count, recorded = HEADER.unpack_from(data)
+   if magic != TRACE_MAGIC or size != 4:
+      raise ValueError('not a step trace')
+   entries = struct.unpack_from('<%dI' % count, data, HEADER.size)
+   return version, recorded, [(e >> TYPE_SHIFT, e & VALUE_MASK) for e in entries]
+
+
+def load(path):
+   with open(path, 'rb') as f:
+      return parse(f.read())
+
+
+def percentile(values, p):
+   ordered = sorted(values)
+   k = (len(ordered) - 1) * p / 100.0
+   lo = int(k)
+   hi = min(lo + 1, len(ordered) - 1)
+   return ordered[lo] + (ordered[hi] - ordered[lo]) * (k - lo)
+
+
+def jitter(intervals):
+   """ returns ([|interval - local median|], [(index, interval, median)] for gaps) """
+   deviations = []
+   gaps = []
+   half = WINDOW // 2
+   for i, dt in enumerate(intervals[1:], 1):
+      window = intervals[max(1, i - half):i + half + 1]
+      median = statistics.median(window)
+      deviations.append(abs(dt - median))
+      if dt > GAP_FACTOR * median:
+         gaps.append((i, dt, median))
+   return deviations, gaps
+
+
+def main():
+   args = sys.argv[1:]
+   csv = None
+   if '--csv' in args:
+      i = args.index('--csv')
+      csv = args[i + 1]
+      del args[i:i + 2]
+   if len(args) != 1:
+      print('usage: trace_analyze.py <capture> [--csv profile.csv]')
+      return 1
+
+   version, recorded, entries = load(args[0])
+   print('trace version %u: %u entries%s' % (version, len(entries),
+      '' if recorded == len(entries) else ' (last %u of %u, start of the move was overwritten)' % (len(entries), recorded)))
+
+   # markers and step times
+   intervals = []
+   times = []
+   t = 0
+   for kind, value in entries:
+      if kind == 0:
+         t += value
+         intervals.append(value)
+         times.append(t)
+      else:
+         print('%10.3f ms  %-8s step %u' % (t / 1000.0, TYPES[kind], value))
+   if len(intervals) < 2:
+      print('no steps recorded')
+      return 0
+
+   # achieved speed profile
+   print('\nspeed profile (%u msec bins)' % PROFILE_MSEC)
+   bins = {}
+   for when in times:
+      b = int(when / 1000 / PROFILE_MSEC)
+      bins[b] = bins.get(b, 0) + 1
+   rows = [(b * PROFILE_MSEC, bins.get(b, 0) * 1000.0 / PROFILE_MSEC) for b in range(max(bins) + 1)]
+   peak = max(r[1] for r in rows) or 1.0
+   for start, speed in rows:
+      print('%8u ms %8.1f steps/s %s' % (start, speed, '#' * int(40 * speed / peak)))
+   if csv:
+      with open(csv, 'w') as f:
+         f.write('msec,steps_per_sec\n')
+         for start, speed in rows:
+            f.write('%u,%.1f\n' % (start, speed))
+
+   # jitter against the local median, and gaps
+   deviations, gaps = jitter(intervals)
+   print('\n%u steps in %.3f sec, mean %.1f steps/s' % (len(intervals), times[-1] / 1e6, len(intervals) * 1e6 / times[-1]))
+   print('jitter (usec): ' + '  '.join('p%g %.1f' % (p, percentile(deviations, p)) for p in PERCENTILES) +
+      '  max %u' % max(deviations))
+   if gaps:
+      print('\n%u gaps longer than %.1fx the local median interval:' % (len(gaps), GAP_FACTOR))
+      for step, dt, median in gaps[:50]:
+         print('%10.3f ms  step %6u  %6u usec (median %u, ~%u missed)' % (times[step] / 1000.0, step, dt, median,
+            round(dt / median) - 1))
+   else:
+      print('no gaps')
+   return 0
+
+
+if __name__ == '__main__':
+   sys.exit(main())